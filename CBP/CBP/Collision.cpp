@@ -9,12 +9,287 @@ namespace CBP
         a_world->setCollisionCheckCallback(collisionCheckFunc);
     }
 
-    void ICollision::onContact(const CollisionCallback::CallbackData& callbackData)
+    SphereWorld::filter_t ICollision::MakeFilter(std::uint64_t a_groupId, bool a_movement)
     {
-        using EventType = CollisionCallback::ContactPair::EventType;
+        std::uint32_t group = 0;
+
+        if (a_groupId != 0)
+        {
+            auto& groups = IConfig::GetCollisionGroups();
+
+            if (groups.find(a_groupId) != groups.end())
+            {
+                auto& nodeMap = IConfig::GetNodeCollisionGroupMap();
+
+                std::set<std::uint64_t> used;
+                for (const auto& e : nodeMap)
+                    used.emplace(e.second);
+
+                auto it = used.find(a_groupId);
+                if (it != used.end())
+                {
+                    auto index = std::distance(used.begin(), it);
+                    if (index < 32)
+                        group = 1U << index;
+                    else if (m_Instance.m_overflowGroups.emplace(a_groupId).second)
+                        m_Instance.log.Warning("%s: more than 32 collision groups in use, nodes of group %llu collide within the actor",
+                            __FUNCTION__, static_cast<unsigned long long>(a_groupId));
+                }
+            }
+        }
+
+        return SphereWorld::filter_t{
+            a_movement ? kFilterMoving : kFilterStatic,
+            a_movement ? kFilterMoving | kFilterStatic : kFilterMoving,
+            group };
+    }
+
+    const char* ICollision::GetBackendName(Backend a_backend)
+    {
+        switch (a_backend)
+        {
+        case Backend::kSpheres:
+            return "Spheres";
+        case Backend::kReactPhysics:
+            return "ReactPhysics3D";
+        default:
+            return "Unknown";
+        }
+    }
+
+    auto ICollision::AcquireBody(float a_radius) -> pooledBody_t
+    {
+        auto& pool = m_Instance.m_bodyPool;
+        auto& stats = m_Instance.m_poolStats;
+
+        stats.acquired++;
+        stats.used++;
+
+        if (!pool.empty())
+        {
+            auto e = pool.back();
+            pool.pop_back();
+
+            stats.hits++;
+            stats.free = static_cast<std::uint32_t>(pool.size());
+
+            e.shape->setRadius(a_radius);
+            e.body->setTransform(r3d::Transform::identity());
+            e.body->setIsActive(true);
+
+            return e;
+        }
+
+        auto world = DCBP::GetWorld();
+        auto& physicsCommon = DCBP::GetPhysicsCommon();
+
+        pooledBody_t e;
+
+        e.body = world->createCollisionBody(r3d::Transform::identity());
+        e.shape = physicsCommon.createSphereShape(a_radius);
+        e.collider = e.body->addCollider(e.shape, r3d::Transform::identity());
+
+        return e;
+    }
+
+    void ICollision::ReleaseBody(const pooledBody_t& a_body)
+    {
+        auto& pool = m_Instance.m_bodyPool;
+        auto& stats = m_Instance.m_poolStats;
+
+        stats.used--;
+
+        a_body.collider->setUserData(nullptr);
+
+        if (pool.size() < MAX_POOLED_BODIES)
+        {
+            // inactive bodies are out of the broad phase
+            a_body.body->setIsActive(false);
+            pool.emplace_back(a_body);
+
+            stats.free = static_cast<std::uint32_t>(pool.size());
+
+            return;
+        }
+
+        a_body.body->removeCollider(a_body.collider);
+        DCBP::GetPhysicsCommon().destroySphereShape(a_body.shape);
+        DCBP::GetWorld()->destroyCollisionBody(a_body.body);
+    }
+
+    void ICollision::RemoveSphere(SphereWorld::handle_t a_handle)
+    {
+        DCBP::GetSphereWorld().Remove(a_handle, [](void* a_sc1, void* a_sc2)
+            {
+                m_Instance.OnContactExit(
+                    static_cast<SimComponent*>(a_sc1),
+                    static_cast<SimComponent*>(a_sc2));
+            });
+    }
+
+    void ICollision::OnContactStart(SimComponent* a_sc1, SimComponent* a_sc2)
+    {
+        a_sc1->SetInContact(true);
+        a_sc2->SetInContact(true);
+    }
+
+    void ICollision::OnContactExit(SimComponent* a_sc1, SimComponent* a_sc2)
+    {
+        a_sc1->SetInContact(false);
+        a_sc2->SetInContact(false);
+    }
+
+    static constexpr float RESPONSE_SCALE = 65536.0f;
+
+    inline static void AddFixed(std::int64_t (&a_sum)[3], const NiPoint3& a_value)
+    {
+        a_sum[0] += static_cast<std::int64_t>(a_value.x * RESPONSE_SCALE);
+        a_sum[1] += static_cast<std::int64_t>(a_value.y * RESPONSE_SCALE);
+        a_sum[2] += static_cast<std::int64_t>(a_value.z * RESPONSE_SCALE);
+    }
+
+    inline static NiPoint3 FromFixed(const std::int64_t (&a_sum)[3])
+    {
+        constexpr float m = 1.0f / RESPONSE_SCALE;
+
+        return NiPoint3(
+            static_cast<float>(a_sum[0]) * m,
+            static_cast<float>(a_sum[1]) * m,
+            static_cast<float>(a_sum[2]) * m);
+    }
+
+    auto ICollision::GetResponse(SimComponent* a_sc) -> response_t&
+    {
+        auto slot = a_sc->GetSlot();
+        auto& r = m_responses[slot];
+
+        if (!r.sc)
+        {
+            auto& conf = a_sc->GetConfig();
+
+            r.sc = a_sc;
+            r.velocity = a_sc->GetVelocity();
+            r.depthMul = conf.colDepthMul;
+            r.dampingCoef = conf.colDampingCoef;
+            r.movement = a_sc->HasMovement();
+            r.positionBased = a_sc->IsPositionBased();
+
+            for (std::uint32_t i = 0; i < 3; i++)
+            {
+                r.impulse[i] = 0;
+                r.correction[i] = 0;
+            }
+
+            r.dampingMul = 1.0f;
+            r.wake = false;
+
+            m_touched.emplace_back(slot);
+        }
+
+        return r;
+    }
+
+    // Contact points of one update are summed per node and applied once. Velocities are read
+    // before any of them is applied and the sums are fixed point, the order the backend
+    // reports pairs in doesn't change the result.
+    void ICollision::ResolveContacts()
+    {
+        if (m_contactPoints.empty())
+            return;
 
         auto& globalConf = IConfig::GetGlobalConfig();
 
+        auto maxDepth = globalConf.phys.colMaxPenetrationDepth;
+        auto wakeDepth = globalConf.phys.wakeContactDepth;
+
+        auto numSlots = DCBP::GetSimStore().Size();
+        if (m_responses.size() < numSlots)
+            m_responses.resize(numSlots);
+
+        for (const auto& e : m_contactPoints)
+        {
+            auto& r1 = GetResponse(e.sc1);
+            auto& r2 = GetResponse(e.sc2);
+
+            auto depth = std::min(e.depth, maxDepth);
+            auto dampingMul = std::max(depth, 1.0f);
+            bool wake = depth > wakeDepth;
+
+            auto len = (r1.velocity - r2.velocity).Length();
+            auto& n = e.normal;
+
+            // position based nodes are pushed apart, split between the two if both move
+            float share = r1.movement && r2.movement ? 0.5f : 1.0f;
+
+            r1.wake |= wake;
+            r2.wake |= wake;
+
+            if (r1.movement)
+            {
+                r1.dampingMul = std::max(r1.dampingMul, std::clamp(dampingMul * r1.dampingCoef, 1.0f, 100.0f));
+
+                if (r1.positionBased)
+                    AddFixed(r1.correction, n * -(depth * share));
+                else
+                    AddFixed(r1.impulse, n * ((len + (depth * r1.depthMul)) * depth));
+            }
+
+            if (r2.movement)
+            {
+                r2.dampingMul = std::max(r2.dampingMul, std::clamp(dampingMul * r2.dampingCoef, 1.0f, 100.0f));
+
+                if (r2.positionBased)
+                    AddFixed(r2.correction, n * (depth * share));
+                else
+                    AddFixed(r2.impulse, n * -((len + (depth * r2.depthMul)) * depth));
+            }
+        }
+
+        for (auto e : m_touched)
+        {
+            auto& r = m_responses[e];
+            auto sc = r.sc;
+
+            if (r.movement)
+            {
+                sc->SetDampingMul(r.dampingMul);
+
+                if (r.positionBased)
+                {
+                    auto correction = FromFixed(r.correction);
+
+                    auto len = correction.Length();
+                    if (len > _EPSILON)
+                        sc->ProjectContact(correction, correction * (1.0f / len));
+                }
+                else
+                    sc->SetVelocity2(FromFixed(r.impulse), m_timeStep);
+            }
+
+            if (r.wake)
+                m_wake.emplace_back(sc);
+
+            r.sc = nullptr;
+        }
+
+        // waking moves nodes between slots, keep that independent of the report order too
+        std::sort(m_wake.begin(), m_wake.end(),
+            [](auto a_lhs, auto a_rhs) { return a_lhs->GetSlot() < a_rhs->GetSlot(); });
+
+        for (auto e : m_wake)
+            e->Wake();
+
+        m_wake.clear();
+        m_touched.clear();
+        m_contactPoints.clear();
+    }
+
+    void ICollision::onContact(const CollisionCallback::CallbackData& callbackData)
+    {
+        CBP_PROFILE_ZONE(kContact);
+
+        using EventType = CollisionCallback::ContactPair::EventType;
+
         auto nbContactPairs = callbackData.getNbContactPairs();
 
         for (r3d::uint p = 0; p < nbContactPairs; p++)
@@ -32,63 +307,213 @@ namespace CBP
             switch (type)
             {
             case EventType::ContactStart:
-                sc1->SetInContact(true);
-                sc2->SetInContact(true);
+                OnContactStart(sc1, sc2);
+                [[fallthrough]];
             case EventType::ContactStay:
             {
-                auto& conf1 = sc1->GetConfig();
-                auto& conf2 = sc2->GetConfig();
-
-                float dampingMul = 1.0f;
-
                 auto nbContactPoints = contactPair.getNbContactPoints();
 
+                sc1->AddContacts(nbContactPoints);
+                sc2->AddContacts(nbContactPoints);
+
                 for (r3d::uint c = 0; c < nbContactPoints; c++)
                 {
                     auto contactPoint = contactPair.getContactPoint(c);
 
-                    auto depth = std::min(contactPoint.getPenetrationDepth(),
-                        globalConf.phys.colMaxPenetrationDepth);
-
-                    dampingMul = std::max(depth, dampingMul);
-
-                    auto& v1 = sc1->GetVelocity();
-                    auto& v2 = sc2->GetVelocity();
-
                     auto& normal = contactPoint.getWorldNormal();
 
-                    auto len = (v1 - v2).Length();
-                    auto n = NiPoint3(normal.x, normal.y, normal.z);
-
-                    if (sc1->HasMovement()) {
-                        sc1->SetDampingMul(std::clamp(dampingMul * conf1.colDampingCoef, 1.0f, 100.0f));
-                        sc1->SetVelocity2(n * ((len + (depth * conf1.colDepthMul)) * depth), m_timeStep);
-                    }
-
-                    if (sc2->HasMovement()) {
-                        sc2->SetDampingMul(std::clamp(dampingMul * conf2.colDampingCoef, 1.0f, 100.0f));
-                        sc2->SetVelocity2(n * (-(len + (depth * conf2.colDepthMul)) * depth), m_timeStep);
-                    }
+                    AddContactPoint(sc1, sc2,
+                        NiPoint3(normal.x, normal.y, normal.z),
+                        contactPoint.getPenetrationDepth());
                 }
             }
             break;
             case EventType::ContactExit:
-                sc1->SetInContact(false);
-                sc2->SetInContact(false);
+                OnContactExit(sc1, sc2);
                 break;
             }
 
         }
+
+        ResolveContacts();
+    }
+
+    void ICollision::ProcessContacts(const SphereWorld::contactList_t& a_contacts)
+    {
+        CBP_PROFILE_ZONE(kContact);
+
+        for (const auto& e : a_contacts)
+        {
+            auto sc1 = static_cast<SimComponent*>(e.userData1);
+            auto sc2 = static_cast<SimComponent*>(e.userData2);
+
+            switch (e.event)
+            {
+            case SphereWorld::ContactEvent::kStart:
+                m_Instance.OnContactStart(sc1, sc2);
+                [[fallthrough]];
+            case SphereWorld::ContactEvent::kStay:
+                sc1->AddContacts(1);
+                sc2->AddContacts(1);
+
+                m_Instance.AddContactPoint(sc1, sc2, e.normal, e.depth);
+                break;
+            case SphereWorld::ContactEvent::kExit:
+                m_Instance.OnContactExit(sc1, sc2);
+                break;
+            }
+        }
+
+        m_Instance.ResolveContacts();
     }
 
+    // r3d has no per-collider filter data, the SphereWorld backend tests the bits in the sweep
     bool ICollision::collisionCheckFunc(r3d::Collider* a_lhs, r3d::Collider* a_rhs)
     {
-        auto sc1 = static_cast<SimComponent*>(a_lhs->getUserData());
-        auto sc2 = static_cast<SimComponent*>(a_rhs->getUserData());
+        auto sc1 = static_cast<const SimComponent*>(a_lhs->getUserData());
+        auto sc2 = static_cast<const SimComponent*>(a_rhs->getUserData());
+
+        return sc1->Collides(*sc2);
+    }
+
+    class BenchmarkListener :
+        public r3d::EventListener
+    {
+    public:
+        virtual void onContact(const r3d::CollisionCallback::CallbackData& a_data) override
+        {
+            using EventType = r3d::CollisionCallback::ContactPair::EventType;
+
+            auto nbContactPairs = a_data.getNbContactPairs();
+
+            for (r3d::uint p = 0; p < nbContactPairs; p++)
+                if (a_data.getContactPair(p).getEventType() != EventType::ContactExit)
+                    m_pairs++;
+        }
+
+        std::uint64_t m_pairs = 0;
+    };
+
+    void ICollision::Benchmark(
+        std::uint32_t a_numSpheres,
+        std::uint32_t a_steps,
+        benchmarkResults_t& a_out)
+    {
+        constexpr float minRadius = 2.0f;
+        constexpr float maxRadius = 5.0f;
+
+        a_out = benchmarkResults_t{};
+
+        if (!a_numSpheres || !a_steps)
+            return;
+
+        // around one neighbour per sphere at the mean radius
+        float meanDiameter = minRadius + maxRadius;
+        float extent = std::cbrt(static_cast<float>(a_numSpheres) *
+            4.18879f * meanDiameter * meanDiameter * meanDiameter) * 0.5f;
+
+        std::mt19937 gen(0x43425021);
+        std::uniform_real_distribution<float> position(-extent, extent);
+        std::uniform_real_distribution<float> radius(minRadius, maxRadius);
+        std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+        std::vector<NiPoint3> positions(a_numSpheres);
+        std::vector<float> radii(a_numSpheres);
+
+        for (std::uint32_t i = 0; i < a_numSpheres; i++)
+        {
+            positions[i] = NiPoint3(position(gen), position(gen), position(gen));
+            radii[i] = radius(gen);
+        }
+
+        std::vector<std::vector<NiPoint3>> frames(a_steps);
+
+        for (auto& e : frames)
+        {
+            for (auto& p : positions)
+                p += NiPoint3(jitter(gen), jitter(gen), jitter(gen));
+
+            e = positions;
+        }
+
+        {
+            auto& physicsCommon = DCBP::GetPhysicsCommon();
+
+            BenchmarkListener listener;
+
+            auto world = physicsCommon.createPhysicsWorld();
+            world->setEventListener(std::addressof(listener));
+
+            std::vector<r3d::CollisionBody*> bodies(a_numSpheres);
+            std::vector<r3d::SphereShape*> shapes(a_numSpheres);
+
+            for (std::uint32_t i = 0; i < a_numSpheres; i++)
+            {
+                bodies[i] = world->createCollisionBody(r3d::Transform::identity());
+                shapes[i] = physicsCommon.createSphereShape(radii[i]);
+                bodies[i]->addCollider(shapes[i], r3d::Transform::identity());
+            }
 
-        if (!sc1->HasMovement() && !sc2->HasMovement())
-            return false;
+            r3d::Transform transform;
 
-        return !sc1->IsSameGroup(*sc2);
+            PerfTimer pt;
+            pt.Start();
+
+            for (const auto& e : frames)
+            {
+                for (std::uint32_t i = 0; i < a_numSpheres; i++)
+                {
+                    transform.setPosition(r3d::Vector3(e[i].x, e[i].y, e[i].z));
+                    bodies[i]->setTransform(transform);
+                }
+
+                world->update(1.0f / 60.0f);
+            }
+
+            a_out[Enum::Underlying(Backend::kReactPhysics)] = benchmarkResult_t{
+                static_cast<double>(pt.Stop()) * 1000000.0 / static_cast<double>(a_steps),
+                static_cast<double>(listener.m_pairs) / static_cast<double>(a_steps)
+            };
+
+            for (auto e : bodies)
+                world->destroyCollisionBody(e);
+
+            for (auto e : shapes)
+                physicsCommon.destroySphereShape(e);
+
+            physicsCommon.destroyPhysicsWorld(world);
+        }
+
+        {
+            SphereWorld world;
+
+            std::vector<SphereWorld::handle_t> handles(a_numSpheres);
+
+            // a single owner, like r3d the whole cloud is one island
+            for (std::uint32_t i = 0; i < a_numSpheres; i++)
+                handles[i] = world.Add(nullptr, radii[i], 0);
+
+            std::uint64_t pairs = 0;
+
+            PerfTimer pt;
+            pt.Start();
+
+            for (const auto& e : frames)
+            {
+                for (std::uint32_t i = 0; i < a_numSpheres; i++)
+                    world.SetPosition(handles[i], e[i].x, e[i].y, e[i].z);
+
+                world.Update();
+
+                for (const auto& c : world.GetContacts())
+                    if (c.event != SphereWorld::ContactEvent::kExit)
+                        pairs++;
+            }
+
+            a_out[Enum::Underlying(Backend::kSpheres)] = benchmarkResult_t{
+                static_cast<double>(pt.Stop()) * 1000000.0 / static_cast<double>(a_steps),
+                static_cast<double>(pairs) / static_cast<double>(a_steps)
+            };
+        }
     }
 }
\ No newline at end of file
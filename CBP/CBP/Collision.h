@@ -5,8 +5,56 @@ namespace CBP
     class ICollision :
         public r3d::EventListener
     {
+        class ICollisionLog
+            : public ILog
+        {
+        public:
+            FN_NAMEPROC("ICollision");
+        };
+
     public:
 
+        // kSpheres runs SphereWorld, kReactPhysics the r3d world
+        enum class Backend : std::uint32_t
+        {
+            kSpheres = 0,
+            kReactPhysics = 1
+        };
+
+        struct benchmarkResult_t
+        {
+            // us per update
+            double time;
+            // average overlapping pairs per update
+            double pairs;
+        };
+
+        typedef std::array<benchmarkResult_t, 2> benchmarkResults_t;
+
+        struct pooledBody_t
+        {
+            r3d::CollisionBody* body;
+            r3d::SphereShape* shape;
+            r3d::Collider* collider;
+        };
+
+        struct poolStats_t
+        {
+            // deactivated bodies waiting to be reused
+            std::uint32_t free;
+            std::uint32_t used;
+            std::uint64_t acquired;
+            // taken from the pool instead of created
+            std::uint64_t hits;
+        };
+
+        // SphereWorld::filter_t categories of the node colliders
+        enum FilterCategory : std::uint32_t
+        {
+            kFilterMoving = 1U << 0,
+            kFilterStatic = 1U << 1
+        };
+
         [[nodiscard]] inline static auto& GetSingleton() {
             return m_Instance;
         }
@@ -17,19 +65,110 @@ namespace CBP
 
         static void Initialize(r3d::PhysicsWorld* a_world);
 
+        // Nodes without movement only collide with ones that move, nodes of the same actor and
+        // collision group don't collide. Only groups assigned to a node get a bit, by their
+        // position among those; past the 32nd they're ignored and a warning is logged once.
+        [[nodiscard]] static SphereWorld::filter_t MakeFilter(std::uint64_t a_groupId, bool a_movement);
+
+        static void ProcessContacts(const SphereWorld::contactList_t& a_contacts);
+
+        // colliders are created on the backend active at the time, only change this while
+        // no actors are simulated
+        inline static void SetBackend(Backend a_backend) {
+            m_Instance.m_backend = a_backend;
+        }
+
+        [[nodiscard]] inline static auto GetBackend() {
+            return m_Instance.m_backend;
+        }
+
+        [[nodiscard]] static const char* GetBackendName(Backend a_backend);
+
+        // r3d sphere bodies for the node colliders. Released bodies are deactivated and kept for
+        // reuse (up to MAX_POOLED_BODIES) instead of being destroyed.
+        [[nodiscard]] static pooledBody_t AcquireBody(float a_radius);
+        static void ReleaseBody(const pooledBody_t& a_body);
+
+        // SphereWorld counterpart of ReleaseBody, nodes the sphere was touching are taken out
+        // of contact since no exit event comes for them
+        static void RemoveSphere(SphereWorld::handle_t a_handle);
+
+        [[nodiscard]] inline static const auto& GetPoolStats() noexcept {
+            return m_Instance.m_poolStats;
+        }
+
+        // Both backends update the same a_numSpheres spheres, jittered between updates.
+        static void Benchmark(
+            std::uint32_t a_numSpheres,
+            std::uint32_t a_steps,
+            benchmarkResults_t& a_out);
+
         ICollision(const ICollision&) = delete;
         ICollision(ICollision&&) = delete;
         ICollision& operator=(const ICollision&) = delete;
         void operator=(ICollision&&) = delete;
 
     private:
+        static constexpr std::size_t MAX_POOLED_BODIES = 2048;
+
+        struct contactPoint_t
+        {
+            SimComponent* sc1;
+            SimComponent* sc2;
+            // from sc1 to sc2
+            NiPoint3 normal;
+            float depth;
+        };
+
+        // Everything a node gets from its contacts in one update, along with what's read from
+        // the node when it's first touched. Sums are fixed point (RESPONSE_SCALE) so they come
+        // out the same in any order.
+        struct response_t
+        {
+            SimComponent* sc = nullptr;
+            NiPoint3 velocity;
+            float depthMul;
+            float dampingCoef;
+            bool movement;
+            bool positionBased;
+
+            std::int64_t impulse[3];
+            std::int64_t correction[3];
+            float dampingMul;
+            bool wake;
+        };
+
         ICollision() = default;
 
         virtual void onContact(const CollisionCallback::CallbackData& callbackData) override;
 
+        void OnContactStart(SimComponent* a_sc1, SimComponent* a_sc2);
+        void OnContactExit(SimComponent* a_sc1, SimComponent* a_sc2);
+
+        inline void AddContactPoint(SimComponent* a_sc1, SimComponent* a_sc2, const NiPoint3& a_normal, float a_depth) {
+            m_contactPoints.emplace_back(contactPoint_t{ a_sc1, a_sc2, a_normal, a_depth });
+        }
+
+        response_t& GetResponse(SimComponent* a_sc);
+        void ResolveContacts();
+
         static bool collisionCheckFunc(r3d::Collider* a_lhs, r3d::Collider* a_rhs);
 
         float m_timeStep = 1.0f / 60.0f;
+        Backend m_backend = Backend::kSpheres;
+
+        std::vector<contactPoint_t> m_contactPoints;
+        // indexed by SimStore slot
+        std::vector<response_t> m_responses;
+        std::vector<SimStore::size_type> m_touched;
+        std::vector<SimComponent*> m_wake;
+
+        std::vector<pooledBody_t> m_bodyPool;
+        poolStats_t m_poolStats{ 0, 0, 0, 0 };
+
+        // groups already warned about in MakeFilter
+        std::unordered_set<std::uint64_t> m_overflowGroups;
+        ICollisionLog log;
 
         static ICollision m_Instance;
     };
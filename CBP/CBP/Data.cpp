@@ -180,6 +180,8 @@ namespace CBP
 
     bool IData::UpdateArmorCache(const std::string& a_path, armorCacheEntry_t** a_out)
     {
+        CBP_TRACE_SCOPE("UpdateArmorCache", "io");
+
         try
         {
             const fs::path path(a_path);
@@ -2,13 +2,154 @@
 
 namespace CBP
 {
+#ifdef _CBP_ENABLE_PROFILING_ZONES
+
+    ZoneHistogram IProfileZones::m_histograms[Enum::Underlying(ProfileZone::kMax)];
+    IProfileZones::statsArray_t IProfileZones::m_stats{};
+
+    static const struct
+    {
+        const char* name;
+        uint32_t depth;
+    } s_zoneInfo[] = {
+        {"PhysicsTick", 0},
+        {"UpdateDebugRenderer", 1},
+        {"UpdatePhase1", 1},
+        {"UpdateActorsPhase2", 1},
+        {"world->update", 1},
+        {"onContact", 2},
+        {"Interpolate", 1},
+        {"Run", 0},
+        {"CullActors", 1},
+        {"ProcessTasks", 1}
+    };
+
+    static_assert(std::size(s_zoneInfo) == Enum::Underlying(ProfileZone::kMax));
+
+    uint32_t ZoneHistogram::GetBucket(uint64_t a_value)
+    {
+        if (a_value < SUB_COUNT)
+            return static_cast<uint32_t>(a_value);
+
+        unsigned long e;
+#if defined(_MSC_VER)
+        _BitScanReverse64(&e, a_value);
+#else
+        e = 63 - __builtin_clzll(a_value);
+#endif
+
+        if (e > MAX_EXP)
+            return NUM_BUCKETS - 1;
+
+        auto m = static_cast<uint32_t>(a_value >> (e - SUB_BITS)) & (SUB_COUNT - 1);
+
+        return (e - SUB_BITS + 1) * SUB_COUNT + m;
+    }
+
+    uint64_t ZoneHistogram::GetBucketValue(uint32_t a_bucket)
+    {
+        if (a_bucket < SUB_COUNT)
+            return a_bucket;
+
+        uint32_t e = a_bucket / SUB_COUNT + SUB_BITS - 1;
+        uint64_t m = a_bucket % SUB_COUNT;
+
+        // middle of the bucket
+        uint64_t width = 1ULL << (e - SUB_BITS);
+
+        return ((SUB_COUNT + m) << (e - SUB_BITS)) + width / 2;
+    }
+
+    void ZoneHistogram::Add(uint64_t a_value)
+    {
+        m_buckets[GetBucket(a_value)]++;
+
+        if (m_count == 0 || a_value < m_min)
+            m_min = a_value;
+
+        if (a_value > m_max)
+            m_max = a_value;
+
+        m_count++;
+    }
+
+    void ZoneHistogram::Reset()
+    {
+        std::memset(m_buckets, 0x0, sizeof(m_buckets));
+
+        m_count = 0;
+        m_min = 0;
+        m_max = 0;
+    }
+
+    uint64_t ZoneHistogram::GetPercentile(float a_p) const
+    {
+        if (m_count == 0)
+            return 0;
+
+        auto rank = static_cast<uint32_t>(std::ceil(a_p * static_cast<float>(m_count)));
+        rank = std::clamp(rank, 1U, m_count);
+
+        uint32_t n = 0;
+
+        for (uint32_t i = 0; i < NUM_BUCKETS; i++)
+        {
+            n += m_buckets[i];
+            if (n >= rank)
+                return std::clamp(GetBucketValue(i), m_min, m_max);
+        }
+
+        return m_max;
+    }
+
+    void IProfileZones::Update()
+    {
+        for (uint32_t i = 0; i < Enum::Underlying(ProfileZone::kMax); i++)
+        {
+            auto& h = m_histograms[i];
+
+            m_stats[i] = Stats{
+                h.GetCount(),
+                h.GetMin(),
+                h.GetPercentile(0.5f),
+                h.GetPercentile(0.95f),
+                h.GetPercentile(0.99f),
+                h.GetMax() };
+
+            h.Reset();
+        }
+    }
+
+    void IProfileZones::Reset()
+    {
+        for (auto& e : m_histograms)
+            e.Reset();
+
+        m_stats.fill(Stats{ 0, 0, 0, 0, 0, 0 });
+    }
+
+    const char* IProfileZones::GetName(ProfileZone a_zone)
+    {
+        return s_zoneInfo[Enum::Underlying(a_zone)].name;
+    }
+
+    uint32_t IProfileZones::GetDepth(ProfileZone a_zone)
+    {
+        return s_zoneInfo[Enum::Underlying(a_zone)].depth;
+    }
+
+#endif
+
     Profiler::Profiler(
         long long a_interval
     ) :
         m_perfTimer(a_interval),
-        m_current({ 0, 0, 0, 0 }),
+        m_current({ 0, 0, 0, 0, 0, 0, 0 }),
         m_numActorsAccum(0),
         m_numStepsAccum(0),
+        m_numAwakeAccum(0),
+        m_numSleepingAccum(0),
+        m_numDeferredAccum(0),
         m_runCount(0)
     {
     }
@@ -18,11 +159,14 @@ namespace CBP
         m_perfTimer.Begin();
     }
 
-    void Profiler::End(uint32_t a_actors, uint32_t a_steps)
+    bool Profiler::End(uint32_t a_actors, uint32_t a_steps, uint32_t a_awake, uint32_t a_sleeping, uint32_t a_deferred)
     {
         m_runCount++;
         m_numActorsAccum += a_actors;
         m_numStepsAccum += a_steps;
+        m_numAwakeAccum += a_awake;
+        m_numSleepingAccum += a_sleeping;
+        m_numDeferredAccum += a_deferred;
 
         if (m_perfTimer.End(m_current.avgTime))
         {
@@ -30,6 +174,9 @@ namespace CBP
             {
                 m_current.avgActorCount = m_numActorsAccum / m_runCount;
                 m_current.avgStepsPerUpdate = m_numStepsAccum / m_runCount;
+                m_current.avgAwakeCount = m_numAwakeAccum / m_runCount;
+                m_current.avgSleepingCount = m_numSleepingAccum / m_runCount;
+                m_current.avgDeferredCount = m_numDeferredAccum / m_runCount;
 
                 auto intTime = m_perfTimer.GetIntervalTime();
                 if (intTime > 0)
@@ -40,10 +187,21 @@ namespace CBP
                 m_runCount = 0;
                 m_numActorsAccum = 0;
                 m_numStepsAccum = 0;
+                m_numAwakeAccum = 0;
+                m_numSleepingAccum = 0;
+                m_numDeferredAccum = 0;
+
+#ifdef _CBP_ENABLE_PROFILING_ZONES
+                IProfileZones::Update();
+#endif
+
+                return true;
             }
             else // overflow
                 Reset();
         }
+
+        return false;
     }
 
     void Profiler::SetInterval(long long a_interval)
@@ -57,9 +215,116 @@ namespace CBP
         m_runCount = 0;
         m_numActorsAccum = 0;
         m_numStepsAccum = 0;
+        m_numAwakeAccum = 0;
+        m_numSleepingAccum = 0;
+        m_numDeferredAccum = 0;
         m_current.avgActorCount = 0;
         m_current.avgTime = 0;
         m_current.avgStepRate = 0;
         m_current.avgStepsPerUpdate = 0;
+        m_current.avgAwakeCount = 0;
+        m_current.avgSleepingCount = 0;
+        m_current.avgDeferredCount = 0;
+
+#ifdef _CBP_ENABLE_PROFILING_ZONES
+        IProfileZones::Reset();
+#endif
+    }
+
+    CostProfiler::CostProfiler() :
+        m_frame(0),
+        m_samples(0),
+        m_lastSamples(0),
+        m_cycles(0),
+        m_time(0)
+    {
+    }
+
+    bool CostProfiler::BeginFrame(uint32_t a_interval)
+    {
+        return (m_frame++ % std::max(a_interval, 1U)) == 0;
+    }
+
+    void CostProfiler::AddSample(uint64_t a_cycles, long long a_time)
+    {
+        m_samples++;
+        m_cycles += a_cycles;
+        m_time += a_time;
+    }
+
+    void CostProfiler::Update(simActorList_t& a_actors)
+    {
+        m_actors.clear();
+        m_groups.clear();
+
+        m_lastSamples = m_samples;
+
+        if (m_samples > 0 && m_cycles > 0)
+        {
+            // the sampled sections' wall time calibrates the cycle counts
+            double usPerCycle = static_cast<double>(m_time) / static_cast<double>(m_cycles) / 1000.0;
+            float mul = 1.0f / static_cast<float>(m_samples);
+
+            auto add = [](entry_t& a_out, const entry_t& a_in)
+            {
+                a_out.time += a_in.time;
+                a_out.steps += a_in.steps;
+                a_out.contacts += a_in.contacts;
+                a_out.maxForces = std::max(a_out.maxForces, a_in.maxForces);
+            };
+
+            std::unordered_map<std::string, entry_t> groups;
+
+            for (auto& e : a_actors)
+            {
+                entry_t actor{ 0.0f, 0.0f, 0.0f, 0 };
+
+                for (auto& n : e.second)
+                {
+                    auto& sc = n.second;
+                    auto& c = sc.GetCostCounters();
+
+                    entry_t v{
+                        static_cast<float>(static_cast<double>(c.cycles) * usPerCycle) * mul,
+                        static_cast<float>(c.steps) * mul,
+                        static_cast<float>(c.contacts) * mul,
+                        c.maxForces };
+
+                    add(actor, v);
+                    add(groups.try_emplace(sc.GetConfigGroupName(), entry_t{ 0.0f, 0.0f, 0.0f, 0 }).first->second, v);
+                }
+
+                m_actors.emplace_back(e.first, actor);
+            }
+
+            m_groups.assign(groups.begin(), groups.end());
+        }
+
+        ResetCounters(a_actors);
+
+        m_samples = 0;
+        m_cycles = 0;
+        m_time = 0;
+    }
+
+    void CostProfiler::ResetCounters(simActorList_t& a_actors)
+    {
+        for (auto& e : a_actors)
+            for (auto& n : e.second)
+                n.second.ResetCostCounters();
+    }
+
+    void CostProfiler::Reset(simActorList_t& a_actors)
+    {
+        ResetCounters(a_actors);
+
+        m_actors.clear();
+        m_groups.clear();
+
+        m_frame = 0;
+        m_samples = 0;
+        m_lastSamples = 0;
+        m_cycles = 0;
+        m_time = 0;
     }
 }
\ No newline at end of file
@@ -2,6 +2,143 @@
 
 namespace CBP
 {
+    // Scoped timing zones, nested as listed (see IProfileZones::GetDepth). Recorded while
+    // profiling is enabled or a trace is captured, compiled out without _CBP_ENABLE_PROFILING_ZONES.
+    enum class ProfileZone : uint32_t
+    {
+        kPhysicsTick,
+        kDebugRenderer,
+        kPhase1,
+        kPhase2,
+        kWorldUpdate,
+        kContact,
+        kInterpolate,
+        kRun,
+        kCullActors,
+        kProcessTasks,
+        kMax
+    };
+
+#ifdef _CBP_ENABLE_PROFILING_ZONES
+
+    // Log-linear, 8 buckets per power of two so values are within 12.5%. Durations in ns,
+    // anything above ~1s lands in the last bucket.
+    class ZoneHistogram
+    {
+        static constexpr uint32_t SUB_BITS = 3;
+        static constexpr uint32_t SUB_COUNT = 1U << SUB_BITS;
+        static constexpr uint32_t MAX_EXP = 30;
+        static constexpr uint32_t NUM_BUCKETS = (MAX_EXP - SUB_BITS + 2) * SUB_COUNT;
+
+    public:
+        void Add(uint64_t a_value);
+        void Reset();
+
+        [[nodiscard]] uint64_t GetPercentile(float a_p) const;
+
+        [[nodiscard]] inline uint32_t GetCount() const noexcept {
+            return m_count;
+        }
+
+        [[nodiscard]] inline uint64_t GetMin() const noexcept {
+            return m_count ? m_min : 0;
+        }
+
+        [[nodiscard]] inline uint64_t GetMax() const noexcept {
+            return m_max;
+        }
+
+    private:
+        [[nodiscard]] static uint32_t GetBucket(uint64_t a_value);
+        [[nodiscard]] static uint64_t GetBucketValue(uint32_t a_bucket);
+
+        uint32_t m_buckets[NUM_BUCKETS]{ 0 };
+        uint32_t m_count = 0;
+        uint64_t m_min = 0;
+        uint64_t m_max = 0;
+    };
+
+    class IProfileZones
+    {
+    public:
+        // ns, over the last profiling interval
+        struct Stats
+        {
+            uint32_t count;
+            uint64_t min;
+            uint64_t p50;
+            uint64_t p95;
+            uint64_t p99;
+            uint64_t max;
+        };
+
+        typedef std::array<Stats, Enum::Underlying(ProfileZone::kMax)> statsArray_t;
+
+        inline static void Add(ProfileZone a_zone, uint64_t a_ns) {
+            m_histograms[Enum::Underlying(a_zone)].Add(a_ns);
+        }
+
+        // publishes the interval's percentiles and starts a new one
+        static void Update();
+        static void Reset();
+
+        [[nodiscard]] inline static const auto& GetStats() noexcept {
+            return m_stats;
+        }
+
+        [[nodiscard]] static const char* GetName(ProfileZone a_zone);
+        [[nodiscard]] static uint32_t GetDepth(ProfileZone a_zone);
+
+    private:
+        static ZoneHistogram m_histograms[Enum::Underlying(ProfileZone::kMax)];
+        static statsArray_t m_stats;
+    };
+
+    // also emits a trace event while a trace is being captured
+    class ProfileZoneScope
+    {
+    public:
+        inline ProfileZoneScope(ProfileZone a_zone) :
+            m_zone(a_zone),
+            m_profile(IConfig::GetGlobalConfig().general.enableProfiling),
+            m_trace(ITrace::IsCapturing())
+        {
+            if (m_profile || m_trace)
+                m_start = ITrace::GetTime();
+        }
+
+        inline ~ProfileZoneScope()
+        {
+            if (!m_profile && !m_trace)
+                return;
+
+            auto end = ITrace::GetTime();
+
+            if (m_profile)
+                IProfileZones::Add(m_zone, static_cast<uint64_t>(end - m_start));
+
+            if (m_trace)
+                ITrace::Add(IProfileZones::GetName(m_zone), "physics", m_start, end);
+        }
+
+        ProfileZoneScope(const ProfileZoneScope&) = delete;
+        ProfileZoneScope& operator=(const ProfileZoneScope&) = delete;
+
+    private:
+        long long m_start = 0;
+        ProfileZone m_zone;
+        bool m_profile;
+        bool m_trace;
+    };
+
+#define CBP_PROFILE_ZONE(a_zone) ::CBP::ProfileZoneScope _profileZone(::CBP::ProfileZone::a_zone)
+
+#else
+
+#define CBP_PROFILE_ZONE(a_zone)
+
+#endif
+
     class Profiler
     {
         struct Stats
@@ -10,13 +147,17 @@ namespace CBP
             uint32_t avgActorCount;
             long long avgStepRate;
             uint32_t avgStepsPerUpdate;
+            uint32_t avgAwakeCount;
+            uint32_t avgSleepingCount;
+            uint32_t avgDeferredCount;
         };
 
     public:
         Profiler(long long a_interval);
 
         void Begin();
-        void End(uint32_t a_actors, uint32_t a_steps);
+        // true when the interval ended and Current() was updated
+        bool End(uint32_t a_actors, uint32_t a_steps, uint32_t a_awake, uint32_t a_sleeping, uint32_t a_deferred);
 
         void SetInterval(long long a_interval);
         void Reset();
@@ -32,6 +173,61 @@ namespace CBP
 
         uint32_t m_numActorsAccum;
         uint32_t m_numStepsAccum;
+        uint32_t m_numAwakeAccum;
+        uint32_t m_numSleepingAccum;
+        uint32_t m_numDeferredAccum;
         uint32_t m_runCount;
     };
+
+    // Per actor and config group share of the simulation cost. Every Nth frame is sampled
+    // (SimStore::SetCostSampling), Update() turns the node counters gathered since the last
+    // call into per sampled frame averages.
+    class CostProfiler
+    {
+    public:
+        struct entry_t
+        {
+            // us
+            float time;
+            float steps;
+            float contacts;
+            uint32_t maxForces;
+        };
+
+        typedef std::vector<std::pair<SKSE::ObjectHandle, entry_t>> actorList_t;
+        typedef std::vector<std::pair<std::string, entry_t>> groupList_t;
+
+        CostProfiler();
+
+        // true if the frame should be sampled
+        bool BeginFrame(uint32_t a_interval);
+        void AddSample(uint64_t a_cycles, long long a_time);
+
+        void Update(simActorList_t& a_actors);
+        void Reset(simActorList_t& a_actors);
+
+        [[nodiscard]] inline const auto& GetActors() const noexcept {
+            return m_actors;
+        }
+
+        [[nodiscard]] inline const auto& GetGroups() const noexcept {
+            return m_groups;
+        }
+
+        [[nodiscard]] inline uint32_t GetSamples() const noexcept {
+            return m_lastSamples;
+        }
+
+    private:
+        static void ResetCounters(simActorList_t& a_actors);
+
+        actorList_t m_actors;
+        groupList_t m_groups;
+
+        uint32_t m_frame;
+        uint32_t m_samples;
+        uint32_t m_lastSamples;
+        uint64_t m_cycles;
+        long long m_time;
+    };
 }
\ No newline at end of file
@@ -0,0 +1,766 @@
+#include "pch.h"
+
+namespace CBP
+{
+    using namespace Recording;
+
+    MotionRecorder::~MotionRecorder() noexcept
+    {
+        Stop();
+    }
+
+    bool MotionRecorder::Start(const fs::path& a_path, float a_timeAccum)
+    {
+        Stop();
+
+        try
+        {
+            if (a_path.has_parent_path())
+                fs::create_directories(a_path.parent_path());
+
+            m_file.open(a_path, std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+            if (!m_file.is_open())
+                throw std::runtime_error("Could not open file for writing");
+
+            using namespace boost::iostreams;
+
+            m_out.push(gzip_compressor(gzip_params(gzip::best_speed), 1024 * 128));
+            m_out.push(m_file);
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            Error("%s: %s", __FUNCTION__, e.what());
+
+            m_out.reset();
+            m_file.close();
+
+            return false;
+        }
+
+        m_actors.clear();
+        m_configs.clear();
+        m_lastGlobals.clear();
+        m_buffer.clear();
+        m_frames = 0;
+
+        Write(m_buffer, MAGIC);
+        Write(m_buffer, VERSION);
+        Write(m_buffer, a_timeAccum);
+
+        m_recording = true;
+
+        CheckGlobals();
+        Flush();
+
+        return m_recording;
+    }
+
+    void MotionRecorder::Stop()
+    {
+        if (!m_recording)
+            return;
+
+        m_recording = false;
+
+        try
+        {
+            // flushes the compressor and writes the gzip trailer
+            m_out.reset();
+            m_file.close();
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            Error("%s: %s", __FUNCTION__, e.what());
+        }
+
+        m_actors.clear();
+        m_configs.clear();
+        m_buffer.clear();
+    }
+
+    void MotionRecorder::Flush()
+    {
+        if (m_buffer.empty())
+            return;
+
+        try
+        {
+            m_out.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+            if (!m_out.good())
+                throw std::runtime_error("Write failed");
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            Error("%s: %s, recording stopped", __FUNCTION__, e.what());
+
+            m_buffer.clear();
+            Stop();
+
+            return;
+        }
+
+        m_buffer.clear();
+    }
+
+    void MotionRecorder::Write(std::string& a_out, const char* a_value)
+    {
+        auto length = a_value ? std::strlen(a_value) : 0;
+        auto size = static_cast<std::uint16_t>(std::min(length, size_t(0xFFFF)));
+
+        Write(a_out, size);
+        a_out.append(a_value ? a_value : "", size);
+    }
+
+    void MotionRecorder::Write(std::string& a_out, const std::string& a_value)
+    {
+        auto size = static_cast<std::uint16_t>(std::min(a_value.size(), size_t(0xFFFF)));
+
+        Write(a_out, size);
+        a_out.append(a_value.data(), size);
+    }
+
+    void MotionRecorder::Write(std::string& a_out, const NiTransform& a_value)
+    {
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                Write(a_out, a_value.rot.data[i][j]);
+
+        Write(a_out, a_value.pos.x);
+        Write(a_out, a_value.pos.y);
+        Write(a_out, a_value.pos.z);
+        Write(a_out, a_value.scale);
+    }
+
+    void MotionRecorder::WriteNodeFlags(std::string& a_out, SKSE::ObjectHandle a_handle, const SimObject& a_obj)
+    {
+        std::vector<const std::string*> names;
+
+        for (const auto& e : a_obj)
+            names.emplace_back(std::addressof(e.first));
+
+        std::sort(names.begin(), names.end(),
+            [](const auto& a_lhs, const auto& a_rhs) { return *a_lhs < *a_rhs; });
+
+        Write(a_out, static_cast<std::uint32_t>(names.size()));
+
+        for (auto e : names)
+        {
+            configNode_t nodeConf;
+            IConfig::GetActorNodeConfig(a_handle, *e, nodeConf);
+
+            bool collisions, movement;
+            nodeConf.Get(a_obj.GetSex(), collisions, movement);
+
+            std::uint8_t flags = 0;
+            if (collisions)
+                flags |= kNodeCollisions;
+            if (movement)
+                flags |= kNodeMovement;
+
+            Write(a_out, *e);
+            Write(a_out, flags);
+        }
+    }
+
+    void MotionRecorder::CheckGlobals()
+    {
+        auto& phys = IConfig::GetGlobalConfig().phys;
+
+        std::string data;
+
+        Write(data, phys.colMaxPenetrationDepth);
+        Write(data, phys.timeTick);
+        Write(data, phys.maxSubSteps);
+        Write(data, phys.collisions);
+        Write(data, phys.collisionBackend);
+        Write(data, phys.collisionInterval);
+        Write(data, phys.numThreads);
+        Write(data, phys.sleeping);
+        Write(data, phys.sleepVelocity);
+        Write(data, phys.sleepOffset);
+        Write(data, phys.sleepSteps);
+        Write(data, phys.wakeDistance);
+        Write(data, phys.wakeContactDepth);
+        Write(data, phys.lod);
+        Write(data, phys.lodMidDistance);
+        Write(data, phys.lodFarDistance);
+        Write(data, phys.lodMidInterval);
+        Write(data, phys.budget);
+        Write(data, phys.pbdIterations);
+
+        auto& chains = IConfig::GetNodeChains();
+
+        Write(data, static_cast<std::uint32_t>(chains.size()));
+        for (const auto& e : chains)
+        {
+            Write(data, static_cast<std::uint32_t>(e.size()));
+            for (const auto& n : e)
+                Write(data, n);
+        }
+
+        if (data == m_lastGlobals)
+            return;
+
+        Write(m_buffer, RecordType::kGlobals);
+        m_buffer.append(data);
+
+        m_lastGlobals = std::move(data);
+    }
+
+    std::uint32_t MotionRecorder::GetConfigId(const configComponents_t& a_config)
+    {
+        std::string data;
+
+        Write(data, static_cast<std::uint32_t>(a_config.size()));
+        for (const auto& e : a_config)
+        {
+            Write(data, e.first);
+            Write(data, e.second);
+        }
+
+        auto r = m_configs.try_emplace(std::move(data), static_cast<std::uint32_t>(m_configs.size()));
+        if (r.second)
+        {
+            Write(m_buffer, RecordType::kConfig);
+            Write(m_buffer, r.first->second);
+            m_buffer.append(r.first->first);
+        }
+
+        return r.first->second;
+    }
+
+    void MotionRecorder::AddDriven(
+        actorEntry_t& a_entry,
+        NiAVObject* a_node,
+        const std::unordered_set<const NiAVObject*>& a_simulated)
+    {
+        auto find = [&](NiAVObject* a_obj)
+        {
+            return std::find_if(a_entry.driven.begin(), a_entry.driven.end(),
+                [&](const auto& a_e) { return a_e.node == a_obj; });
+        };
+
+        if (find(a_node) != a_entry.driven.end())
+            return;
+
+        // walk up to the first simulated or already known node, everything in between
+        // moves with it
+        std::vector<NiAVObject*> path{ a_node };
+
+        NiAVObject* ancestor = a_node->m_parent;
+
+        for (; ancestor != nullptr; ancestor = ancestor->m_parent)
+        {
+            if (a_simulated.find(ancestor) != a_simulated.end() ||
+                find(ancestor) != a_entry.driven.end())
+            {
+                break;
+            }
+
+            path.emplace_back(ancestor);
+        }
+
+        bool anchored = false;
+
+        if (ancestor != nullptr)
+        {
+            auto it = find(ancestor);
+            anchored = it == a_entry.driven.end() || it->local;
+        }
+
+        if (!anchored)
+        {
+            a_entry.driven.emplace_back(drivenEntry_t{ a_node, false });
+            return;
+        }
+
+        // parents first
+        for (auto it = path.rbegin(); it != path.rend(); ++it)
+            a_entry.driven.emplace_back(drivenEntry_t{ *it, true });
+    }
+
+    void MotionRecorder::OnAddActor(
+        SKSE::ObjectHandle a_handle,
+        Actor* a_actor,
+        const SimObject& a_obj,
+        const configComponents_t& a_config)
+    {
+        if (!m_recording)
+            return;
+
+        CheckGlobals();
+
+        auto configId = GetConfigId(a_config);
+
+        std::vector<std::pair<const std::string*, const SimComponent*>> nodes;
+        std::unordered_set<const NiAVObject*> simulated;
+
+        for (const auto& e : a_obj)
+        {
+            nodes.emplace_back(std::addressof(e.first), std::addressof(e.second));
+            simulated.emplace(e.second.m_obj);
+        }
+
+        std::sort(nodes.begin(), nodes.end(),
+            [](const auto& a_lhs, const auto& a_rhs) { return *a_lhs.first < *a_rhs.first; });
+
+        actorEntry_t entry;
+
+        for (const auto& e : nodes)
+        {
+            NiAVObject* parent = e.second->m_objParent;
+
+            if (simulated.find(parent) == simulated.end())
+                AddDriven(entry, parent, simulated);
+        }
+
+        for (const auto& e : entry.driven)
+            entry.drivenState.emplace_back(e.GetTransform());
+
+        float weight = 0.0f;
+        auto npc = DYNAMIC_CAST(a_actor->baseForm, TESForm, TESNPC);
+        if (npc != nullptr)
+            weight = npc->weight;
+
+        Write(m_buffer, RecordType::kAddActor);
+        Write(m_buffer, a_handle);
+        Write(m_buffer, a_obj.GetId());
+        Write(m_buffer, a_obj.GetSex());
+        Write(m_buffer, weight);
+        Write(m_buffer, configId);
+
+        Write(m_buffer, static_cast<std::uint32_t>(entry.driven.size()));
+        for (const auto& e : entry.driven)
+        {
+            Write(m_buffer, e.node->m_name);
+            Write(m_buffer, e.local ? e.node->m_parent->m_name : "");
+            Write(m_buffer, e.GetTransform());
+        }
+
+        Write(m_buffer, static_cast<std::uint32_t>(nodes.size()));
+        for (const auto& e : nodes)
+        {
+            auto& local = e.second->m_obj->m_localTransform;
+
+            Write(m_buffer, *e.first);
+            Write(m_buffer, e.second->m_objParent->m_name);
+            Write(m_buffer, e.second->GetConfigGroupName());
+            Write(m_buffer, local);
+
+            entry.nodes.emplace_back(e.second->m_obj);
+            entry.lastLocal.emplace_back(local);
+        }
+
+        WriteNodeFlags(m_buffer, a_handle, a_obj);
+
+        m_actors.insert_or_assign(a_handle, std::move(entry));
+
+        Flush();
+    }
+
+    void MotionRecorder::OnRemoveActor(SKSE::ObjectHandle a_handle)
+    {
+        if (!m_recording)
+            return;
+
+        if (m_actors.erase(a_handle) == 0)
+            return;
+
+        Write(m_buffer, RecordType::kRemoveActor);
+        Write(m_buffer, a_handle);
+
+        Flush();
+    }
+
+    void MotionRecorder::OnConfigUpdate(SKSE::ObjectHandle a_handle, const SimObject& a_obj, const configComponents_t& a_config)
+    {
+        if (!m_recording)
+            return;
+
+        if (m_actors.find(a_handle) == m_actors.end())
+            return;
+
+        CheckGlobals();
+
+        auto configId = GetConfigId(a_config);
+
+        Write(m_buffer, RecordType::kActorConfig);
+        Write(m_buffer, a_handle);
+        Write(m_buffer, configId);
+
+        WriteNodeFlags(m_buffer, a_handle, a_obj);
+
+        Flush();
+    }
+
+    void MotionRecorder::OnApplyForce(
+        SKSE::ObjectHandle a_handle,
+        std::uint32_t a_steps,
+        const std::string& a_component,
+        const NiPoint3& a_force)
+    {
+        if (!m_recording)
+            return;
+
+        if (a_handle && m_actors.find(a_handle) == m_actors.end())
+            return;
+
+        Write(m_buffer, RecordType::kForce);
+        Write(m_buffer, a_handle);
+        Write(m_buffer, a_steps);
+        Write(m_buffer, a_component);
+        Write(m_buffer, a_force.x);
+        Write(m_buffer, a_force.y);
+        Write(m_buffer, a_force.z);
+
+        Flush();
+    }
+
+    void MotionRecorder::OnReset(SKSE::ObjectHandle a_handle)
+    {
+        if (!m_recording)
+            return;
+
+        if (m_actors.find(a_handle) == m_actors.end())
+            return;
+
+        Write(m_buffer, RecordType::kReset);
+        Write(m_buffer, a_handle);
+
+        Flush();
+    }
+
+    void MotionRecorder::OnTickBegin()
+    {
+        if (!m_recording)
+            return;
+
+        for (auto& e : m_actors)
+        {
+            auto& entry = e.second;
+
+            for (std::size_t i = 0; i < entry.driven.size(); i++)
+                entry.drivenState[i] = entry.driven[i].GetTransform();
+
+            entry.animated.clear();
+
+            for (std::size_t i = 0; i < entry.nodes.size(); i++)
+            {
+                auto& local = entry.nodes[i]->m_localTransform;
+
+                if (std::memcmp(std::addressof(local), std::addressof(entry.lastLocal[i]), sizeof(NiTransform)) != 0)
+                    entry.animated.emplace_back(static_cast<std::uint16_t>(i), local);
+            }
+        }
+    }
+
+    void MotionRecorder::OnFrame(float a_interval, const simActorList_t& a_actors)
+    {
+        if (!m_recording)
+            return;
+
+        CheckGlobals();
+
+        std::uint32_t count = 0;
+        for (const auto& e : a_actors)
+            if (m_actors.find(e.first) != m_actors.end())
+                count++;
+
+        Write(m_buffer, RecordType::kFrame);
+        Write(m_buffer, a_interval);
+        Write(m_buffer, count);
+
+        for (const auto& e : a_actors)
+        {
+            auto it = m_actors.find(e.first);
+            if (it == m_actors.end())
+                continue;
+
+            Write(m_buffer, e.first);
+            Write(m_buffer, static_cast<std::uint8_t>(e.second.GetLODTier()));
+            Write(m_buffer, e.second.GetLODInterval());
+            Write(m_buffer, e.second.IsDeferred());
+
+            auto& entry = it->second;
+
+            Write(m_buffer, static_cast<std::uint16_t>(entry.drivenState.size()));
+            for (const auto& n : entry.drivenState)
+                Write(m_buffer, n);
+
+            Write(m_buffer, static_cast<std::uint16_t>(entry.animated.size()));
+            for (const auto& n : entry.animated)
+            {
+                Write(m_buffer, n.first);
+                Write(m_buffer, n.second);
+            }
+
+            entry.animated.clear();
+
+            for (std::size_t i = 0; i < entry.nodes.size(); i++)
+                entry.lastLocal[i] = entry.nodes[i]->m_localTransform;
+        }
+
+        m_frames++;
+
+        Flush();
+    }
+
+    bool MotionReader::Open(const fs::path& a_path)
+    {
+        try
+        {
+            m_in.reset();
+            m_file.close();
+
+            m_file.open(a_path, std::ios_base::in | std::ios_base::binary);
+            if (!m_file.is_open())
+                throw std::runtime_error("Could not open file for reading");
+
+            using namespace boost::iostreams;
+
+            m_in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 128));
+            m_in.push(m_file);
+
+            std::uint32_t magic, version;
+
+            Read(magic);
+            Read(version);
+
+            if (magic != MAGIC)
+                throw std::runtime_error("Not a motion recording");
+
+            if (version != VERSION)
+                throw std::runtime_error("Unsupported version");
+
+            Read(m_timeAccum);
+
+            return true;
+        }
+        catch (const std::exception& e)
+        {
+            m_lastException = e;
+            Error("%s: %s", __FUNCTION__, e.what());
+            return false;
+        }
+    }
+
+    bool MotionReader::Next(RecordType& a_out)
+    {
+        std::uint8_t type;
+
+        m_in.read(reinterpret_cast<char*>(std::addressof(type)), sizeof(type));
+        if (m_in.gcount() != sizeof(type))
+            return false;
+
+        if (type < static_cast<std::uint8_t>(RecordType::kGlobals) ||
+            type > static_cast<std::uint8_t>(RecordType::kFrame))
+        {
+            throw std::runtime_error("Unknown record type");
+        }
+
+        a_out = static_cast<RecordType>(type);
+
+        return true;
+    }
+
+    void MotionReader::Read(std::string& a_out)
+    {
+        std::uint16_t size;
+        Read(size);
+
+        a_out.resize(size);
+
+        m_in.read(a_out.data(), size);
+        if (m_in.gcount() != size)
+            throw std::runtime_error("Unexpected end of stream");
+    }
+
+    void MotionReader::Read(NiTransform& a_out)
+    {
+        for (int i = 0; i < 3; i++)
+            for (int j = 0; j < 3; j++)
+                Read(a_out.rot.data[i][j]);
+
+        Read(a_out.pos.x);
+        Read(a_out.pos.y);
+        Read(a_out.pos.z);
+        Read(a_out.scale);
+    }
+
+    void MotionReader::Read(std::vector<nodeFlags_t>& a_out)
+    {
+        std::uint32_t count;
+        Read(count);
+
+        a_out.resize(count);
+
+        for (auto& e : a_out)
+        {
+            Read(e.name);
+            Read(e.flags);
+        }
+    }
+
+    void MotionReader::Read(globals_t& a_out)
+    {
+        auto& phys = a_out.phys;
+
+        Read(phys.colMaxPenetrationDepth);
+        Read(phys.timeTick);
+        Read(phys.maxSubSteps);
+        Read(phys.collisions);
+        Read(phys.collisionBackend);
+        Read(phys.collisionInterval);
+        Read(phys.numThreads);
+        Read(phys.sleeping);
+        Read(phys.sleepVelocity);
+        Read(phys.sleepOffset);
+        Read(phys.sleepSteps);
+        Read(phys.wakeDistance);
+        Read(phys.wakeContactDepth);
+        Read(phys.lod);
+        Read(phys.lodMidDistance);
+        Read(phys.lodFarDistance);
+        Read(phys.lodMidInterval);
+        Read(phys.budget);
+        Read(phys.pbdIterations);
+
+        std::uint32_t count;
+        Read(count);
+
+        a_out.chains.resize(count);
+
+        for (auto& e : a_out.chains)
+        {
+            Read(count);
+
+            e.resize(count);
+
+            for (auto& n : e)
+                Read(n);
+        }
+    }
+
+    void MotionReader::Read(config_t& a_out)
+    {
+        Read(a_out.id);
+
+        std::uint32_t count;
+        Read(count);
+
+        a_out.components.clear();
+
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            std::string group;
+            Read(group);
+
+            configComponent_t conf;
+            Read(conf);
+
+            a_out.components.insert_or_assign(std::move(group), conf);
+        }
+    }
+
+    void MotionReader::Read(addActor_t& a_out)
+    {
+        Read(a_out.handle);
+        Read(a_out.id);
+        Read(a_out.sex);
+        Read(a_out.weight);
+        Read(a_out.configId);
+
+        std::uint32_t count;
+
+        Read(count);
+        a_out.driven.resize(count);
+
+        for (auto& e : a_out.driven)
+        {
+            Read(e.name);
+            Read(e.parent);
+            Read(e.transform);
+        }
+
+        Read(count);
+        a_out.nodes.resize(count);
+
+        for (auto& e : a_out.nodes)
+        {
+            Read(e.name);
+            Read(e.parent);
+            Read(e.confGroup);
+            Read(e.local);
+        }
+
+        Read(a_out.flags);
+    }
+
+    void MotionReader::Read(actorConfig_t& a_out)
+    {
+        Read(a_out.handle);
+        Read(a_out.configId);
+        Read(a_out.flags);
+    }
+
+    void MotionReader::Read(force_t& a_out)
+    {
+        Read(a_out.handle);
+        Read(a_out.steps);
+        Read(a_out.component);
+        Read(a_out.force.x);
+        Read(a_out.force.y);
+        Read(a_out.force.z);
+    }
+
+    void MotionReader::Read(frame_t& a_out)
+    {
+        Read(a_out.interval);
+
+        std::uint32_t count;
+        Read(count);
+
+        a_out.actors.resize(count);
+
+        for (auto& e : a_out.actors)
+        {
+            std::uint8_t tier;
+
+            Read(e.handle);
+            Read(tier);
+            Read(e.lodInterval);
+            Read(e.deferred);
+
+            e.lodTier = static_cast<LODTier>(tier);
+
+            std::uint16_t driven;
+            Read(driven);
+
+            e.driven.resize(driven);
+
+            for (auto& n : e.driven)
+                Read(n);
+
+            std::uint16_t animated;
+            Read(animated);
+
+            e.animated.resize(animated);
+
+            for (auto& n : e.animated)
+            {
+                Read(n.first);
+                Read(n.second);
+            }
+        }
+    }
+
+    SKSE::ObjectHandle MotionReader::ReadHandle()
+    {
+        SKSE::ObjectHandle handle;
+        Read(handle);
+        return handle;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,263 @@
+#pragma once
+
+namespace CBP
+{
+    // Gzip compressed stream: header (magic, version, fixed step remainder), then tagged
+    // records in the order they happened.
+    //
+    // Only what the simulation reads from the game is stored: the world transforms of the
+    // nodes simulated nodes are parented to (driven nodes), local transforms the game wrote
+    // to simulated nodes (animation), frame intervals, LOD/deferral decisions, config and
+    // force events. Replaying them through SimObject reproduces the simulation without the
+    // game.
+    namespace Recording
+    {
+        static constexpr std::uint32_t MAGIC = 'MRBC';
+        static constexpr std::uint32_t VERSION = 3;
+
+        enum class RecordType : std::uint8_t
+        {
+            kGlobals = 1,
+            kConfig,
+            kAddActor,
+            kActorConfig,
+            kForce,
+            kReset,
+            kRemoveActor,
+            kFrame
+        };
+
+        enum NodeFlags : std::uint8_t
+        {
+            kNodeCollisions = 1 << 0,
+            kNodeMovement = 1 << 1
+        };
+
+        struct nodeFlags_t
+        {
+            std::string name;
+            std::uint8_t flags;
+        };
+
+        // Driven nodes below a simulated node are moved by Interpolate, those keep their
+        // parent and are stored as local transforms. The rest are placed in world space.
+        struct drivenNode_t
+        {
+            std::string name;
+            // empty when placed in world space
+            std::string parent;
+            NiTransform transform;
+        };
+
+        struct simNode_t
+        {
+            std::string name;
+            std::string parent;
+            std::string confGroup;
+            NiTransform local;
+        };
+
+        struct globals_t
+        {
+            decltype(configGlobal_t::phys) phys;
+            nodeChains_t chains;
+        };
+
+        struct config_t
+        {
+            std::uint32_t id;
+            configComponents_t components;
+        };
+
+        struct addActor_t
+        {
+            SKSE::ObjectHandle handle;
+            // SimObject id, also staggers LOD intervals
+            std::uint64_t id;
+            char sex;
+            float weight;
+            std::uint32_t configId;
+            std::vector<drivenNode_t> driven;
+            // sorted by name, the order CreateNodeDescriptorList produces
+            std::vector<simNode_t> nodes;
+            std::vector<nodeFlags_t> flags;
+        };
+
+        struct actorConfig_t
+        {
+            SKSE::ObjectHandle handle;
+            std::uint32_t configId;
+            std::vector<nodeFlags_t> flags;
+        };
+
+        struct force_t
+        {
+            SKSE::ObjectHandle handle;
+            std::uint32_t steps;
+            std::string component;
+            NiPoint3 force;
+        };
+
+        struct actorFrame_t
+        {
+            SKSE::ObjectHandle handle;
+            LODTier lodTier;
+            std::uint32_t lodInterval;
+            bool deferred;
+            // same order and space as addActor_t::driven, taken before the frame was simulated
+            std::vector<NiTransform> driven;
+            // simulated nodes (index into addActor_t::nodes) whose local transform changed
+            // since the simulation last wrote it
+            std::vector<std::pair<std::uint16_t, NiTransform>> animated;
+        };
+
+        struct frame_t
+        {
+            float interval;
+            std::vector<actorFrame_t> actors;
+        };
+    }
+
+    class MotionRecorder :
+        ILog
+    {
+        struct drivenEntry_t
+        {
+            NiPointer<NiAVObject> node;
+            bool local;
+
+            [[nodiscard]] inline const NiTransform& GetTransform() const {
+                return local ? node->m_localTransform : node->m_worldTransform;
+            }
+        };
+
+        struct actorEntry_t
+        {
+            std::vector<drivenEntry_t> driven;
+            // as the simulation saw them at the start of the frame
+            std::vector<NiTransform> drivenState;
+            std::vector<NiPointer<NiAVObject>> nodes;
+            // local transforms at the end of the last frame
+            std::vector<NiTransform> lastLocal;
+            std::vector<std::pair<std::uint16_t, NiTransform>> animated;
+        };
+
+    public:
+        MotionRecorder() = default;
+        virtual ~MotionRecorder() noexcept;
+
+        MotionRecorder(const MotionRecorder&) = delete;
+        MotionRecorder& operator=(const MotionRecorder&) = delete;
+
+        // Actors simulated before Start aren't recorded, callers re-add them.
+        bool Start(const fs::path& a_path, float a_timeAccum);
+        void Stop();
+
+        [[nodiscard]] inline bool IsRecording() const noexcept {
+            return m_recording;
+        }
+
+        [[nodiscard]] inline std::uint64_t GetFrames() const noexcept {
+            return m_frames;
+        }
+
+        [[nodiscard]] inline const auto& GetLastException() const noexcept {
+            return m_lastException;
+        }
+
+        void OnAddActor(SKSE::ObjectHandle a_handle, Actor* a_actor, const SimObject& a_obj, const configComponents_t& a_config);
+        void OnRemoveActor(SKSE::ObjectHandle a_handle);
+        void OnConfigUpdate(SKSE::ObjectHandle a_handle, const SimObject& a_obj, const configComponents_t& a_config);
+        void OnApplyForce(SKSE::ObjectHandle a_handle, std::uint32_t a_steps, const std::string& a_component, const NiPoint3& a_force);
+        void OnReset(SKSE::ObjectHandle a_handle);
+        // before anything in PhysicsTick touches the scene graph
+        void OnTickBegin();
+        void OnFrame(float a_interval, const simActorList_t& a_actors);
+
+        FN_NAMEPROC("MotionRecorder")
+    private:
+        template <typename T>
+        static inline void Write(std::string& a_out, const T& a_value) {
+            a_out.append(reinterpret_cast<const char*>(std::addressof(a_value)), sizeof(T));
+        }
+
+        static void Write(std::string& a_out, const char* a_value);
+        static void Write(std::string& a_out, const std::string& a_value);
+        static void Write(std::string& a_out, const NiTransform& a_value);
+        static void WriteNodeFlags(std::string& a_out, SKSE::ObjectHandle a_handle, const SimObject& a_obj);
+
+        static void AddDriven(actorEntry_t& a_entry, NiAVObject* a_node, const std::unordered_set<const NiAVObject*>& a_simulated);
+
+        void CheckGlobals();
+        std::uint32_t GetConfigId(const configComponents_t& a_config);
+
+        void Flush();
+
+        boost::iostreams::filtering_ostream m_out;
+        std::ofstream m_file;
+
+        std::string m_buffer;
+
+        std::unordered_map<SKSE::ObjectHandle, actorEntry_t> m_actors;
+        std::unordered_map<std::string, std::uint32_t> m_configs;
+        std::string m_lastGlobals;
+
+        std::uint64_t m_frames = 0;
+        bool m_recording = false;
+
+        except::descriptor m_lastException;
+    };
+
+    class MotionReader :
+        ILog
+    {
+    public:
+        MotionReader() = default;
+
+        MotionReader(const MotionReader&) = delete;
+        MotionReader& operator=(const MotionReader&) = delete;
+
+        bool Open(const fs::path& a_path);
+
+        // false at the end of the stream
+        [[nodiscard]] bool Next(Recording::RecordType& a_out);
+
+        void Read(Recording::globals_t& a_out);
+        void Read(Recording::config_t& a_out);
+        void Read(Recording::addActor_t& a_out);
+        void Read(Recording::actorConfig_t& a_out);
+        void Read(Recording::force_t& a_out);
+        void Read(Recording::frame_t& a_out);
+        // kReset, kRemoveActor
+        [[nodiscard]] SKSE::ObjectHandle ReadHandle();
+
+        [[nodiscard]] inline float GetTimeAccum() const noexcept {
+            return m_timeAccum;
+        }
+
+        [[nodiscard]] inline const auto& GetLastException() const noexcept {
+            return m_lastException;
+        }
+
+        FN_NAMEPROC("MotionReader")
+    private:
+        template <typename T>
+        inline void Read(T& a_out)
+        {
+            m_in.read(reinterpret_cast<char*>(std::addressof(a_out)), sizeof(T));
+            if (m_in.gcount() != sizeof(T))
+                throw std::runtime_error("Unexpected end of stream");
+        }
+
+        void Read(std::string& a_out);
+        void Read(NiTransform& a_out);
+        void Read(std::vector<Recording::nodeFlags_t>& a_out);
+
+        boost::iostreams::filtering_istream m_in;
+        std::ifstream m_file;
+
+        float m_timeAccum = 0.0f;
+
+        except::descriptor m_lastException;
+    };
+}
\ No newline at end of file
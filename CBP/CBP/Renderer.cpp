@@ -94,6 +94,13 @@ namespace CBP
         GenerateMovingNodes(a_actorList, a_radius, a_markedHandle);
     }
 
+    void Renderer::UpdateSpheres(const SphereWorld& a_world)
+    {
+        a_world.VisitActive([&](const NiPoint3& a_pos, float a_radius) {
+            GenerateSphere(a_pos, a_radius, COLLIDER_COL);
+        });
+    }
+
     void Renderer::Clear()
     {
         m_tris.clear();
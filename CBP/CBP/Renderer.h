@@ -29,6 +29,7 @@ namespace CBP
         void Draw();
         void Update(const r3d::DebugRenderer& a_dr);
         void UpdateMovingNodes(const simActorList_t& a_actorList, float a_radius, SKSE::ObjectHandle a_markedHandle);
+        void UpdateSpheres(const SphereWorld& a_world);
         void Clear();
 
     private:
@@ -37,6 +38,7 @@ namespace CBP
 
         static constexpr auto MOVING_NODES_COL = DirectX::XMFLOAT4(1.0f, 0.0f, 0.0f, 0.75f);
         static constexpr auto ACTOR_MARKER_COL = DirectX::XMFLOAT4(0.921f, 0.596f, 0.203f, 0.75f);
+        static constexpr auto COLLIDER_COL = DirectX::XMFLOAT4(0.0f, 0.5f, 1.0f, 0.5f);
 
         std::unique_ptr<DirectX::BasicEffect> m_effect;
         std::unique_ptr<DirectX::CommonStates> m_states;
@@ -97,6 +97,7 @@ namespace CBP
             simComponent["colSphereOffsetZMax"] = v.second.colSphereOffsetZMax;
             simComponent["colDampingCoef"] = v.second.colDampingCoef;
             simComponent["colDepthMul"] = v.second.colDepthMul;
+            simComponent["integrator"] = v.second.integrator;
         }
     }
 
@@ -175,7 +176,7 @@ namespace CBP
                 return;
 
             if (!root.isObject())
-                throw std::exception("Root not an object");
+                throw std::runtime_error("Root not an object");
 
             if (root.isMember("general"))
             {
@@ -184,6 +185,9 @@ namespace CBP
                 globalConfig.general.femaleOnly = general.get("femaleOnly", true).asBool();
                 globalConfig.general.enableProfiling = general.get("enableProfiling", false).asBool();
                 globalConfig.general.profilingInterval = general.get("profilingInterval", 1000).asInt();
+                globalConfig.general.traceFrames = general.get("traceFrames", 300).asInt();
+                globalConfig.general.costAttribution = general.get("costAttribution", false).asBool();
+                globalConfig.general.costSampleInterval = general.get("costSampleInterval", 8).asInt();
             }
 
             if (root.isMember("physics"))
@@ -194,6 +198,21 @@ namespace CBP
                 globalConfig.phys.maxSubSteps = phys.get("maxSubSteps", 5.0f).asFloat();
                 globalConfig.phys.colMaxPenetrationDepth = phys.get("colMaxPenetrationDepth", 50.0f).asFloat();
                 globalConfig.phys.collisions = phys.get("collisions", true).asBool();
+                globalConfig.phys.collisionBackend = phys.get("collisionBackend", 0).asInt();
+                globalConfig.phys.collisionInterval = phys.get("collisionInterval", 1).asInt();
+                globalConfig.phys.numThreads = phys.get("numThreads", 0).asInt();
+                globalConfig.phys.sleeping = phys.get("sleeping", true).asBool();
+                globalConfig.phys.sleepVelocity = phys.get("sleepVelocity", 0.5f).asFloat();
+                globalConfig.phys.sleepOffset = phys.get("sleepOffset", 0.01f).asFloat();
+                globalConfig.phys.sleepSteps = phys.get("sleepSteps", 30).asInt();
+                globalConfig.phys.wakeDistance = phys.get("wakeDistance", 0.1f).asFloat();
+                globalConfig.phys.wakeContactDepth = phys.get("wakeContactDepth", 0.5f).asFloat();
+                globalConfig.phys.lod = phys.get("lod", true).asBool();
+                globalConfig.phys.lodMidDistance = phys.get("lodMidDistance", 2000.0f).asFloat();
+                globalConfig.phys.lodFarDistance = phys.get("lodFarDistance", 5000.0f).asFloat();
+                globalConfig.phys.lodMidInterval = phys.get("lodMidInterval", 2).asInt();
+                globalConfig.phys.budget = phys.get("budget", 0).asInt();
+                globalConfig.phys.pbdIterations = phys.get("pbdIterations", 4).asInt();
             }
 
             if (root.isMember("ui"))
@@ -213,7 +232,7 @@ namespace CBP
                 globalConfig.ui.showKey = static_cast<UInt32>(ui.get("showKey", DIK_END).asUInt());
                 globalConfig.ui.comboKeyDR = static_cast<UInt32>(ui.get("comboKeyDR", DIK_LSHIFT).asUInt());
                 globalConfig.ui.showKeyDR = static_cast<UInt32>(ui.get("showKeyDR", DIK_PGDN).asUInt());
-                globalConfig.ui.lastActor = static_cast<SKSE::ObjectHandle>(ui.get("lastActor", 0ULL).asUInt64());
+                globalConfig.ui.lastActor = static_cast<SKSE::ObjectHandle>(ui.get("lastActor", Json::UInt64(0)).asUInt64());
                 globalConfig.ui.fontScale = ui.get("fontScale", 1.0f).asFloat();
 
                 if (ui.isMember("force")) {
@@ -357,6 +376,9 @@ namespace CBP
             general["femaleOnly"] = globalConfig.general.femaleOnly;
             general["enableProfiling"] = globalConfig.general.enableProfiling;
             general["profilingInterval"] = globalConfig.general.profilingInterval;
+            general["traceFrames"] = globalConfig.general.traceFrames;
+            general["costAttribution"] = globalConfig.general.costAttribution;
+            general["costSampleInterval"] = globalConfig.general.costSampleInterval;
 
             auto& phys = root["physics"];
 
@@ -364,6 +386,21 @@ namespace CBP
             phys["maxSubSteps"] = globalConfig.phys.maxSubSteps;
             phys["colMaxPenetrationDepth"] = globalConfig.phys.colMaxPenetrationDepth;
             phys["collisions"] = globalConfig.phys.collisions;
+            phys["collisionBackend"] = globalConfig.phys.collisionBackend;
+            phys["collisionInterval"] = globalConfig.phys.collisionInterval;
+            phys["numThreads"] = globalConfig.phys.numThreads;
+            phys["sleeping"] = globalConfig.phys.sleeping;
+            phys["sleepVelocity"] = globalConfig.phys.sleepVelocity;
+            phys["sleepOffset"] = globalConfig.phys.sleepOffset;
+            phys["sleepSteps"] = globalConfig.phys.sleepSteps;
+            phys["wakeDistance"] = globalConfig.phys.wakeDistance;
+            phys["wakeContactDepth"] = globalConfig.phys.wakeContactDepth;
+            phys["lod"] = globalConfig.phys.lod;
+            phys["lodMidDistance"] = globalConfig.phys.lodMidDistance;
+            phys["lodFarDistance"] = globalConfig.phys.lodFarDistance;
+            phys["lodMidInterval"] = globalConfig.phys.lodMidInterval;
+            phys["budget"] = globalConfig.phys.budget;
+            phys["pbdIterations"] = globalConfig.phys.pbdIterations;
 
             auto& ui = root["ui"];
 
@@ -543,7 +580,7 @@ namespace CBP
             return 0;
 
         if (!a_root.isObject())
-            throw std::exception("Expected an object");
+            throw std::runtime_error("Expected an object");
 
         size_t c = 0;
 
@@ -578,7 +615,7 @@ namespace CBP
         return c;
     }
 
-    size_t ISerialization::LoadGlobalProfile(SKSESerializationInterface* intfc, std::stringstream& a_data)
+    size_t ISerialization::LoadGlobalProfile(SKSESerializationInterface*, std::stringstream& a_data)
     {
         try
         {
@@ -602,7 +639,7 @@ namespace CBP
             Json::Value root;
 
             if (!ReadJsonData(PLUGIN_CBP_GLOBPROFILE_DEFAULT_DATA, root))
-                throw std::exception("Couldn't load the default profile");
+                throw std::runtime_error("Couldn't load the default profile");
 
             return _LoadGlobalProfile(root) != 0;
         }
@@ -624,7 +661,7 @@ namespace CBP
             return 0;
 
         if (!a_root.isObject())
-            throw std::exception("Expected an object");
+            throw std::runtime_error("Expected an object");
 
         size_t c = 0;
 
@@ -714,16 +751,16 @@ namespace CBP
     void ISerialization::ReadImportData(const fs::path& a_path, Json::Value& a_out)
     {
         if (!ReadJsonData(a_path, a_out))
-            throw std::exception("Couldn't read data");
+            throw std::runtime_error("Couldn't read data");
 
         if (a_out.empty())
-            throw std::exception("Empty root object");
+            throw std::runtime_error("Empty root object");
 
         if (!a_out.isMember("actors") ||
             !a_out.isMember("races") ||
             !a_out.isMember("global"))
         {
-            throw std::exception("One or more expected members not found");
+            throw std::runtime_error("One or more expected members not found");
         }
     }
 
@@ -766,10 +803,10 @@ namespace CBP
             _LoadRaceProfiles(intfc, root["races"], raceConfigComponents);
 
             if (!m_componentParser.Parse(root["global"], globalComponentData))
-                throw std::exception("Error while parsing global component data");
+                throw std::runtime_error("Error while parsing global component data");
 
             if (!m_nodeParser.Parse(root["global"], globalNodeData))
-                throw std::exception("Error while parsing global node data");
+                throw std::runtime_error("Error while parsing global node data");
 
             IConfig::SetActorConfigHolder(std::move(actorConfigComponents));
             IConfig::SetActorNodeConfigHolder(std::move(actorConfigNodes));
@@ -839,7 +876,7 @@ namespace CBP
             return 0;
 
         if (!a_root.isObject())
-            throw std::exception("Expected an object");
+            throw std::runtime_error("Expected an object");
 
         size_t c = 0;
 
@@ -1028,7 +1065,7 @@ namespace CBP
 
         ifs.open(a_path, std::ifstream::in | std::ifstream::binary);
         if (!ifs.is_open())
-            throw std::exception("Could not open file for reading");
+            throw std::runtime_error("Could not open file for reading");
 
         ifs >> a_root;
 
@@ -1041,15 +1078,15 @@ namespace CBP
 
         if (!fs::exists(base)) {
             if (!fs::create_directories(base))
-                throw std::exception("Couldn't create profile directory");
+                throw std::runtime_error("Couldn't create profile directory");
         }
         else if (!fs::is_directory(base))
-            throw std::exception("Root path is not a directory");
+            throw std::runtime_error("Root path is not a directory");
 
         std::ofstream ofs;
         ofs.open(a_path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
         if (!ofs.is_open()) {
-            throw std::exception("Could not open file for writing");
+            throw std::runtime_error("Could not open file for writing");
         }
 
         ofs << a_root << std::endl;
@@ -1064,4 +1101,48 @@ namespace CBP
 
         return !failed;
     }
+
+    std::streamsize ISerialization::Compress(std::stringstream& a_in, std::string& a_out, int a_level)
+    {
+        struct strsink : public boost::iostreams::sink
+        {
+            strsink(std::string& a_dataHolder) :
+                data(a_dataHolder)
+            {}
+
+            std::streamsize write(
+                const char* a_data,
+                std::streamsize a_len)
+            {
+                data.append(a_data, a_len);
+                return a_len;
+            }
+
+            std::string& data;
+        };
+
+        using namespace boost::iostreams;
+
+        strsink out(a_out);
+
+        filtering_streambuf<input> in;
+        in.push(gzip_compressor(gzip_params(a_level), 1024 * 128));
+        in.push(a_in);
+
+        return copy(in, out);
+    }
+
+    std::streamsize ISerialization::Decompress(const char* a_data, std::size_t a_length, std::stringstream& a_out)
+    {
+        using namespace boost::iostreams;
+
+        typedef basic_array_source<char> Device;
+        stream<Device> stream(a_data, a_length);
+
+        filtering_streambuf<input> in;
+        in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 128));
+        in.push(stream);
+
+        return copy(in, a_out);
+    }
 }
\ No newline at end of file
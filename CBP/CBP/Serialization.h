@@ -73,6 +73,11 @@ namespace CBP
 
         bool SavePending();
 
+        // gzip streams as stored in co-save records, both throw on failure and return the
+        // number of bytes written to a_out
+        static std::streamsize Compress(std::stringstream& a_in, std::string& a_out, int a_level);
+        static std::streamsize Decompress(const char* a_data, std::size_t a_length, std::stringstream& a_out);
+
         FN_NAMEPROC("Serialization")
     private:
         void ReadImportData(const fs::path& a_path, Json::Value& a_out);
@@ -0,0 +1,925 @@
+#include "pch.h"
+
+namespace CBP
+{
+    ISimKernel::kernelFunc_t ISimKernel::m_kernel = ISimKernel::IntegrateScalar;
+    ISimKernel::KernelType ISimKernel::m_type = ISimKernel::KernelType::kScalar;
+    ISimKernel::cpuFeatures_t ISimKernel::m_cpuFeatures{ false, false };
+
+    void ISimKernel::Initialize()
+    {
+        int info[4];
+
+        __cpuid(info, 0);
+        int maxLeaf = info[0];
+
+        __cpuid(info, 1);
+
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+
+        m_cpuFeatures.sse42 = (info[2] & (1 << 20)) != 0;
+        m_cpuFeatures.avx2 = false;
+
+        // check that the OS saves ymm state before looking at leaf 7
+        if (osxsave && avx && maxLeaf >= 7 &&
+            (_xgetbv(0) & 0x6) == 0x6)
+        {
+            __cpuidex(info, 7, 0);
+            m_cpuFeatures.avx2 = (info[1] & (1 << 5)) != 0;
+        }
+
+        if (m_cpuFeatures.avx2)
+            m_type = KernelType::kAVX2;
+        else if (m_cpuFeatures.sse42)
+            m_type = KernelType::kSSE42;
+        else
+            m_type = KernelType::kScalar;
+
+        m_kernel = GetKernel(m_type);
+    }
+
+    const char* ISimKernel::GetIntegratorName(IntegratorType a_type)
+    {
+        switch (a_type)
+        {
+        case IntegratorType::kImplicit:
+            return "Implicit";
+        case IntegratorType::kPBD:
+            return "PBD";
+        default:
+            return "Explicit";
+        }
+    }
+
+    const char* ISimKernel::GetKernelName(KernelType a_type)
+    {
+        switch (a_type)
+        {
+        case KernelType::kSSE42:
+            return "SSE4.2";
+        case KernelType::kAVX2:
+            return "AVX2";
+        default:
+            return "Scalar";
+        }
+    }
+
+    bool ISimKernel::IsSupported(KernelType a_type)
+    {
+        switch (a_type)
+        {
+        case KernelType::kScalar:
+            return true;
+        case KernelType::kSSE42:
+            return m_cpuFeatures.sse42;
+        case KernelType::kAVX2:
+            return m_cpuFeatures.avx2;
+        default:
+            return false;
+        }
+    }
+
+    bool ISimKernel::SetKernelType(KernelType a_type)
+    {
+        if (!IsSupported(a_type))
+            return false;
+
+        m_type = a_type;
+        m_kernel = GetKernel(a_type);
+
+        return true;
+    }
+
+    auto ISimKernel::GetKernel(KernelType a_type) ->
+        kernelFunc_t
+    {
+        switch (a_type)
+        {
+        case KernelType::kSSE42:
+            return IntegrateSSE42;
+        case KernelType::kAVX2:
+            return IntegrateAVX2;
+        default:
+            return IntegrateScalar;
+        }
+    }
+
+    void ISimKernel::IntegrateScalar(
+        const simKernelData_t& a_data,
+        std::uint32_t a_begin,
+        std::uint32_t a_end)
+    {
+        auto& d = a_data;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            float timeStep = d.dt[i];
+            if (!(timeStep > 0.0f))
+                continue;
+
+            if (d.flags[i] & SimStore::kFlagPBD)
+            {
+                IntegratePBD(a_data, i);
+                continue;
+            }
+
+            float tx = d.tx[i];
+            float ty = d.ty[i];
+            float tz = d.tz[i];
+
+            float dx = tx - d.px[i];
+            float dy = ty - d.py[i];
+            float dz = tz - d.pz[i];
+
+            if (std::fabs(dx) > SimStore::RESET_DISTANCE ||
+                std::fabs(dy) > SimStore::RESET_DISTANCE ||
+                std::fabs(dz) > SimStore::RESET_DISTANCE)
+            {
+                d.flags[i] |= SimStore::kFlagReset;
+                continue;
+            }
+
+            float dampingMul = d.dampingMul[i];
+
+            if (!(d.flags[i] & SimStore::kFlagInContact) && dampingMul > 1.0f)
+                d.dampingMul[i] = dampingMul = std::max(dampingMul / (timeStep + 1.0f), 1.0f);
+
+            // Compute the "Spring" Force
+            float k = d.stiffness[i];
+            float k2 = d.stiffness2[i];
+
+            float fx = (dx * k) + (dx * std::fabs(dx) * k2) + d.fx[i] / timeStep;
+            float fy = (dy * k) + (dy * std::fabs(dy) * k2) + d.fy[i] / timeStep;
+            float fz = (dz * k) + (dz * std::fabs(dz) * k2) + d.fz[i] / timeStep;
+
+            fz -= d.gravityBias[i];
+
+            // Assume mass is 1, so Accelleration is Force, can vary mass by changing force
+            float dm = (d.damping[i] * timeStep) * dampingMul;
+
+            float vx, vy, vz;
+
+            if (d.flags[i] & SimStore::kFlagImplicit)
+            {
+                // backward Euler with the quadratic term linearized around the current offset
+                float k2x2 = k2 + k2;
+                float dt2 = timeStep * timeStep;
+                float dmp1 = 1.0f + dm;
+
+                vx = (d.vx[i] + (fx * timeStep)) / (dmp1 + ((k + (k2x2 * std::fabs(dx))) * dt2));
+                vy = (d.vy[i] + (fy * timeStep)) / (dmp1 + ((k + (k2x2 * std::fabs(dy))) * dt2));
+                vz = (d.vz[i] + (fz * timeStep)) / (dmp1 + ((k + (k2x2 * std::fabs(dz))) * dt2));
+            }
+            else
+            {
+                vx = (d.vx[i] + (fx * timeStep)) - (d.vx[i] * dm);
+                vy = (d.vy[i] + (fy * timeStep)) - (d.vy[i] * dm);
+                vz = (d.vz[i] + (fz * timeStep)) - (d.vz[i] * dm);
+            }
+
+            float len = std::sqrt(vx * vx + vy * vy + vz * vz);
+            if (len > SimStore::VELOCITY_MAX)
+            {
+                float m = SimStore::VELOCITY_MAX / len;
+                vx *= m;
+                vy *= m;
+                vz *= m;
+            }
+
+            d.vx[i] = vx;
+            d.vy[i] = vy;
+            d.vz[i] = vz;
+
+            float maxOffset = d.maxOffset[i];
+
+            dx = std::clamp((d.px[i] + vx * timeStep) - tx, -maxOffset, maxOffset);
+            dy = std::clamp((d.py[i] + vy * timeStep) - ty, -maxOffset, maxOffset);
+            dz = std::clamp((d.pz[i] + vz * timeStep) - tz, -maxOffset, maxOffset);
+
+            float r00 = d.rot[0][i], r01 = d.rot[1][i], r02 = d.rot[2][i];
+            float r10 = d.rot[3][i], r11 = d.rot[4][i], r12 = d.rot[5][i];
+            float r20 = d.rot[6][i], r21 = d.rot[7][i], r22 = d.rot[8][i];
+
+            // parent space
+            float lx = r00 * dx + r10 * dy + r20 * dz;
+            float ly = r01 * dx + r11 * dy + r21 * dz;
+            float lz = r02 * dx + r12 * dy + r22 * dz;
+
+            d.lx[i] = lx;
+            d.ly[i] = ly;
+            d.lz[i] = lz;
+
+            d.px[i] = (r00 * lx + r01 * ly + r02 * lz) + tx;
+            d.py[i] = (r10 * lx + r11 * ly + r12 * lz) + ty;
+            d.pz[i] = (r20 * lx + r21 * ly + r22 * lz) + tz;
+        }
+    }
+
+    void ISimKernel::IntegratePBD(
+        const simKernelData_t& a_data,
+        std::uint32_t a_index)
+    {
+        auto& d = a_data;
+        auto i = a_index;
+
+        float timeStep = d.dt[i];
+        if (!(timeStep > 0.0f))
+            return;
+
+        float tx = d.tx[i];
+        float ty = d.ty[i];
+        float tz = d.tz[i];
+
+        float px = d.px[i];
+        float py = d.py[i];
+        float pz = d.pz[i];
+
+        if (std::fabs(tx - px) > SimStore::RESET_DISTANCE ||
+            std::fabs(ty - py) > SimStore::RESET_DISTANCE ||
+            std::fabs(tz - pz) > SimStore::RESET_DISTANCE)
+        {
+            d.flags[i] |= SimStore::kFlagReset;
+            return;
+        }
+
+        float dampingMul = d.dampingMul[i];
+
+        if (!(d.flags[i] & SimStore::kFlagInContact) && dampingMul > 1.0f)
+            d.dampingMul[i] = dampingMul = std::max(dampingMul / (timeStep + 1.0f), 1.0f);
+
+        float dm = (d.damping[i] * timeStep) * dampingMul;
+
+        // external forces and gravity, then predict
+        float vx = (d.vx[i] + d.fx[i]) / (1.0f + dm);
+        float vy = (d.vy[i] + d.fy[i]) / (1.0f + dm);
+        float vz = (d.vz[i] + d.fz[i] - (d.gravityBias[i] * timeStep)) / (1.0f + dm);
+
+        float cx = (px + vx * timeStep) - tx;
+        float cy = (py + vy * timeStep) - ty;
+        float cz = (pz + vz * timeStep) - tz;
+
+        // XPBD, one zero rest length spring per axis with compliance 1 / (k + k2 * |c|)
+        float k = d.stiffness[i];
+        float k2 = d.stiffness2[i];
+        float dt2 = timeStep * timeStep;
+
+        float lambdaX = 0.0f, lambdaY = 0.0f, lambdaZ = 0.0f;
+
+        for (std::uint32_t n = 0; n < d.pbdIterations; n++)
+        {
+            // stiffness * dt^2, the inverse of the scaled compliance
+            float sx = (k + k2 * std::fabs(cx)) * dt2;
+            float sy = (k + k2 * std::fabs(cy)) * dt2;
+            float sz = (k + k2 * std::fabs(cz)) * dt2;
+
+            float dlx = (-(cx * sx) - lambdaX) / (sx + 1.0f);
+            float dly = (-(cy * sy) - lambdaY) / (sy + 1.0f);
+            float dlz = (-(cz * sz) - lambdaZ) / (sz + 1.0f);
+
+            lambdaX += dlx;
+            lambdaY += dly;
+            lambdaZ += dlz;
+
+            cx += dlx;
+            cy += dly;
+            cz += dlz;
+        }
+
+        // max. offset is a hard limit
+        float maxOffset = d.maxOffset[i];
+
+        cx = std::clamp(cx, -maxOffset, maxOffset);
+        cy = std::clamp(cy, -maxOffset, maxOffset);
+        cz = std::clamp(cz, -maxOffset, maxOffset);
+
+        vx = ((cx + tx) - px) / timeStep;
+        vy = ((cy + ty) - py) / timeStep;
+        vz = ((cz + tz) - pz) / timeStep;
+
+        float len = std::sqrt(vx * vx + vy * vy + vz * vz);
+        if (len > SimStore::VELOCITY_MAX)
+        {
+            float m = SimStore::VELOCITY_MAX / len;
+            vx *= m;
+            vy *= m;
+            vz *= m;
+        }
+
+        d.vx[i] = vx;
+        d.vy[i] = vy;
+        d.vz[i] = vz;
+
+        float r00 = d.rot[0][i], r01 = d.rot[1][i], r02 = d.rot[2][i];
+        float r10 = d.rot[3][i], r11 = d.rot[4][i], r12 = d.rot[5][i];
+        float r20 = d.rot[6][i], r21 = d.rot[7][i], r22 = d.rot[8][i];
+
+        // parent space
+        float lx = r00 * cx + r10 * cy + r20 * cz;
+        float ly = r01 * cx + r11 * cy + r21 * cz;
+        float lz = r02 * cx + r12 * cy + r22 * cz;
+
+        d.lx[i] = lx;
+        d.ly[i] = ly;
+        d.lz[i] = lz;
+
+        d.px[i] = (r00 * lx + r01 * ly + r02 * lz) + tx;
+        d.py[i] = (r10 * lx + r11 * ly + r12 * lz) + ty;
+        d.pz[i] = (r20 * lx + r21 * ly + r22 * lz) + tz;
+    }
+
+    void ISimKernel::IntegrateSSE42(
+        const simKernelData_t& a_data,
+        std::uint32_t a_begin,
+        std::uint32_t a_end)
+    {
+        auto& d = a_data;
+
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 resetDist = _mm_set1_ps(SimStore::RESET_DISTANCE);
+        const __m128 velMax = _mm_set1_ps(SimStore::VELOCITY_MAX);
+        const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+        const __m128i contactBit = _mm_set1_epi32(SimStore::kFlagInContact);
+        const __m128i implicitBit = _mm_set1_epi32(SimStore::kFlagImplicit);
+        const __m128i pbdBit = _mm_set1_epi32(SimStore::kFlagPBD);
+
+        auto i = a_begin;
+
+        for (; i + 4 <= a_end; i += 4)
+        {
+            __m128 dt = _mm_loadu_ps(d.dt + i);
+            __m128 dtp1 = _mm_add_ps(dt, one);
+
+            std::int32_t fl;
+            std::memcpy(std::addressof(fl), d.flags + i, sizeof(fl));
+
+            __m128i flags = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(fl));
+
+            // position based lanes are left alone here and solved one by one below
+            __m128 pbd = _mm_castsi128_ps(
+                _mm_cmpgt_epi32(_mm_and_si128(flags, pbdBit), _mm_setzero_si128()));
+            __m128 skip = _mm_or_ps(_mm_cmple_ps(dt, zero), pbd);
+
+            __m128 tx = _mm_loadu_ps(d.tx + i);
+            __m128 ty = _mm_loadu_ps(d.ty + i);
+            __m128 tz = _mm_loadu_ps(d.tz + i);
+
+            __m128 px = _mm_loadu_ps(d.px + i);
+            __m128 py = _mm_loadu_ps(d.py + i);
+            __m128 pz = _mm_loadu_ps(d.pz + i);
+
+            __m128 dx = _mm_sub_ps(tx, px);
+            __m128 dy = _mm_sub_ps(ty, py);
+            __m128 dz = _mm_sub_ps(tz, pz);
+
+            __m128 adx = _mm_and_ps(dx, absMask);
+            __m128 ady = _mm_and_ps(dy, absMask);
+            __m128 adz = _mm_and_ps(dz, absMask);
+
+            __m128 reset = _mm_andnot_ps(skip, _mm_or_ps(
+                _mm_or_ps(_mm_cmpgt_ps(adx, resetDist), _mm_cmpgt_ps(ady, resetDist)),
+                _mm_cmpgt_ps(adz, resetDist)));
+
+            __m128 keep = _mm_or_ps(reset, skip);
+
+            __m128 noContact = _mm_castsi128_ps(
+                _mm_cmpeq_epi32(_mm_and_si128(flags, contactBit), _mm_setzero_si128()));
+            __m128 implicit = _mm_castsi128_ps(
+                _mm_cmpgt_epi32(_mm_and_si128(flags, implicitBit), _mm_setzero_si128()));
+
+            __m128 dampingMulOld = _mm_loadu_ps(d.dampingMul + i);
+            __m128 dampingMul = _mm_blendv_ps(
+                dampingMulOld,
+                _mm_max_ps(_mm_div_ps(dampingMulOld, dtp1), one),
+                _mm_and_ps(noContact, _mm_cmpgt_ps(dampingMulOld, one)));
+
+            __m128 k = _mm_loadu_ps(d.stiffness + i);
+            __m128 k2 = _mm_loadu_ps(d.stiffness2 + i);
+
+            __m128 fx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, k), _mm_mul_ps(_mm_mul_ps(dx, adx), k2)), _mm_div_ps(_mm_loadu_ps(d.fx + i), dt));
+            __m128 fy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dy, k), _mm_mul_ps(_mm_mul_ps(dy, ady), k2)), _mm_div_ps(_mm_loadu_ps(d.fy + i), dt));
+            __m128 fz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dz, k), _mm_mul_ps(_mm_mul_ps(dz, adz), k2)), _mm_div_ps(_mm_loadu_ps(d.fz + i), dt));
+
+            fz = _mm_sub_ps(fz, _mm_loadu_ps(d.gravityBias + i));
+
+            __m128 dm = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(d.damping + i), dt), dampingMul);
+
+            __m128 vxOld = _mm_loadu_ps(d.vx + i);
+            __m128 vyOld = _mm_loadu_ps(d.vy + i);
+            __m128 vzOld = _mm_loadu_ps(d.vz + i);
+
+            __m128 vx = _mm_sub_ps(_mm_add_ps(vxOld, _mm_mul_ps(fx, dt)), _mm_mul_ps(vxOld, dm));
+            __m128 vy = _mm_sub_ps(_mm_add_ps(vyOld, _mm_mul_ps(fy, dt)), _mm_mul_ps(vyOld, dm));
+            __m128 vz = _mm_sub_ps(_mm_add_ps(vzOld, _mm_mul_ps(fz, dt)), _mm_mul_ps(vzOld, dm));
+
+            // backward Euler lanes
+            __m128 k2x2 = _mm_add_ps(k2, k2);
+            __m128 dt2 = _mm_mul_ps(dt, dt);
+            __m128 dmp1 = _mm_add_ps(one, dm);
+
+            vx = _mm_blendv_ps(vx, _mm_div_ps(_mm_add_ps(vxOld, _mm_mul_ps(fx, dt)), _mm_add_ps(dmp1, _mm_mul_ps(_mm_add_ps(k, _mm_mul_ps(k2x2, adx)), dt2))), implicit);
+            vy = _mm_blendv_ps(vy, _mm_div_ps(_mm_add_ps(vyOld, _mm_mul_ps(fy, dt)), _mm_add_ps(dmp1, _mm_mul_ps(_mm_add_ps(k, _mm_mul_ps(k2x2, ady)), dt2))), implicit);
+            vz = _mm_blendv_ps(vz, _mm_div_ps(_mm_add_ps(vzOld, _mm_mul_ps(fz, dt)), _mm_add_ps(dmp1, _mm_mul_ps(_mm_add_ps(k, _mm_mul_ps(k2x2, adz)), dt2))), implicit);
+
+            __m128 len = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz)));
+            __m128 vm = _mm_blendv_ps(one, _mm_div_ps(velMax, len), _mm_cmpgt_ps(len, velMax));
+
+            vx = _mm_mul_ps(vx, vm);
+            vy = _mm_mul_ps(vy, vm);
+            vz = _mm_mul_ps(vz, vm);
+
+            __m128 maxOffset = _mm_loadu_ps(d.maxOffset + i);
+            __m128 minOffset = _mm_sub_ps(zero, maxOffset);
+
+            dx = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_add_ps(px, _mm_mul_ps(vx, dt)), tx), minOffset), maxOffset);
+            dy = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_add_ps(py, _mm_mul_ps(vy, dt)), ty), minOffset), maxOffset);
+            dz = _mm_min_ps(_mm_max_ps(_mm_sub_ps(_mm_add_ps(pz, _mm_mul_ps(vz, dt)), tz), minOffset), maxOffset);
+
+            __m128 r00 = _mm_loadu_ps(d.rot[0] + i), r01 = _mm_loadu_ps(d.rot[1] + i), r02 = _mm_loadu_ps(d.rot[2] + i);
+            __m128 r10 = _mm_loadu_ps(d.rot[3] + i), r11 = _mm_loadu_ps(d.rot[4] + i), r12 = _mm_loadu_ps(d.rot[5] + i);
+            __m128 r20 = _mm_loadu_ps(d.rot[6] + i), r21 = _mm_loadu_ps(d.rot[7] + i), r22 = _mm_loadu_ps(d.rot[8] + i);
+
+            // parent space
+            __m128 lx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r00, dx), _mm_mul_ps(r10, dy)), _mm_mul_ps(r20, dz));
+            __m128 ly = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r01, dx), _mm_mul_ps(r11, dy)), _mm_mul_ps(r21, dz));
+            __m128 lz = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r02, dx), _mm_mul_ps(r12, dy)), _mm_mul_ps(r22, dz));
+
+            _mm_storeu_ps(d.lx + i, _mm_blendv_ps(lx, _mm_loadu_ps(d.lx + i), keep));
+            _mm_storeu_ps(d.ly + i, _mm_blendv_ps(ly, _mm_loadu_ps(d.ly + i), keep));
+            _mm_storeu_ps(d.lz + i, _mm_blendv_ps(lz, _mm_loadu_ps(d.lz + i), keep));
+
+            __m128 npx = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r00, lx), _mm_mul_ps(r01, ly)), _mm_mul_ps(r02, lz)), tx);
+            __m128 npy = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r10, lx), _mm_mul_ps(r11, ly)), _mm_mul_ps(r12, lz)), ty);
+            __m128 npz = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(r20, lx), _mm_mul_ps(r21, ly)), _mm_mul_ps(r22, lz)), tz);
+
+            // skipped lanes and lanes flagged for reset keep their state, the scatter pass resets the latter
+            _mm_storeu_ps(d.px + i, _mm_blendv_ps(npx, px, keep));
+            _mm_storeu_ps(d.py + i, _mm_blendv_ps(npy, py, keep));
+            _mm_storeu_ps(d.pz + i, _mm_blendv_ps(npz, pz, keep));
+
+            _mm_storeu_ps(d.vx + i, _mm_blendv_ps(vx, vxOld, keep));
+            _mm_storeu_ps(d.vy + i, _mm_blendv_ps(vy, vyOld, keep));
+            _mm_storeu_ps(d.vz + i, _mm_blendv_ps(vz, vzOld, keep));
+
+            _mm_storeu_ps(d.dampingMul + i, _mm_blendv_ps(dampingMul, dampingMulOld, keep));
+
+            int resetMask = _mm_movemask_ps(reset);
+            if (resetMask)
+            {
+                for (std::uint32_t j = 0; j < 4; j++)
+                    if (resetMask & (1 << j))
+                        d.flags[i + j] |= SimStore::kFlagReset;
+            }
+
+            int pbdMask = _mm_movemask_ps(pbd);
+            if (pbdMask)
+            {
+                for (std::uint32_t j = 0; j < 4; j++)
+                    if (pbdMask & (1 << j))
+                        IntegratePBD(a_data, i + j);
+            }
+        }
+
+        IntegrateScalar(a_data, i, a_end);
+    }
+
+    void ISimKernel::IntegrateAVX2(
+        const simKernelData_t& a_data,
+        std::uint32_t a_begin,
+        std::uint32_t a_end)
+    {
+        auto& d = a_data;
+
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 resetDist = _mm256_set1_ps(SimStore::RESET_DISTANCE);
+        const __m256 velMax = _mm256_set1_ps(SimStore::VELOCITY_MAX);
+        const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+        const __m256i contactBit = _mm256_set1_epi32(SimStore::kFlagInContact);
+        const __m256i implicitBit = _mm256_set1_epi32(SimStore::kFlagImplicit);
+        const __m256i pbdBit = _mm256_set1_epi32(SimStore::kFlagPBD);
+
+        auto i = a_begin;
+
+        for (; i + 8 <= a_end; i += 8)
+        {
+            __m256 dt = _mm256_loadu_ps(d.dt + i);
+            __m256 dtp1 = _mm256_add_ps(dt, one);
+
+            __m256i flags = _mm256_cvtepu8_epi32(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(d.flags + i)));
+
+            // position based lanes are left alone here and solved one by one below
+            __m256 pbd = _mm256_castsi256_ps(
+                _mm256_cmpgt_epi32(_mm256_and_si256(flags, pbdBit), _mm256_setzero_si256()));
+            __m256 skip = _mm256_or_ps(_mm256_cmp_ps(dt, zero, _CMP_LE_OQ), pbd);
+
+            __m256 tx = _mm256_loadu_ps(d.tx + i);
+            __m256 ty = _mm256_loadu_ps(d.ty + i);
+            __m256 tz = _mm256_loadu_ps(d.tz + i);
+
+            __m256 px = _mm256_loadu_ps(d.px + i);
+            __m256 py = _mm256_loadu_ps(d.py + i);
+            __m256 pz = _mm256_loadu_ps(d.pz + i);
+
+            __m256 dx = _mm256_sub_ps(tx, px);
+            __m256 dy = _mm256_sub_ps(ty, py);
+            __m256 dz = _mm256_sub_ps(tz, pz);
+
+            __m256 adx = _mm256_and_ps(dx, absMask);
+            __m256 ady = _mm256_and_ps(dy, absMask);
+            __m256 adz = _mm256_and_ps(dz, absMask);
+
+            __m256 reset = _mm256_andnot_ps(skip, _mm256_or_ps(
+                _mm256_or_ps(_mm256_cmp_ps(adx, resetDist, _CMP_GT_OQ), _mm256_cmp_ps(ady, resetDist, _CMP_GT_OQ)),
+                _mm256_cmp_ps(adz, resetDist, _CMP_GT_OQ)));
+
+            __m256 keep = _mm256_or_ps(reset, skip);
+
+            __m256 noContact = _mm256_castsi256_ps(
+                _mm256_cmpeq_epi32(_mm256_and_si256(flags, contactBit), _mm256_setzero_si256()));
+            __m256 implicit = _mm256_castsi256_ps(
+                _mm256_cmpgt_epi32(_mm256_and_si256(flags, implicitBit), _mm256_setzero_si256()));
+
+            __m256 dampingMulOld = _mm256_loadu_ps(d.dampingMul + i);
+            __m256 dampingMul = _mm256_blendv_ps(
+                dampingMulOld,
+                _mm256_max_ps(_mm256_div_ps(dampingMulOld, dtp1), one),
+                _mm256_and_ps(noContact, _mm256_cmp_ps(dampingMulOld, one, _CMP_GT_OQ)));
+
+            __m256 k = _mm256_loadu_ps(d.stiffness + i);
+            __m256 k2 = _mm256_loadu_ps(d.stiffness2 + i);
+
+            __m256 fx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, k), _mm256_mul_ps(_mm256_mul_ps(dx, adx), k2)), _mm256_div_ps(_mm256_loadu_ps(d.fx + i), dt));
+            __m256 fy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dy, k), _mm256_mul_ps(_mm256_mul_ps(dy, ady), k2)), _mm256_div_ps(_mm256_loadu_ps(d.fy + i), dt));
+            __m256 fz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dz, k), _mm256_mul_ps(_mm256_mul_ps(dz, adz), k2)), _mm256_div_ps(_mm256_loadu_ps(d.fz + i), dt));
+
+            fz = _mm256_sub_ps(fz, _mm256_loadu_ps(d.gravityBias + i));
+
+            __m256 dm = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(d.damping + i), dt), dampingMul);
+
+            __m256 vxOld = _mm256_loadu_ps(d.vx + i);
+            __m256 vyOld = _mm256_loadu_ps(d.vy + i);
+            __m256 vzOld = _mm256_loadu_ps(d.vz + i);
+
+            __m256 vx = _mm256_sub_ps(_mm256_add_ps(vxOld, _mm256_mul_ps(fx, dt)), _mm256_mul_ps(vxOld, dm));
+            __m256 vy = _mm256_sub_ps(_mm256_add_ps(vyOld, _mm256_mul_ps(fy, dt)), _mm256_mul_ps(vyOld, dm));
+            __m256 vz = _mm256_sub_ps(_mm256_add_ps(vzOld, _mm256_mul_ps(fz, dt)), _mm256_mul_ps(vzOld, dm));
+
+            // backward Euler lanes
+            __m256 k2x2 = _mm256_add_ps(k2, k2);
+            __m256 dt2 = _mm256_mul_ps(dt, dt);
+            __m256 dmp1 = _mm256_add_ps(one, dm);
+
+            vx = _mm256_blendv_ps(vx, _mm256_div_ps(_mm256_add_ps(vxOld, _mm256_mul_ps(fx, dt)), _mm256_add_ps(dmp1, _mm256_mul_ps(_mm256_add_ps(k, _mm256_mul_ps(k2x2, adx)), dt2))), implicit);
+            vy = _mm256_blendv_ps(vy, _mm256_div_ps(_mm256_add_ps(vyOld, _mm256_mul_ps(fy, dt)), _mm256_add_ps(dmp1, _mm256_mul_ps(_mm256_add_ps(k, _mm256_mul_ps(k2x2, ady)), dt2))), implicit);
+            vz = _mm256_blendv_ps(vz, _mm256_div_ps(_mm256_add_ps(vzOld, _mm256_mul_ps(fz, dt)), _mm256_add_ps(dmp1, _mm256_mul_ps(_mm256_add_ps(k, _mm256_mul_ps(k2x2, adz)), dt2))), implicit);
+
+            __m256 len = _mm256_sqrt_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(vx, vx), _mm256_mul_ps(vy, vy)), _mm256_mul_ps(vz, vz)));
+            __m256 vm = _mm256_blendv_ps(one, _mm256_div_ps(velMax, len), _mm256_cmp_ps(len, velMax, _CMP_GT_OQ));
+
+            vx = _mm256_mul_ps(vx, vm);
+            vy = _mm256_mul_ps(vy, vm);
+            vz = _mm256_mul_ps(vz, vm);
+
+            __m256 maxOffset = _mm256_loadu_ps(d.maxOffset + i);
+            __m256 minOffset = _mm256_sub_ps(zero, maxOffset);
+
+            dx = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_add_ps(px, _mm256_mul_ps(vx, dt)), tx), minOffset), maxOffset);
+            dy = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_add_ps(py, _mm256_mul_ps(vy, dt)), ty), minOffset), maxOffset);
+            dz = _mm256_min_ps(_mm256_max_ps(_mm256_sub_ps(_mm256_add_ps(pz, _mm256_mul_ps(vz, dt)), tz), minOffset), maxOffset);
+
+            __m256 r00 = _mm256_loadu_ps(d.rot[0] + i), r01 = _mm256_loadu_ps(d.rot[1] + i), r02 = _mm256_loadu_ps(d.rot[2] + i);
+            __m256 r10 = _mm256_loadu_ps(d.rot[3] + i), r11 = _mm256_loadu_ps(d.rot[4] + i), r12 = _mm256_loadu_ps(d.rot[5] + i);
+            __m256 r20 = _mm256_loadu_ps(d.rot[6] + i), r21 = _mm256_loadu_ps(d.rot[7] + i), r22 = _mm256_loadu_ps(d.rot[8] + i);
+
+            // parent space
+            __m256 lx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r00, dx), _mm256_mul_ps(r10, dy)), _mm256_mul_ps(r20, dz));
+            __m256 ly = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r01, dx), _mm256_mul_ps(r11, dy)), _mm256_mul_ps(r21, dz));
+            __m256 lz = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r02, dx), _mm256_mul_ps(r12, dy)), _mm256_mul_ps(r22, dz));
+
+            _mm256_storeu_ps(d.lx + i, _mm256_blendv_ps(lx, _mm256_loadu_ps(d.lx + i), keep));
+            _mm256_storeu_ps(d.ly + i, _mm256_blendv_ps(ly, _mm256_loadu_ps(d.ly + i), keep));
+            _mm256_storeu_ps(d.lz + i, _mm256_blendv_ps(lz, _mm256_loadu_ps(d.lz + i), keep));
+
+            __m256 npx = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r00, lx), _mm256_mul_ps(r01, ly)), _mm256_mul_ps(r02, lz)), tx);
+            __m256 npy = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r10, lx), _mm256_mul_ps(r11, ly)), _mm256_mul_ps(r12, lz)), ty);
+            __m256 npz = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(r20, lx), _mm256_mul_ps(r21, ly)), _mm256_mul_ps(r22, lz)), tz);
+
+            _mm256_storeu_ps(d.px + i, _mm256_blendv_ps(npx, px, keep));
+            _mm256_storeu_ps(d.py + i, _mm256_blendv_ps(npy, py, keep));
+            _mm256_storeu_ps(d.pz + i, _mm256_blendv_ps(npz, pz, keep));
+
+            _mm256_storeu_ps(d.vx + i, _mm256_blendv_ps(vx, vxOld, keep));
+            _mm256_storeu_ps(d.vy + i, _mm256_blendv_ps(vy, vyOld, keep));
+            _mm256_storeu_ps(d.vz + i, _mm256_blendv_ps(vz, vzOld, keep));
+
+            _mm256_storeu_ps(d.dampingMul + i, _mm256_blendv_ps(dampingMul, dampingMulOld, keep));
+
+            int resetMask = _mm256_movemask_ps(reset);
+            if (resetMask)
+            {
+                for (std::uint32_t j = 0; j < 8; j++)
+                    if (resetMask & (1 << j))
+                        d.flags[i + j] |= SimStore::kFlagReset;
+            }
+
+            int pbdMask = _mm256_movemask_ps(pbd);
+            if (pbdMask)
+            {
+                for (std::uint32_t j = 0; j < 8; j++)
+                    if (pbdMask & (1 << j))
+                        IntegratePBD(a_data, i + j);
+            }
+        }
+
+        _mm256_zeroupper();
+
+        IntegrateScalar(a_data, i, a_end);
+    }
+
+    void ISimKernel::Benchmark(
+        std::uint32_t a_numNodes,
+        std::uint32_t a_iterations,
+        benchmarkResults_t& a_out)
+    {
+        constexpr float timeStep = 1.0f / 60.0f;
+
+        struct
+        {
+            std::vector<float> data[31];
+            std::vector<std::uint8_t> flags;
+        } src, work;
+
+        std::mt19937 gen(0x43425021);
+        std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+        std::uniform_real_distribution<float> angle(-3.14159265f, 3.14159265f);
+
+        for (auto& e : src.data)
+            e.resize(a_numNodes, 0.0f);
+
+        src.flags.resize(a_numNodes, 0);
+
+        // 0-8 pos/vel/ldiff, 9 dampingMul, 10-15 target/force, 16-24 rot, 25-29 conf, 30 step time
+        for (std::uint32_t i = 0; i < a_numNodes; i++)
+        {
+            src.data[30][i] = timeStep;
+
+            src.data[10][i] = offset(gen) * 10.0f;
+            src.data[11][i] = offset(gen) * 10.0f;
+            src.data[12][i] = offset(gen) * 10.0f;
+
+            src.data[0][i] = src.data[10][i] + offset(gen);
+            src.data[1][i] = src.data[11][i] + offset(gen);
+            src.data[2][i] = src.data[12][i] + offset(gen);
+
+            src.data[3][i] = offset(gen) * 5.0f;
+            src.data[4][i] = offset(gen) * 5.0f;
+            src.data[5][i] = offset(gen) * 5.0f;
+
+            src.data[9][i] = (i & 3) == 0 ? 4.0f : 1.0f;
+
+            src.data[13][i] = (i & 7) == 0 ? offset(gen) : 0.0f;
+
+            float a = angle(gen);
+            float c = std::cos(a), s = std::sin(a);
+
+            src.data[16][i] = c; src.data[17][i] = -s; src.data[18][i] = 0.0f;
+            src.data[19][i] = s; src.data[20][i] = c; src.data[21][i] = 0.0f;
+            src.data[22][i] = 0.0f; src.data[23][i] = 0.0f; src.data[24][i] = 1.0f;
+
+            src.data[25][i] = 10.0f;
+            src.data[26][i] = 10.0f;
+            src.data[27][i] = 0.95f;
+            src.data[28][i] = 20.0f;
+            src.data[29][i] = 5.0f;
+
+            src.flags[i] = (i & 5) == 0 ? SimStore::kFlagInContact : SimStore::kFlagNone;
+        }
+
+        for (std::size_t t = 0; t < a_out.size(); t++)
+        {
+            auto type = static_cast<KernelType>(t);
+            auto& result = a_out[t];
+
+            result.supported = IsSupported(type);
+            result.nsPerNode = 0.0;
+
+            if (!result.supported || !a_numNodes || !a_iterations)
+                continue;
+
+            work = src;
+
+            simKernelData_t d{
+                work.data[0].data(), work.data[1].data(), work.data[2].data(),
+                work.data[3].data(), work.data[4].data(), work.data[5].data(),
+                work.data[6].data(), work.data[7].data(), work.data[8].data(),
+                work.data[9].data(),
+                work.flags.data(),
+                work.data[30].data(),
+                work.data[10].data(), work.data[11].data(), work.data[12].data(),
+                work.data[13].data(), work.data[14].data(), work.data[15].data(),
+                {
+                    work.data[16].data(), work.data[17].data(), work.data[18].data(),
+                    work.data[19].data(), work.data[20].data(), work.data[21].data(),
+                    work.data[22].data(), work.data[23].data(), work.data[24].data()
+                },
+                work.data[25].data(), work.data[26].data(), work.data[27].data(),
+                work.data[28].data(), work.data[29].data(),
+                1
+            };
+
+            auto func = GetKernel(type);
+
+            PerfTimer pt;
+            pt.Start();
+
+            for (std::uint32_t n = 0; n < a_iterations; n++)
+                func(d, 0, a_numNodes);
+
+            double elapsed = static_cast<double>(pt.Stop());
+
+            result.nsPerNode = (elapsed * 1000000000.0) /
+                (static_cast<double>(a_numNodes) * static_cast<double>(a_iterations));
+        }
+    }
+
+    void ISimKernel::BenchmarkIntegrators(
+        std::uint32_t a_numNodes,
+        float a_timeStep,
+        std::uint32_t a_pbdIterations,
+        integratorResults_t& a_out)
+    {
+        constexpr float duration = 1.0f;
+        constexpr std::uint32_t refSubSteps = 64;
+
+        // same layout as Benchmark, targets at the origin and identity rotation
+        struct nodes_t
+        {
+            std::vector<float> data[31];
+            std::vector<std::uint8_t> flags;
+
+            void Init(std::uint32_t a_num, float a_dt, std::uint8_t a_flags)
+            {
+                for (auto& e : data)
+                    e.assign(a_num, 0.0f);
+
+                flags.assign(a_num, a_flags);
+
+                for (std::uint32_t i = 0; i < a_num; i++)
+                {
+                    float t = static_cast<float>(i) / static_cast<float>(std::max(a_num, 2U) - 1);
+
+                    data[0][i] = 4.0f + t * 16.0f;
+                    data[1][i] = 2.0f + t * 8.0f;
+
+                    data[9][i] = 1.0f;
+                    data[16][i] = data[20][i] = data[24][i] = 1.0f;
+
+                    data[25][i] = 100.0f;
+                    data[26][i] = 100.0f;
+                    data[27][i] = 0.95f;
+                    data[28][i] = 100.0f;
+
+                    data[30][i] = a_dt;
+                }
+            }
+
+            simKernelData_t Get(std::uint32_t a_iterations)
+            {
+                return simKernelData_t{
+                    data[0].data(), data[1].data(), data[2].data(),
+                    data[3].data(), data[4].data(), data[5].data(),
+                    data[6].data(), data[7].data(), data[8].data(),
+                    data[9].data(),
+                    flags.data(),
+                    data[30].data(),
+                    data[10].data(), data[11].data(), data[12].data(),
+                    data[13].data(), data[14].data(), data[15].data(),
+                    {
+                        data[16].data(), data[17].data(), data[18].data(),
+                        data[19].data(), data[20].data(), data[21].data(),
+                        data[22].data(), data[23].data(), data[24].data()
+                    },
+                    data[25].data(), data[26].data(), data[27].data(),
+                    data[28].data(), data[29].data(),
+                    a_iterations
+                };
+            }
+
+            float Offset(std::uint32_t a_index) const
+            {
+                return std::sqrt(
+                    data[0][a_index] * data[0][a_index] +
+                    data[1][a_index] * data[1][a_index] +
+                    data[2][a_index] * data[2][a_index]);
+            }
+        };
+
+        for (auto& e : a_out)
+            e = integratorResult_t{ 0.0, 0.0f, 0.0f, false };
+
+        if (!a_numNodes || !(a_timeStep > 0.0f))
+            return;
+
+        auto steps = std::max(static_cast<std::uint32_t>(duration / a_timeStep + 0.5f), 1U);
+
+        // explicit stepping at a fraction of the tick is the reference
+        std::vector<float> ref(static_cast<std::size_t>(steps) * a_numNodes * 3);
+
+        nodes_t nodes;
+
+        nodes.Init(a_numNodes, a_timeStep / static_cast<float>(refSubSteps), SimStore::kFlagNone);
+
+        auto d = nodes.Get(1);
+
+        for (std::uint32_t s = 0; s < steps; s++)
+        {
+            for (std::uint32_t n = 0; n < refSubSteps; n++)
+                m_kernel(d, 0, a_numNodes);
+
+            auto out = ref.data() + static_cast<std::size_t>(s) * a_numNodes * 3;
+
+            for (std::uint32_t i = 0; i < a_numNodes; i++)
+            {
+                out[i * 3 + 0] = nodes.data[0][i];
+                out[i * 3 + 1] = nodes.data[1][i];
+                out[i * 3 + 2] = nodes.data[2][i];
+            }
+        }
+
+        for (std::size_t t = 0; t < a_out.size(); t++)
+        {
+            auto type = static_cast<IntegratorType>(t);
+            auto& result = a_out[t];
+
+            std::uint8_t flags;
+
+            switch (type)
+            {
+            case IntegratorType::kImplicit:
+                flags = SimStore::kFlagImplicit;
+                break;
+            case IntegratorType::kPBD:
+                flags = SimStore::kFlagPBD;
+                break;
+            default:
+                flags = SimStore::kFlagNone;
+                break;
+            }
+
+            nodes.Init(a_numNodes, a_timeStep, flags);
+
+            d = nodes.Get(a_pbdIterations);
+
+            std::vector<float> initial(a_numNodes);
+            for (std::uint32_t i = 0; i < a_numNodes; i++)
+                initial[i] = nodes.Offset(i);
+
+            double errorSum = 0.0;
+            float peak = 0.0f;
+            double elapsed = 0.0;
+
+            for (std::uint32_t s = 0; s < steps; s++)
+            {
+                PerfTimer pt;
+                pt.Start();
+
+                m_kernel(d, 0, a_numNodes);
+
+                elapsed += static_cast<double>(pt.Stop());
+
+                auto r = ref.data() + static_cast<std::size_t>(s) * a_numNodes * 3;
+
+                for (std::uint32_t i = 0; i < a_numNodes; i++)
+                {
+                    float dx = nodes.data[0][i] - r[i * 3 + 0];
+                    float dy = nodes.data[1][i] - r[i * 3 + 1];
+                    float dz = nodes.data[2][i] - r[i * 3 + 2];
+
+                    errorSum += static_cast<double>(dx * dx + dy * dy + dz * dz);
+                    peak = std::max(peak, nodes.Offset(i) / initial[i]);
+                }
+            }
+
+            bool stable = std::isfinite(peak);
+
+            for (std::uint32_t i = 0; i < a_numNodes && stable; i++)
+            {
+                if ((nodes.flags[i] & SimStore::kFlagReset) ||
+                    !(nodes.Offset(i) < initial[i]))
+                {
+                    stable = false;
+                }
+            }
+
+            result.nsPerNode = (elapsed * 1000000000.0) /
+                (static_cast<double>(a_numNodes) * static_cast<double>(steps));
+            result.error = static_cast<float>(std::sqrt(errorSum /
+                (static_cast<double>(a_numNodes) * static_cast<double>(steps))));
+            result.peak = peak;
+            result.stable = stable;
+        }
+    }
+}
\ No newline at end of file
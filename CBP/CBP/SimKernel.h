@@ -0,0 +1,145 @@
+#pragma once
+
+namespace CBP
+{
+    struct simKernelData_t
+    {
+        float* px;
+        float* py;
+        float* pz;
+        float* vx;
+        float* vy;
+        float* vz;
+        float* lx;
+        float* ly;
+        float* lz;
+        float* dampingMul;
+        std::uint8_t* flags;
+
+        // per node step time, nodes with a step time of 0 are left untouched
+        const float* dt;
+        const float* tx;
+        const float* ty;
+        const float* tz;
+        const float* fx;
+        const float* fy;
+        const float* fz;
+        const float* rot[9];
+        const float* stiffness;
+        const float* stiffness2;
+        const float* damping;
+        const float* maxOffset;
+        const float* gravityBias;
+
+        // constraint iterations for position based nodes
+        std::uint32_t pbdIterations;
+    };
+
+    class ISimKernel
+    {
+    public:
+        enum class KernelType : std::uint32_t
+        {
+            kScalar = 0,
+            kSSE42,
+            kAVX2,
+            kNumTypes
+        };
+
+        // selected per config group through configComponent_t::integrator
+        enum class IntegratorType : std::uint32_t
+        {
+            kExplicit = 0,
+            kImplicit,
+            kPBD,
+            kNumTypes
+        };
+
+        typedef void (*kernelFunc_t)(
+            const simKernelData_t& a_data,
+            std::uint32_t a_begin,
+            std::uint32_t a_end);
+
+        struct benchmarkResult_t
+        {
+            bool supported;
+            double nsPerNode;
+        };
+
+        typedef std::array<benchmarkResult_t, static_cast<std::size_t>(KernelType::kNumTypes)> benchmarkResults_t;
+
+        struct integratorResult_t
+        {
+            double nsPerNode;
+            // RMS distance from a finely stepped reference over one second
+            float error;
+            // largest offset reached, relative to the initial one
+            float peak;
+            bool stable;
+        };
+
+        typedef std::array<integratorResult_t, static_cast<std::size_t>(IntegratorType::kNumTypes)> integratorResults_t;
+
+        static void Initialize();
+
+        inline static void Integrate(
+            const simKernelData_t& a_data,
+            std::uint32_t a_begin,
+            std::uint32_t a_end)
+        {
+            m_kernel(a_data, a_begin, a_end);
+        }
+
+        [[nodiscard]] inline static auto GetKernelType() {
+            return m_type;
+        }
+
+        [[nodiscard]] static const char* GetKernelName(KernelType a_type);
+        [[nodiscard]] static bool IsSupported(KernelType a_type);
+        // overrides the kernel Initialize() picked, false if the CPU doesn't support it
+        static bool SetKernelType(KernelType a_type);
+
+        [[nodiscard]] inline static IntegratorType GetIntegratorType(float a_value)
+        {
+            if (a_value >= 1.5f)
+                return IntegratorType::kPBD;
+            else if (a_value >= 0.5f)
+                return IntegratorType::kImplicit;
+            else
+                return IntegratorType::kExplicit;
+        }
+
+        [[nodiscard]] static const char* GetIntegratorName(IntegratorType a_type);
+
+        static void Benchmark(
+            std::uint32_t a_numNodes,
+            std::uint32_t a_iterations,
+            benchmarkResults_t& a_out);
+
+        // Stiff spring released from rest, stepped at a_timeStep with each integrator
+        // on the active kernel.
+        static void BenchmarkIntegrators(
+            std::uint32_t a_numNodes,
+            float a_timeStep,
+            std::uint32_t a_pbdIterations,
+            integratorResults_t& a_out);
+
+    private:
+        static void IntegrateScalar(const simKernelData_t& a_data, std::uint32_t a_begin, std::uint32_t a_end);
+        static void IntegrateSSE42(const simKernelData_t& a_data, std::uint32_t a_begin, std::uint32_t a_end);
+        static void IntegrateAVX2(const simKernelData_t& a_data, std::uint32_t a_begin, std::uint32_t a_end);
+
+        // position based nodes, the vector kernels hand these lanes to it as well
+        static void IntegratePBD(const simKernelData_t& a_data, std::uint32_t a_index);
+
+        static kernelFunc_t GetKernel(KernelType a_type);
+
+        static kernelFunc_t m_kernel;
+        static KernelType m_type;
+
+        static struct cpuFeatures_t {
+            bool sse42;
+            bool avx2;
+        } m_cpuFeatures;
+    };
+}
\ No newline at end of file
@@ -53,12 +53,16 @@ namespace CBP
         uint64_t a_Id,
         const nodeDescList_t& a_desc)
         :
-        m_handle(a_handle),
 #ifndef _CBP_ENABLE_DEBUG
         m_things(a_desc.size()),
 #endif
         m_Id(a_Id),
-        m_sex(a_sex)
+        m_handle(a_handle),
+        m_sex(a_sex),
+        m_lodTier(LODTier::Near),
+        m_lodInterval(1),
+        m_deferred(false),
+        m_deferredFrames(0)
     {
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -86,24 +90,45 @@ namespace CBP
 
         BSFixedString n("NPC Head [Head]");
         m_objHead = a_actor->loadedState->node->GetObjectByName(&n.data);
-    }
 
-    void SimObject::Reset()
-    {
-        for (auto& p : m_things)
-            p.second.Reset();
+        UpdateChains();
     }
 
-    void SimObject::UpdateMovement(float a_timeStep)
+    void SimObject::UpdateChains()
     {
-        for (auto& p : m_things)
-            p.second.UpdateMovement(a_timeStep);
+        auto& store = DCBP::GetSimStore();
+
+        store.RemoveChains(m_Id);
+
+        for (const auto& e : IConfig::GetNodeChains())
+        {
+            std::vector<SimComponent*> chain;
+
+            // missing, static or unparented nodes split the chain
+            for (const auto& n : e)
+            {
+                auto it = m_things.find(n);
+
+                bool valid = it != m_things.end() && it->second.HasMovement();
+
+                if (!valid || (!chain.empty() && !it->second.IsChildOf(*chain.back())))
+                {
+                    store.AddChain(m_Id, chain);
+                    chain.clear();
+                }
+
+                if (valid)
+                    chain.emplace_back(std::addressof(it->second));
+            }
+
+            store.AddChain(m_Id, chain);
+        }
     }
 
-    void SimObject::UpdateVelocity()
+    void SimObject::Reset()
     {
         for (auto& p : m_things)
-            p.second.UpdateVelocity();
+            p.second.Reset();
     }
 
     void SimObject::UpdateConfig(Actor* a_actor, bool a_collisions, const configComponents_t& a_config)
@@ -126,7 +151,61 @@ namespace CBP
                 a_collisions && collisions,
                 movement
             );
+
+            // config updates recreate colliders
+            if (m_lodTier == LODTier::Far)
+                p.second.SetFrozen(true);
         }
+
+        UpdateChains();
+    }
+
+    void SimObject::SetLOD(LODTier a_tier, uint32_t a_interval)
+    {
+        if (a_tier == m_lodTier && a_interval == m_lodInterval)
+            return;
+
+        bool frozen = a_tier == LODTier::Far;
+
+        if (frozen != (m_lodTier == LODTier::Far))
+            for (auto& p : m_things)
+                p.second.SetFrozen(frozen);
+
+        // stagger actors so they don't all land on the same step
+        auto phase = static_cast<uint32_t>(m_Id % std::max(a_interval, 1U));
+
+        for (auto& p : m_things)
+            p.second.SetLOD(a_interval, phase);
+
+        m_lodTier = a_tier;
+        m_lodInterval = a_interval;
+    }
+
+    void SimObject::SetDeferred(bool a_deferred)
+    {
+        if (a_deferred)
+            m_deferredFrames++;
+        else
+            m_deferredFrames = 0;
+
+        if (a_deferred == m_deferred)
+            return;
+
+        for (auto& p : m_things)
+            p.second.SetDeferred(a_deferred);
+
+        m_deferred = a_deferred;
+    }
+
+    uint32_t SimObject::GetNumAwake() const
+    {
+        uint32_t n = 0;
+
+        for (auto& p : m_things)
+            if (p.second.IsAwake())
+                n++;
+
+        return n;
     }
 
     void SimObject::ApplyForce(uint32_t a_steps, const std::string& a_component, const NiPoint3& a_force)
@@ -151,7 +230,10 @@ namespace CBP
                 IConfig::GetNodeCollisionGroupId(p.first));
     }
 
-    void SimObject::Release() {
+    void SimObject::Release()
+    {
+        DCBP::GetSimStore().RemoveChains(m_Id);
+
         for (auto& p : m_things)
             p.second.Release();
     }
@@ -14,6 +14,13 @@ namespace CBP
 
     typedef std::vector<nodeDesc_t> nodeDescList_t;
 
+    enum class LODTier : uint32_t
+    {
+        Near,
+        Mid,
+        Far
+    };
+
     class SimObject
     {
         typedef
@@ -38,13 +45,16 @@ namespace CBP
         SimObject(const SimObject& a_rhs) = delete;
         SimObject(SimObject&& a_rhs) = delete;
 
-        void UpdateMovement(float a_timeStep);
-        void UpdateVelocity();
         void UpdateConfig(Actor* a_actor, bool a_collisions, const configComponents_t& a_config);
         void Reset();
 
         void ApplyForce(uint32_t a_steps, const std::string& a_component, const NiPoint3& a_force);
 
+        void SetLOD(LODTier a_tier, uint32_t a_interval);
+        void SetDeferred(bool a_deferred);
+
+        [[nodiscard]] uint32_t GetNumAwake() const;
+
 #ifdef _CBP_ENABLE_DEBUG
         void UpdateDebugInfo();
 #endif
@@ -79,6 +89,14 @@ namespace CBP
             return m_things.end();
         }
 
+        [[nodiscard]] inline iterator begin() noexcept {
+            return m_things.begin();
+        }
+
+        [[nodiscard]] inline iterator end() noexcept {
+            return m_things.end();
+        }
+
 #ifdef _CBP_ENABLE_DEBUG
         [[nodiscard]] inline const std::string& GetActorName() const noexcept {
             return m_actorName;
@@ -89,6 +107,30 @@ namespace CBP
             return m_actor;
         }
 
+        [[nodiscard]] inline auto GetLODTier() const noexcept {
+            return m_lodTier;
+        }
+
+        [[nodiscard]] inline auto GetId() const noexcept {
+            return m_Id;
+        }
+
+        [[nodiscard]] inline auto GetLODInterval() const noexcept {
+            return m_lodInterval;
+        }
+
+        [[nodiscard]] inline char GetSex() const noexcept {
+            return m_sex;
+        }
+
+        [[nodiscard]] inline bool IsDeferred() const noexcept {
+            return m_deferred;
+        }
+
+        [[nodiscard]] inline auto GetDeferredFrames() const noexcept {
+            return m_deferredFrames;
+        }
+
         [[nodiscard]] inline bool GetHeadTransform(NiTransform& a_out) const {
             if (m_objHead != nullptr) {
                 a_out = m_objHead->m_worldTransform;
@@ -98,6 +140,7 @@ namespace CBP
         }
 
     private:
+        void UpdateChains();
 
         thingMap_t m_things;
         std::unordered_set<std::string> m_configGroups;
@@ -110,6 +153,12 @@ namespace CBP
 
         char m_sex;
 
+        LODTier m_lodTier;
+        uint32_t m_lodInterval;
+
+        bool m_deferred;
+        uint32_t m_deferredFrames;
+
 #ifdef _CBP_ENABLE_DEBUG
         std::string m_actorName;
 #endif
@@ -0,0 +1,877 @@
+#include "pch.h"
+
+namespace CBP
+{
+    void SimStore::Add(SimComponent* a_component, bool a_movement)
+    {
+        auto slot = Size();
+
+        ForEachVector([](auto& a_v) { a_v.emplace_back(); });
+
+        m_components[slot] = a_component;
+        m_dampingMul[slot] = 1.0f;
+        m_lodInterval[slot] = 1;
+
+        a_component->m_slot = slot;
+
+        m_parentsDirty = true;
+        m_writeGroupsDirty = true;
+
+        if (a_movement)
+            SetMovement(slot, true);
+    }
+
+    void SimStore::Remove(size_type a_slot)
+    {
+        if (a_slot < m_numAwake)
+        {
+            Swap(a_slot, m_numAwake - 1);
+            a_slot = --m_numAwake;
+        }
+
+        if (a_slot < m_numMoving)
+        {
+            Swap(a_slot, m_numMoving - 1);
+            a_slot = --m_numMoving;
+        }
+
+        Swap(a_slot, Size() - 1);
+        PopBack();
+
+        m_parentsDirty = true;
+        m_writeGroupsDirty = true;
+    }
+
+    void SimStore::SetMovement(size_type a_slot, bool a_movement)
+    {
+        bool moving = a_slot < m_numMoving;
+        if (moving == a_movement)
+            return;
+
+        if (a_movement)
+        {
+            Swap(a_slot, m_numMoving);
+            m_numMoving++;
+
+            Wake(m_numMoving - 1);
+        }
+        else
+        {
+            if (a_slot < m_numAwake)
+            {
+                Swap(a_slot, m_numAwake - 1);
+                a_slot = --m_numAwake;
+            }
+
+            Swap(a_slot, m_numMoving - 1);
+            m_numMoving--;
+        }
+    }
+
+    void SimStore::Wake(size_type a_slot)
+    {
+        m_sleepSteps[a_slot] = 0;
+
+        if (a_slot < m_numAwake || a_slot >= m_numMoving)
+            return;
+
+        if (m_flags[a_slot] & kFlagFrozen)
+            return;
+
+        m_lodTime[a_slot] = 0.0f;
+        m_idleTicks[a_slot] = 0;
+
+        Swap(a_slot, m_numAwake);
+        m_numAwake++;
+    }
+
+    void SimStore::SetLOD(size_type a_slot, std::uint32_t a_interval, std::uint32_t a_phase)
+    {
+        a_interval = std::clamp(a_interval, 1U, 255U);
+
+        m_lodInterval[a_slot] = static_cast<std::uint8_t>(a_interval);
+        m_lodPhase[a_slot] = static_cast<std::uint8_t>(a_phase % a_interval);
+        m_lodTime[a_slot] = 0.0f;
+    }
+
+    void SimStore::SetFrozen(size_type a_slot, bool a_frozen)
+    {
+        if (!a_frozen)
+        {
+            m_flags[a_slot] &= ~kFlagFrozen;
+
+            // the node moved with the skeleton while frozen, don't turn that into velocity
+            SetPosition(a_slot, m_components[a_slot]->m_obj->m_worldTransform.pos);
+
+            Wake(a_slot);
+            return;
+        }
+
+        m_flags[a_slot] |= kFlagFrozen;
+
+        m_vel.x[a_slot] = 0.0f;
+        m_vel.y[a_slot] = 0.0f;
+        m_vel.z[a_slot] = 0.0f;
+
+        if (a_slot < m_numAwake)
+        {
+            Swap(a_slot, m_numAwake - 1);
+            m_numAwake--;
+        }
+    }
+
+    void SimStore::Swap(size_type a_lhs, size_type a_rhs)
+    {
+        if (a_lhs == a_rhs)
+            return;
+
+        ForEachVector([=](auto& a_v) { std::swap(a_v[a_lhs], a_v[a_rhs]); });
+
+        m_components[a_lhs]->m_slot = a_lhs;
+        m_components[a_rhs]->m_slot = a_rhs;
+    }
+
+    void SimStore::PopBack()
+    {
+        ForEachVector([](auto& a_v) { a_v.pop_back(); });
+    }
+
+    void SimStore::UpdateVelocity(WorkerPool& a_workers)
+    {
+        auto offset = m_numMoving;
+
+        a_workers.ParallelFor(Size() - offset, GRAIN_SIZE,
+            [this, offset](size_type a_begin, size_type a_end)
+            {
+                for (auto i = a_begin + offset; i < a_end + offset; i++)
+                {
+                    if (m_flags[i] & kFlagFrozen)
+                        continue;
+
+                    auto& pos = m_components[i]->m_obj->m_worldTransform.pos;
+
+                    m_vel.x[i] = pos.x - m_pos.x[i];
+                    m_vel.y[i] = pos.y - m_pos.y[i];
+                    m_vel.z[i] = pos.z - m_pos.z[i];
+
+                    m_pos.x[i] = pos.x;
+                    m_pos.y[i] = pos.y;
+                    m_pos.z[i] = pos.z;
+                }
+            });
+    }
+
+    void SimStore::UpdateMovement(float a_timeStep, WorkerPool& a_workers)
+    {
+        auto& phys = IConfig::GetGlobalConfig().phys;
+
+        GatherParents(a_workers);
+
+        if (phys.sleeping)
+        {
+            auto offset = m_numAwake;
+
+            a_workers.ParallelFor(m_numMoving - offset, GRAIN_SIZE,
+                [this, offset, &phys](size_type a_begin, size_type a_end)
+                {
+                    CheckWake(phys.wakeDistance, a_begin + offset, a_end + offset);
+                });
+
+            WakeFlagged();
+        }
+        else
+            WakeAll();
+
+        float maxTime = std::min(MAX_CATCHUP_TIME, a_timeStep * std::max(phys.maxSubSteps, 1.0f));
+
+        a_workers.ParallelFor(m_numAwake, GRAIN_SIZE,
+            [this, a_timeStep, maxTime, &phys](size_type a_begin, size_type a_end)
+            {
+                std::uint64_t start = m_sampleCosts ? __rdtsc() : 0;
+
+                Gather(a_timeStep, maxTime, a_begin, a_end);
+                Integrate(a_timeStep, a_begin, a_end);
+
+                if (phys.sleeping)
+                    UpdateSleepSteps(phys.sleepVelocity, phys.sleepOffset, a_begin, a_end);
+
+                if (m_sampleCosts)
+                    AddChunkCost(__rdtsc() - start, a_begin, a_end);
+            });
+
+        a_workers.ParallelFor(static_cast<size_type>(m_chains.size()), CHAIN_GRAIN_SIZE,
+            [this](size_type a_begin, size_type a_end)
+            {
+                SolveChains(a_begin, a_end);
+            });
+
+        // reactphysics3d isn't thread safe
+        UpdateColliders();
+
+        if (phys.sleeping)
+            Sleep(static_cast<std::uint32_t>(std::max(phys.sleepSteps, 1)));
+
+        m_step++;
+    }
+
+    void SimStore::Interpolate(float a_alpha, WorkerPool& a_workers)
+    {
+        GatherParents(a_workers);
+
+        if (m_writeGroupsDirty)
+            UpdateWriteGroups();
+
+        size_type writes = 0;
+
+        for (const auto& e : m_writeGroups)
+            writes += WriteGroup(a_alpha, e);
+
+        m_nodeWrites = writes;
+    }
+
+    void SimStore::AddChain(std::uint64_t a_owner, const std::vector<SimComponent*>& a_nodes)
+    {
+        if (a_nodes.size() < 2)
+            return;
+
+        auto begin = static_cast<size_type>(m_chainLinks.size());
+
+        for (auto e : a_nodes)
+        {
+            m_chainLinks.emplace_back(e);
+            m_flags[e->m_slot] |= kFlagChain;
+        }
+
+        m_chains.emplace_back(chain_t{ a_owner, begin, static_cast<size_type>(m_chainLinks.size()) });
+
+        m_writeGroupsDirty = true;
+    }
+
+    void SimStore::RemoveChains(std::uint64_t a_owner)
+    {
+        std::vector<chain_t> chains;
+        std::vector<SimComponent*> links;
+
+        for (auto& e : m_chains)
+        {
+            if (e.owner == a_owner)
+            {
+                for (auto i = e.begin; i < e.end; i++)
+                {
+                    auto slot = m_chainLinks[i]->m_slot;
+                    if (slot != npos)
+                        m_flags[slot] &= ~kFlagChain;
+                }
+
+                continue;
+            }
+
+            auto begin = static_cast<size_type>(links.size());
+
+            links.insert(links.end(), m_chainLinks.begin() + e.begin, m_chainLinks.begin() + e.end);
+            chains.emplace_back(chain_t{ e.owner, begin, static_cast<size_type>(links.size()) });
+        }
+
+        m_chains.swap(chains);
+        m_chainLinks.swap(links);
+
+        m_writeGroupsDirty = true;
+    }
+
+    void SimStore::SolveChains(size_type a_begin, size_type a_end)
+    {
+        for (auto c = a_begin; c < a_end; c++)
+        {
+            auto& chain = m_chains[c];
+
+            // root to tip, each link only moves the child so motion carries down the chain
+            for (auto l = chain.begin + 1; l < chain.end; l++)
+            {
+                auto i = m_chainLinks[l]->m_slot;
+                auto p = m_chainLinks[l - 1]->m_slot;
+
+                if (i >= m_numAwake || m_stepTime[i] == 0.0f || (m_flags[i] & kFlagReset))
+                    continue;
+
+                float rx = m_target.x[i] - m_target.x[p];
+                float ry = m_target.y[i] - m_target.y[p];
+                float rz = m_target.z[i] - m_target.z[p];
+
+                float dx = m_pos.x[i] - m_pos.x[p];
+                float dy = m_pos.y[i] - m_pos.y[p];
+                float dz = m_pos.z[i] - m_pos.z[p];
+
+                float len = std::sqrt(dx * dx + dy * dy + dz * dz);
+                if (len < _EPSILON)
+                    continue;
+
+                float s = std::sqrt(rx * rx + ry * ry + rz * rz) / len;
+
+                float cx = (m_pos.x[p] + dx * s) - m_pos.x[i];
+                float cy = (m_pos.y[p] + dy * s) - m_pos.y[i];
+                float cz = (m_pos.z[p] + dz * s) - m_pos.z[i];
+
+                float invDt = 1.0f / m_stepTime[i];
+
+                m_vel.x[i] += cx * invDt;
+                m_vel.y[i] += cy * invDt;
+                m_vel.z[i] += cz * invDt;
+
+                float maxOffset = m_maxOffset[i];
+
+                float ox = std::clamp((m_pos.x[i] + cx) - m_target.x[i], -maxOffset, maxOffset);
+                float oy = std::clamp((m_pos.y[i] + cy) - m_target.y[i], -maxOffset, maxOffset);
+                float oz = std::clamp((m_pos.z[i] + cz) - m_target.z[i], -maxOffset, maxOffset);
+
+                m_pos.x[i] = m_target.x[i] + ox;
+                m_pos.y[i] = m_target.y[i] + oy;
+                m_pos.z[i] = m_target.z[i] + oz;
+
+                // parent space
+                m_ldiff.x[i] = m_rot[0][i] * ox + m_rot[3][i] * oy + m_rot[6][i] * oz;
+                m_ldiff.y[i] = m_rot[1][i] * ox + m_rot[4][i] * oy + m_rot[7][i] * oz;
+                m_ldiff.z[i] = m_rot[2][i] * ox + m_rot[5][i] * oy + m_rot[8][i] * oz;
+            }
+        }
+    }
+
+    void SimStore::UpdateParents()
+    {
+        std::unordered_map<NiAVObject*, size_type> index;
+
+        m_parents.clear();
+
+        for (size_type i = 0; i < Size(); i++)
+        {
+            NiAVObject* parent = m_components[i]->m_objParent;
+
+            auto r = index.emplace(parent, static_cast<size_type>(m_parents.size()));
+            if (r.second)
+                m_parents.emplace_back(parent);
+
+            m_parentIndex[i] = r.first->second;
+        }
+
+        m_parentCache.resize(m_parents.size());
+
+        m_parentsDirty = false;
+    }
+
+    void SimStore::GatherParents(WorkerPool& a_workers)
+    {
+        if (m_parentsDirty)
+            UpdateParents();
+
+        a_workers.ParallelFor(static_cast<size_type>(m_parents.size()), GRAIN_SIZE,
+            [this](size_type a_begin, size_type a_end)
+            {
+                for (auto i = a_begin; i < a_end; i++)
+                {
+                    auto& e = m_parentCache[i];
+
+                    e.world = m_parents[i]->m_worldTransform;
+                    e.invRot = e.world.rot.Transpose();
+                }
+            });
+    }
+
+    void SimStore::CheckWake(float a_distance, size_type a_begin, size_type a_end)
+    {
+        float distSq = a_distance * a_distance;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            if (m_flags[i] & kFlagFrozen)
+                continue;
+
+            auto& tf = m_parentCache[m_parentIndex[i]].world;
+
+            auto target = tf * NiPoint3(0.0f, m_cogOffset[i], 0.0f);
+
+            float dx = target.x - m_target.x[i];
+            float dy = target.y - m_target.y[i];
+            float dz = target.z - m_target.z[i];
+
+            bool wake = dx * dx + dy * dy + dz * dz > distSq;
+
+            for (int r = 0; r < 3 && !wake; r++)
+                for (int c = 0; c < 3; c++)
+                    if (std::fabs(tf.rot.data[r][c] - m_rot[r * 3 + c][i]) > WAKE_ROTATION) {
+                        wake = true;
+                        break;
+                    }
+
+            if (wake)
+                m_flags[i] |= kFlagWake;
+        }
+    }
+
+    void SimStore::WakeFlagged()
+    {
+        for (auto i = m_numAwake; i < m_numMoving; i++)
+        {
+            if (m_flags[i] & kFlagWake)
+            {
+                m_flags[i] &= ~kFlagWake;
+                Wake(i);
+            }
+        }
+    }
+
+    void SimStore::WakeAll()
+    {
+        for (auto i = m_numAwake; i < m_numMoving; i++)
+        {
+            m_flags[i] &= ~kFlagWake;
+            m_sleepSteps[i] = 0;
+        }
+
+        m_numAwake = m_numMoving;
+    }
+
+    void SimStore::UpdateSleepSteps(float a_velocity, float a_offset, size_type a_begin, size_type a_end)
+    {
+        float velSq = a_velocity * a_velocity;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            if (m_stepTime[i] == 0.0f)
+                continue;
+
+            if (m_flags[i] & kFlagReset)
+            {
+                m_sleepSteps[i] = 0;
+                continue;
+            }
+
+            float lx = m_ldiff.x[i];
+            float ly = m_ldiff.y[i];
+            float lz = m_ldiff.z[i];
+
+            float offset = std::sqrt(lx * lx + ly * ly + lz * lz);
+            float offsetDelta = std::fabs(offset - m_lastOffset[i]);
+
+            m_lastOffset[i] = offset;
+
+            float vx = m_vel.x[i];
+            float vy = m_vel.y[i];
+            float vz = m_vel.z[i];
+
+            if (vx * vx + vy * vy + vz * vz < velSq && offsetDelta < a_offset)
+            {
+                if (m_sleepSteps[i] < std::numeric_limits<std::uint16_t>::max())
+                    m_sleepSteps[i]++;
+            }
+            else
+                m_sleepSteps[i] = 0;
+        }
+    }
+
+    void SimStore::Sleep(std::uint32_t a_steps)
+    {
+        // walk backwards so slots swapped in from the boundary were already visited
+        for (auto i = m_numAwake; i > 0; i--)
+        {
+            auto slot = i - 1;
+
+            if (m_sleepSteps[slot] < a_steps)
+                continue;
+
+            if (m_components[slot]->m_forceCount)
+                continue;
+
+            m_vel.x[slot] = 0.0f;
+            m_vel.y[slot] = 0.0f;
+            m_vel.z[slot] = 0.0f;
+
+            m_prevLdiff.x[slot] = m_ldiff.x[slot];
+            m_prevLdiff.y[slot] = m_ldiff.y[slot];
+            m_prevLdiff.z[slot] = m_ldiff.z[slot];
+
+            Swap(slot, m_numAwake - 1);
+            m_numAwake--;
+        }
+    }
+
+    void SimStore::Gather(float a_timeStep, float a_maxTime, size_type a_begin, size_type a_end)
+    {
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            m_lodTime[i] = std::min(m_lodTime[i] + a_timeStep, a_maxTime);
+
+            auto interval = m_lodInterval[i];
+            if ((m_flags[i] & kFlagDeferred) ||
+                (interval > 1 && (m_step + m_lodPhase[i]) % interval != 0))
+            {
+                m_stepTime[i] = 0.0f;
+                m_idleTicks[i]++;
+                continue;
+            }
+
+            m_stepTime[i] = m_lodTime[i];
+            m_lodTime[i] = 0.0f;
+
+            m_blendTicks[i] = m_idleTicks[i] + 1;
+            m_idleTicks[i] = 0;
+
+            m_prevLdiff.x[i] = m_ldiff.x[i];
+            m_prevLdiff.y[i] = m_ldiff.y[i];
+            m_prevLdiff.z[i] = m_ldiff.z[i];
+
+            auto sc = m_components[i];
+            auto& tf = m_parentCache[m_parentIndex[i]].world;
+
+            //Offset to move Center of Mass make rotational motion more significant
+            auto target = tf * NiPoint3(0.0f, m_cogOffset[i], 0.0f);
+
+            m_target.x[i] = target.x;
+            m_target.y[i] = target.y;
+            m_target.z[i] = target.z;
+
+            for (int r = 0; r < 3; r++)
+                for (int c = 0; c < 3; c++)
+                    m_rot[r * 3 + c][i] = tf.rot.data[r][c];
+
+            if (m_sampleCosts)
+                sc->m_cost.maxForces = std::max(sc->m_cost.maxForces, sc->m_forceCount);
+
+            NiPoint3 force;
+            sc->PopForce(tf, force);
+
+            m_force.x[i] = force.x;
+            m_force.y[i] = force.y;
+            m_force.z[i] = force.z;
+        }
+    }
+
+    void SimStore::AddChunkCost(std::uint64_t a_cycles, size_type a_begin, size_type a_end)
+    {
+        size_type n = 0;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            if (m_stepTime[i] != 0.0f)
+                n++;
+        }
+
+        if (!n)
+            return;
+
+        auto cycles = a_cycles / n;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            if (m_stepTime[i] == 0.0f)
+                continue;
+
+            auto& cost = m_components[i]->m_cost;
+
+            cost.cycles += cycles;
+            cost.steps++;
+        }
+    }
+
+    void SimStore::Integrate(float a_timeStep, size_type a_begin, size_type a_end)
+    {
+        simKernelData_t data{
+            m_pos.x.data(), m_pos.y.data(), m_pos.z.data(),
+            m_vel.x.data(), m_vel.y.data(), m_vel.z.data(),
+            m_ldiff.x.data(), m_ldiff.y.data(), m_ldiff.z.data(),
+            m_dampingMul.data(),
+            m_flags.data(),
+            m_subStepTime.data(),
+            m_target.x.data(), m_target.y.data(), m_target.z.data(),
+            m_force.x.data(), m_force.y.data(), m_force.z.data(),
+            {
+                m_rot[0].data(), m_rot[1].data(), m_rot[2].data(),
+                m_rot[3].data(), m_rot[4].data(), m_rot[5].data(),
+                m_rot[6].data(), m_rot[7].data(), m_rot[8].data()
+            },
+            m_stiffness.data(),
+            m_stiffness2.data(),
+            m_damping.data(),
+            m_maxOffset.data(),
+            m_gravityBias.data(),
+            static_cast<std::uint32_t>(std::max(IConfig::GetGlobalConfig().phys.pbdIterations, 1))
+        };
+
+        // Time caught up by LOD or deferred nodes is split into equal steps no longer than
+        // a_timeStep, a single explicit step over all of it blows up stiff springs.
+        std::uint32_t passes = 1;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            auto n = GetSubSteps(m_stepTime[i], a_timeStep);
+
+            m_subStepTime[i] = m_stepTime[i] / static_cast<float>(n);
+            passes = std::max(passes, n);
+        }
+
+        ISimKernel::Integrate(data, a_begin, a_end);
+
+        for (std::uint32_t p = 1; p < passes; p++)
+        {
+            for (auto i = a_begin; i < a_end; i++)
+            {
+                if (GetSubSteps(m_stepTime[i], a_timeStep) <= p) {
+                    m_subStepTime[i] = 0.0f;
+                    continue;
+                }
+
+                // queued forces are applied once per step
+                m_force.x[i] = 0.0f;
+                m_force.y[i] = 0.0f;
+                m_force.z[i] = 0.0f;
+            }
+
+            ISimKernel::Integrate(data, a_begin, a_end);
+        }
+    }
+
+    void SimStore::UpdateWriteGroups()
+    {
+        std::unordered_map<std::uint64_t, std::vector<SimComponent*>> actors;
+        std::vector<std::uint64_t> order;
+
+        for (auto e : m_components)
+        {
+            auto r = actors.try_emplace(e->m_parentId);
+            if (r.second)
+                order.emplace_back(e->m_parentId);
+
+            r.first->second.emplace_back(e);
+        }
+
+        m_writeGroups.clear();
+        m_writeNodes.clear();
+
+        std::unordered_map<SimComponent*, size_type> nodeIndex;
+        std::unordered_map<NiAVObject*, size_type> objIndex;
+        std::vector<std::pair<std::uint32_t, SimComponent*>> sorted;
+
+        for (auto owner : order)
+        {
+            auto& nodes = actors[owner];
+
+            sorted.clear();
+
+            for (auto e : nodes)
+            {
+                std::uint32_t depth = 0;
+                for (auto p = e->m_obj->m_parent; p; p = p->m_parent)
+                    depth++;
+
+                sorted.emplace_back(depth, e);
+            }
+
+            std::stable_sort(sorted.begin(), sorted.end(),
+                [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.first < a_rhs.first; });
+
+            auto begin = static_cast<size_type>(m_writeNodes.size());
+
+            objIndex.clear();
+
+            for (const auto& e : sorted)
+            {
+                auto index = static_cast<size_type>(m_writeNodes.size());
+
+                auto ancestor = npos;
+
+                for (auto p = e.second->m_obj->m_parent; p; p = p->m_parent)
+                {
+                    auto it = objIndex.find(p);
+                    if (it != objIndex.end()) {
+                        ancestor = it->second;
+                        break;
+                    }
+                }
+
+                m_writeNodes.emplace_back(writeNode_t{ e.second, ancestor });
+
+                objIndex.emplace(e.second->m_obj, index);
+                nodeIndex.emplace(e.second, index);
+            }
+
+            auto chainBegin = static_cast<size_type>(m_chains.size());
+            auto chainEnd = chainBegin;
+
+            for (size_type i = 0; i < static_cast<size_type>(m_chains.size()); i++)
+            {
+                if (m_chains[i].owner != owner)
+                    continue;
+
+                if (chainBegin == chainEnd)
+                    chainBegin = i;
+
+                chainEnd = i + 1;
+            }
+
+            m_writeGroups.emplace_back(writeGroup_t{
+                begin, static_cast<size_type>(m_writeNodes.size()), chainBegin, chainEnd });
+        }
+
+        m_chainWriteIndex.resize(m_chainLinks.size());
+
+        for (std::size_t i = 0; i < m_chainLinks.size(); i++)
+            m_chainWriteIndex[i] = nodeIndex[m_chainLinks[i]];
+
+        m_writeState.resize(m_writeNodes.size());
+
+        m_writeGroupsDirty = false;
+    }
+
+    auto SimStore::WriteGroup(float a_alpha, const writeGroup_t& a_group)
+        -> size_type
+    {
+        for (auto n = a_group.begin; n < a_group.end; n++)
+        {
+            auto sc = m_writeNodes[n].component;
+            auto i = sc->m_slot;
+
+            if (i >= m_numAwake || (m_flags[i] & kFlagChain)) {
+                m_writeState[n] = kWriteNone;
+                continue;
+            }
+
+            float px = m_prevLdiff.x[i];
+            float py = m_prevLdiff.y[i];
+            float pz = m_prevLdiff.z[i];
+
+            auto t = GetBlend(i, a_alpha);
+
+            sc->GetLocalTransform(m_parentCache[m_parentIndex[i]].invRot,
+                px + (m_ldiff.x[i] - px) * t,
+                py + (m_ldiff.y[i] - py) * t,
+                pz + (m_ldiff.z[i] - pz) * t,
+                sc->m_obj->m_localTransform);
+
+            m_writeState[n] = kWriteLocal;
+        }
+
+        for (auto c = a_group.chainBegin; c < a_group.chainEnd; c++)
+        {
+            auto& chain = m_chains[c];
+
+            if (!SetChainTransforms(a_alpha, chain))
+                continue;
+
+            // the root's update reaches the rest of the chain
+            m_writeState[m_chainWriteIndex[chain.begin]] = kWriteLocal;
+        }
+
+        // root first, a node is only updated if no ancestor's update reaches it
+        size_type writes = 0;
+
+        for (auto n = a_group.begin; n < a_group.end; n++)
+        {
+            auto& e = m_writeNodes[n];
+
+            if (e.ancestor != npos && m_writeState[e.ancestor] != kWriteNone)
+            {
+                m_writeState[n] |= kWriteCovered;
+                continue;
+            }
+
+            if (m_writeState[n] == kWriteLocal)
+            {
+                auto sc = e.component;
+                sc->m_obj->UpdateWorldData(std::addressof(sc->m_updateCtx));
+
+                writes++;
+            }
+        }
+
+        return writes;
+    }
+
+    bool SimStore::SetChainTransforms(float a_alpha, const chain_t& a_chain)
+    {
+        bool awake = false;
+
+        for (auto l = a_chain.begin; l < a_chain.end; l++)
+            if (m_chainLinks[l]->m_slot < m_numAwake) {
+                awake = true;
+                break;
+            }
+
+        if (!awake)
+            return false;
+
+        // world transform the previous link is written with
+        NiTransform prev;
+
+        for (auto l = a_chain.begin; l < a_chain.end; l++)
+        {
+            auto sc = m_chainLinks[l];
+            auto i = sc->m_slot;
+
+            auto& parent = m_parentCache[m_parentIndex[i]];
+
+            float px = m_prevLdiff.x[i];
+            float py = m_prevLdiff.y[i];
+            float pz = m_prevLdiff.z[i];
+
+            auto t = GetBlend(i, a_alpha);
+
+            float x = px + (m_ldiff.x[i] - px) * t;
+            float y = py + (m_ldiff.y[i] - py) * t;
+            float z = pz + (m_ldiff.z[i] - pz) * t;
+
+            auto& local = sc->m_obj->m_localTransform;
+
+            sc->GetLocalTransform(parent.invRot, x, y, z, local);
+
+            // where the link goes with its parent in the pose the chain was solved in
+            auto world = parent.world * local;
+
+            // the node inherits the previous link's displacement and rotation, express it
+            // relative to that link as written instead
+            if (l != a_chain.begin)
+            {
+                auto invRot = prev.rot.Transpose();
+                float invScale = 1.0f / prev.scale;
+
+                local.rot = invRot * world.rot;
+                local.pos = (invRot * (world.pos - prev.pos)) * invScale;
+                local.scale = world.scale * invScale;
+            }
+
+            prev = world;
+        }
+
+        return true;
+    }
+
+    void SimStore::UpdateColliders()
+    {
+        for (size_type i = 0; i < m_numAwake; i++)
+        {
+            if (m_stepTime[i] == 0.0f)
+                continue;
+
+            m_simulated++;
+
+            auto sc = m_components[i];
+
+            if (m_flags[i] & kFlagReset)
+            {
+                m_flags[i] &= ~kFlagReset;
+                sc->Reset();
+            }
+            else
+            {
+                auto& parent = m_parentCache[m_parentIndex[i]];
+                sc->UpdateCollider(parent.world, parent.invRot,
+                    m_ldiff.x[i], m_ldiff.y[i], m_ldiff.z[i]);
+            }
+        }
+
+        auto size = Size();
+
+        for (size_type i = m_numMoving; i < size; i++)
+        {
+            if (!(m_flags[i] & kFlagFrozen))
+                m_components[i]->UpdateCollider();
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,432 @@
+#pragma once
+
+namespace CBP
+{
+    class SimComponent;
+
+    class SimStore
+    {
+    public:
+        typedef std::uint32_t size_type;
+
+        static constexpr size_type npos = static_cast<size_type>(-1);
+
+        enum SlotFlags : std::uint8_t
+        {
+            kFlagNone = 0,
+            kFlagInContact = 1 << 0,
+            kFlagReset = 1 << 1,
+            kFlagWake = 1 << 2,
+            kFlagFrozen = 1 << 3,
+            kFlagDeferred = 1 << 4,
+            kFlagImplicit = 1 << 5,
+            kFlagPBD = 1 << 6,
+            kFlagChain = 1 << 7
+        };
+
+        static constexpr float VELOCITY_MAX = 1000.0f;
+        static constexpr float RESET_DISTANCE = 150.0f;
+        static constexpr float WAKE_ROTATION = 0.001f;
+        // upper bound for time accumulated by skipped nodes, also limited to phys.maxSubSteps
+        // steps. Caught up time is integrated in steps no longer than one time step.
+        static constexpr float MAX_CATCHUP_TIME = 0.1f;
+
+        // nodes per work chunk, multiple of the widest kernel
+        static constexpr size_type GRAIN_SIZE = 64;
+        static constexpr size_type CHAIN_GRAIN_SIZE = 4;
+
+        SimStore() = default;
+
+        SimStore(const SimStore&) = delete;
+        SimStore(SimStore&&) = delete;
+        SimStore& operator=(const SimStore&) = delete;
+        void operator=(SimStore&&) = delete;
+
+        // Awake moving nodes occupy [0, m_numAwake), sleeping ones [m_numAwake, m_numMoving),
+        // the rest [m_numMoving, size)
+        void Add(SimComponent* a_component, bool a_movement);
+        void Remove(size_type a_slot);
+        void SetMovement(size_type a_slot, bool a_movement);
+        void Wake(size_type a_slot);
+
+        // Chains keep the distance between consecutive nodes at that of the animated pose and
+        // are written to the scene graph with a single update from the root. a_nodes is ordered
+        // root first, each node parented to the one before it.
+        void AddChain(std::uint64_t a_owner, const std::vector<SimComponent*>& a_nodes);
+        void RemoveChains(std::uint64_t a_owner);
+
+        // a_interval > 1 integrates the node every a_interval steps with the accumulated time
+        void SetLOD(size_type a_slot, std::uint32_t a_interval, std::uint32_t a_phase);
+        // frozen nodes are kept out of every pass until thawed
+        void SetFrozen(size_type a_slot, bool a_frozen);
+
+        // deferred nodes accumulate time like skipped LOD steps and catch up once they run again
+        inline void SetDeferred(size_type a_slot, bool a_deferred)
+        {
+            if (a_deferred)
+                m_flags[a_slot] |= kFlagDeferred;
+            else
+                m_flags[a_slot] &= ~kFlagDeferred;
+        }
+
+        [[nodiscard]] inline bool IsAwake(size_type a_slot) const noexcept {
+            return a_slot < m_numAwake;
+        }
+
+        // node steps integrated since the last reset
+        [[nodiscard]] inline std::uint32_t GetSimulatedCount() const noexcept {
+            return m_simulated;
+        }
+
+        inline void ResetSimulatedCount() noexcept {
+            m_simulated = 0;
+        }
+
+        // forces rejected because the node's queue was full
+        [[nodiscard]] inline std::uint32_t GetDroppedForces() const noexcept {
+            return m_droppedForces;
+        }
+
+        inline void AddDroppedForce() noexcept {
+            m_droppedForces++;
+        }
+
+        // scene graph node updates done by the last Interpolate
+        [[nodiscard]] inline std::uint32_t GetNodeWrites() const noexcept {
+            return m_nodeWrites;
+        }
+
+        // While set, UpdateMovement adds steps, force queue depth and integration cycles to
+        // each node's cost counters. Cycles are measured per work chunk and split evenly
+        // between the nodes stepped in it.
+        inline void SetCostSampling(bool a_enabled) noexcept {
+            m_sampleCosts = a_enabled;
+        }
+
+        [[nodiscard]] inline bool IsSamplingCosts() const noexcept {
+            return m_sampleCosts;
+        }
+
+        void UpdateVelocity(WorkerPool& a_workers);
+        void UpdateMovement(float a_timeStep, WorkerPool& a_workers);
+        // Writes node transforms blended between the last two simulated states. This is
+        // the only place simulated nodes are written to the scene graph, always on the
+        // calling thread: the game's node world updates aren't known to be safe on others.
+        // Parent transforms are read on the workers.
+        void Interpolate(float a_alpha, WorkerPool& a_workers);
+
+        inline void SetConfig(size_type a_slot, const configComponent_t& a_conf)
+        {
+            m_stiffness[a_slot] = a_conf.stiffness;
+            m_stiffness2[a_slot] = a_conf.stiffness2;
+            m_damping[a_slot] = a_conf.damping;
+            m_maxOffset[a_slot] = a_conf.maxOffset;
+            m_gravityBias[a_slot] = a_conf.gravityBias;
+            m_cogOffset[a_slot] = a_conf.cogOffset;
+
+            m_flags[a_slot] &= ~(kFlagImplicit | kFlagPBD);
+
+            switch (ISimKernel::GetIntegratorType(a_conf.integrator))
+            {
+            case ISimKernel::IntegratorType::kImplicit:
+                m_flags[a_slot] |= kFlagImplicit;
+                break;
+            case ISimKernel::IntegratorType::kPBD:
+                m_flags[a_slot] |= kFlagPBD;
+                break;
+            default:
+                break;
+            }
+        }
+
+        inline void SetPosition(size_type a_slot, const NiPoint3& a_pos)
+        {
+            m_pos.x[a_slot] = a_pos.x;
+            m_pos.y[a_slot] = a_pos.y;
+            m_pos.z[a_slot] = a_pos.z;
+        }
+
+        [[nodiscard]] inline NiPoint3 GetPosition(size_type a_slot) const
+        {
+            return NiPoint3(m_pos.x[a_slot], m_pos.y[a_slot], m_pos.z[a_slot]);
+        }
+
+        inline void SetVelocity(size_type a_slot, float a_x, float a_y, float a_z)
+        {
+            float len = std::sqrt(a_x * a_x + a_y * a_y + a_z * a_z);
+            if (len > VELOCITY_MAX)
+            {
+                float m = VELOCITY_MAX / len;
+                a_x *= m;
+                a_y *= m;
+                a_z *= m;
+            }
+
+            m_vel.x[a_slot] = a_x;
+            m_vel.y[a_slot] = a_y;
+            m_vel.z[a_slot] = a_z;
+        }
+
+        inline void SetVelocityUnclamped(size_type a_slot, const NiPoint3& a_vel)
+        {
+            m_vel.x[a_slot] = a_vel.x;
+            m_vel.y[a_slot] = a_vel.y;
+            m_vel.z[a_slot] = a_vel.z;
+        }
+
+        [[nodiscard]] inline NiPoint3 GetVelocity(size_type a_slot) const
+        {
+            return NiPoint3(m_vel.x[a_slot], m_vel.y[a_slot], m_vel.z[a_slot]);
+        }
+
+        inline void ResetOffset(size_type a_slot)
+        {
+            m_ldiff.x[a_slot] = m_prevLdiff.x[a_slot] = 0.0f;
+            m_ldiff.y[a_slot] = m_prevLdiff.y[a_slot] = 0.0f;
+            m_ldiff.z[a_slot] = m_prevLdiff.z[a_slot] = 0.0f;
+        }
+
+        inline void SetDampingMul(size_type a_slot, float a_val) {
+            m_dampingMul[a_slot] = a_val;
+        }
+
+        inline void SetInContact(size_type a_slot, bool a_val)
+        {
+            if (a_val)
+                m_flags[a_slot] |= kFlagInContact;
+            else
+                m_flags[a_slot] &= ~kFlagInContact;
+        }
+
+        [[nodiscard]] inline bool IsPositionBased(size_type a_slot) const noexcept {
+            return (m_flags[a_slot] & kFlagPBD) != 0;
+        }
+
+        // moves the node by a_correction and removes velocity going against a_normal
+        inline void ProjectContact(size_type a_slot, const NiPoint3& a_correction, const NiPoint3& a_normal)
+        {
+            m_pos.x[a_slot] += a_correction.x;
+            m_pos.y[a_slot] += a_correction.y;
+            m_pos.z[a_slot] += a_correction.z;
+
+            float vn =
+                m_vel.x[a_slot] * a_normal.x +
+                m_vel.y[a_slot] * a_normal.y +
+                m_vel.z[a_slot] * a_normal.z;
+
+            if (vn < 0.0f)
+            {
+                m_vel.x[a_slot] -= a_normal.x * vn;
+                m_vel.y[a_slot] -= a_normal.y * vn;
+                m_vel.z[a_slot] -= a_normal.z * vn;
+            }
+        }
+
+        inline void ResetOverrides(size_type a_slot)
+        {
+            m_dampingMul[a_slot] = 1.0f;
+            m_flags[a_slot] &= ~kFlagInContact;
+        }
+
+        [[nodiscard]] inline size_type Size() const noexcept {
+            return static_cast<size_type>(m_components.size());
+        }
+
+        [[nodiscard]] inline size_type NumMoving() const noexcept {
+            return m_numMoving;
+        }
+
+        [[nodiscard]] inline size_type NumAwake() const noexcept {
+            return m_numAwake;
+        }
+
+        [[nodiscard]] inline size_type NumChains() const noexcept {
+            return static_cast<size_type>(m_chains.size());
+        }
+
+    private:
+
+        struct chain_t
+        {
+            std::uint64_t owner;
+            // range in m_chainLinks
+            size_type begin;
+            size_type end;
+        };
+
+        // one actor's nodes, root first, and its chains (SimObject::UpdateChains adds an
+        // actor's chains together so they're contiguous)
+        struct writeGroup_t
+        {
+            // range in m_writeNodes
+            size_type begin;
+            size_type end;
+            // range in m_chains
+            size_type chainBegin;
+            size_type chainEnd;
+        };
+
+        struct writeNode_t
+        {
+            SimComponent* component;
+            // closest ancestor in the same group, npos if none
+            size_type ancestor;
+        };
+
+        enum WriteState : std::uint8_t
+        {
+            kWriteNone = 0,
+            // local transform set this frame
+            kWriteLocal = 1 << 0,
+            // an ancestor's world update reaches the node
+            kWriteCovered = 1 << 1
+        };
+
+        struct parentTransform_t
+        {
+            NiTransform world;
+            NiMatrix33 invRot;
+        };
+
+        struct vec3_t
+        {
+            std::vector<float> x;
+            std::vector<float> y;
+            std::vector<float> z;
+        };
+
+        template <typename T>
+        inline void ForEachVector(T a_func)
+        {
+            a_func(m_pos.x); a_func(m_pos.y); a_func(m_pos.z);
+            a_func(m_vel.x); a_func(m_vel.y); a_func(m_vel.z);
+            a_func(m_target.x); a_func(m_target.y); a_func(m_target.z);
+            a_func(m_force.x); a_func(m_force.y); a_func(m_force.z);
+            a_func(m_ldiff.x); a_func(m_ldiff.y); a_func(m_ldiff.z);
+            a_func(m_prevLdiff.x); a_func(m_prevLdiff.y); a_func(m_prevLdiff.z);
+
+            for (auto& e : m_rot)
+                a_func(e);
+
+            a_func(m_stiffness);
+            a_func(m_stiffness2);
+            a_func(m_damping);
+            a_func(m_maxOffset);
+            a_func(m_gravityBias);
+            a_func(m_cogOffset);
+            a_func(m_dampingMul);
+            a_func(m_flags);
+            a_func(m_sleepSteps);
+            a_func(m_lastOffset);
+            a_func(m_lodInterval);
+            a_func(m_lodPhase);
+            a_func(m_lodTime);
+            a_func(m_stepTime);
+            a_func(m_subStepTime);
+            a_func(m_idleTicks);
+            a_func(m_blendTicks);
+            a_func(m_parentIndex);
+            a_func(m_components);
+        }
+
+        void Swap(size_type a_lhs, size_type a_rhs);
+        void PopBack();
+
+        void UpdateParents();
+        void GatherParents(WorkerPool& a_workers);
+
+        void Gather(float a_timeStep, float a_maxTime, size_type a_begin, size_type a_end);
+        void AddChunkCost(std::uint64_t a_cycles, size_type a_begin, size_type a_end);
+        void Integrate(float a_timeStep, size_type a_begin, size_type a_end);
+
+        [[nodiscard]] inline static std::uint32_t GetSubSteps(float a_time, float a_timeStep)
+        {
+            // accumulated steps come out a little over a multiple of a_timeStep
+            return std::max(static_cast<std::uint32_t>(std::ceil(a_time / a_timeStep - 0.01f)), 1U);
+        }
+        // Interpolate's blend between the last two states of a slot. One that skipped ticks
+        // (LOD interval, budget) moves on toward its last state over the ticks that step
+        // covered instead of starting over from the previous state every tick.
+        [[nodiscard]] inline float GetBlend(size_type a_slot, float a_alpha) const noexcept
+        {
+            auto idle = m_idleTicks[a_slot];
+            auto span = m_blendTicks[a_slot];
+
+            if (idle == 0 && span <= 1)
+                return a_alpha;
+
+            return std::min((static_cast<float>(idle) + a_alpha) / static_cast<float>(std::max(span, 1U)), 1.0f);
+        }
+
+        void UpdateWriteGroups();
+        size_type WriteGroup(float a_alpha, const writeGroup_t& a_group);
+        bool SetChainTransforms(float a_alpha, const chain_t& a_chain);
+        void SolveChains(size_type a_begin, size_type a_end);
+        void UpdateColliders();
+
+        void CheckWake(float a_distance, size_type a_begin, size_type a_end);
+        void WakeFlagged();
+        void WakeAll();
+        void UpdateSleepSteps(float a_velocity, float a_offset, size_type a_begin, size_type a_end);
+        void Sleep(std::uint32_t a_steps);
+
+        vec3_t m_pos;
+        vec3_t m_vel;
+        vec3_t m_target;
+        vec3_t m_force;
+        vec3_t m_ldiff;
+        vec3_t m_prevLdiff;
+
+        // parent world rotation, row major
+        std::vector<float> m_rot[9];
+
+        std::vector<float> m_stiffness;
+        std::vector<float> m_stiffness2;
+        std::vector<float> m_damping;
+        std::vector<float> m_maxOffset;
+        std::vector<float> m_gravityBias;
+        std::vector<float> m_cogOffset;
+        std::vector<float> m_dampingMul;
+        std::vector<std::uint8_t> m_flags;
+        std::vector<std::uint16_t> m_sleepSteps;
+        std::vector<float> m_lastOffset;
+        std::vector<std::uint8_t> m_lodInterval;
+        std::vector<std::uint8_t> m_lodPhase;
+        std::vector<float> m_lodTime;
+        std::vector<float> m_stepTime;
+        // step time of the current kernel pass
+        std::vector<float> m_subStepTime;
+        // ticks since the slot last stepped and the ticks that step covered, see GetBlend
+        std::vector<std::uint32_t> m_idleTicks;
+        std::vector<std::uint32_t> m_blendTicks;
+        std::vector<size_type> m_parentIndex;
+
+        std::vector<SimComponent*> m_components;
+
+        // unique parent nodes, transforms copied once per step
+        std::vector<NiAVObject*> m_parents;
+        std::vector<parentTransform_t> m_parentCache;
+        bool m_parentsDirty = false;
+
+        std::vector<chain_t> m_chains;
+        std::vector<SimComponent*> m_chainLinks;
+
+        std::vector<writeGroup_t> m_writeGroups;
+        std::vector<writeNode_t> m_writeNodes;
+        // index in m_writeNodes of every m_chainLinks entry
+        std::vector<size_type> m_chainWriteIndex;
+        // WriteState, per frame
+        std::vector<std::uint8_t> m_writeState;
+        bool m_writeGroupsDirty = false;
+
+        size_type m_numMoving = 0;
+        size_type m_numAwake = 0;
+
+        std::uint32_t m_step = 0;
+        std::uint32_t m_simulated = 0;
+        std::uint32_t m_droppedForces = 0;
+        std::uint32_t m_nodeWrites = 0;
+
+        bool m_sampleCosts = false;
+    };
+}
\ No newline at end of file
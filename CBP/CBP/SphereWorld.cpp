@@ -0,0 +1,610 @@
+#include "pch.h"
+
+namespace CBP
+{
+    static constexpr std::uint32_t SWEEP_PADDING = 4;
+
+    // set bits in a 4 lane mask
+    static constexpr std::uint32_t s_laneCount[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+
+    inline static __m128i LoadLanes(const std::uint32_t* a_p)
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(a_p));
+    }
+
+    SphereWorld::SphereWorld() :
+        m_stats{ 0, 0, 0, 0, 0 }
+    {
+    }
+
+    auto SphereWorld::Add(void* a_userData, float a_radius, std::uint64_t a_owner) -> handle_t
+    {
+        handle_t handle;
+
+        if (!m_free.empty())
+        {
+            handle = m_free.back();
+            m_free.pop_back();
+        }
+        else
+        {
+            handle = static_cast<handle_t>(m_x.size());
+
+            m_x.emplace_back();
+            m_y.emplace_back();
+            m_z.emplace_back();
+            m_radius.emplace_back();
+            m_minX.emplace_back();
+            m_userData.emplace_back();
+            m_filter.emplace_back();
+            m_owner.emplace_back();
+            m_active.emplace_back();
+            m_orderIndex.emplace_back();
+        }
+
+        m_x[handle] = 0.0f;
+        m_y[handle] = 0.0f;
+        m_z[handle] = 0.0f;
+        m_radius[handle] = a_radius;
+        m_minX[handle] = -a_radius;
+        m_userData[handle] = a_userData;
+        m_filter[handle] = filter_t{ 1, ~0U, 0 };
+        m_owner[handle] = AcquireOwner(a_owner);
+        m_active[handle] = 1;
+
+        m_orderIndex[handle] = static_cast<handle_t>(m_order.size());
+        m_order.emplace_back(handle);
+
+        return handle;
+    }
+
+    void SphereWorld::RemoveImpl(handle_t a_handle)
+    {
+        // the last handle takes the slot, SortAxis puts it back in place on the next update
+        auto index = m_orderIndex[a_handle];
+        auto last = m_order.back();
+
+        m_order[index] = last;
+        m_orderIndex[last] = index;
+
+        m_order.pop_back();
+        m_orderIndex[a_handle] = npos;
+
+        auto hasHandle = [&](auto a_key) {
+            return static_cast<handle_t>(a_key >> 32) == a_handle ||
+                static_cast<handle_t>(a_key & 0xFFFFFFFF) == a_handle;
+        };
+
+        m_prevPairs.erase(std::remove_if(m_prevPairs.begin(), m_prevPairs.end(), hasHandle),
+            m_prevPairs.end());
+
+        m_pairs.erase(std::remove_if(m_pairs.begin(), m_pairs.end(),
+            [&](const auto& a_pair) { return hasHandle(a_pair.key); }), m_pairs.end());
+
+        ReleaseOwner(m_owner[a_handle]);
+
+        m_userData[a_handle] = nullptr;
+        m_active[a_handle] = 0;
+
+        m_free.emplace_back(a_handle);
+
+        if (m_order.empty())
+            Clear();
+    }
+
+    // handle reuse order would otherwise depend on what was removed last, an emptied world
+    // starts over so runs that add the same spheres get the same handles and pair order
+    void SphereWorld::Clear()
+    {
+        m_x.clear();
+        m_y.clear();
+        m_z.clear();
+        m_radius.clear();
+        m_minX.clear();
+        m_userData.clear();
+        m_filter.clear();
+        m_owner.clear();
+        m_active.clear();
+        m_orderIndex.clear();
+        m_free.clear();
+
+        m_owners.clear();
+        m_freeOwners.clear();
+        m_ownerMap.clear();
+
+        m_pairs.clear();
+        m_prevPairs.clear();
+        m_contacts.clear();
+    }
+
+    std::uint32_t SphereWorld::AcquireOwner(std::uint64_t a_key)
+    {
+        auto it = m_ownerMap.find(a_key);
+        if (it != m_ownerMap.end())
+        {
+            m_owners[it->second].refs++;
+            return it->second;
+        }
+
+        std::uint32_t owner;
+
+        if (!m_freeOwners.empty())
+        {
+            owner = m_freeOwners.back();
+            m_freeOwners.pop_back();
+        }
+        else
+        {
+            owner = static_cast<std::uint32_t>(m_owners.size());
+            m_owners.emplace_back();
+        }
+
+        auto& e = m_owners[owner];
+
+        e.key = a_key;
+        e.refs = 1;
+        e.count = 0;
+
+        m_ownerMap.emplace(a_key, owner);
+
+        return owner;
+    }
+
+    void SphereWorld::ReleaseOwner(std::uint32_t a_owner)
+    {
+        auto& e = m_owners[a_owner];
+
+        if (--e.refs > 0)
+            return;
+
+        m_ownerMap.erase(e.key);
+        m_freeOwners.emplace_back(a_owner);
+    }
+
+    void SphereWorld::Update()
+    {
+        m_contacts.clear();
+
+        SortAxis();
+        UpdateBounds();
+        BuildIslands();
+        Gather();
+        Collide();
+        GenerateEvents();
+    }
+
+    void SphereWorld::UpdatePairs()
+    {
+        m_contacts.clear();
+
+        for (const auto& e : m_pairs)
+        {
+            auto h1 = static_cast<handle_t>(e.key >> 32);
+            auto h2 = static_cast<handle_t>(e.key & 0xFFFFFFFF);
+
+            if (!m_active[h1] || !m_active[h2])
+                continue;
+
+            NiPoint3 d(m_x[h2] - m_x[h1], m_y[h2] - m_y[h1], m_z[h2] - m_z[h1]);
+
+            auto rs = m_radius[h1] + m_radius[h2];
+            auto d2 = d.x * d.x + d.y * d.y + d.z * d.z;
+
+            if (d2 >= rs * rs)
+                continue;
+
+            auto dist = std::sqrt(d2);
+
+            m_contacts.emplace_back(contact_t{
+                m_userData[h1], m_userData[h2],
+                dist > _EPSILON ? d * (1.0f / dist) : NiPoint3(0.0f, 0.0f, 1.0f),
+                rs - dist, ContactEvent::kStay });
+        }
+    }
+
+    // nodes move little between steps, the previous order is nearly sorted
+    void SphereWorld::SortAxis()
+    {
+        for (auto e : m_order)
+            m_minX[e] = m_x[e] - m_radius[e];
+
+        auto n = m_order.size();
+
+        for (std::size_t i = 1; i < n; i++)
+        {
+            auto h = m_order[i];
+            auto v = m_minX[h];
+
+            auto j = i;
+            while (j > 0 && m_minX[m_order[j - 1]] > v)
+            {
+                m_order[j] = m_order[j - 1];
+                j--;
+            }
+
+            m_order[j] = h;
+        }
+
+        for (std::size_t i = 0; i < n; i++)
+            m_orderIndex[m_order[i]] = static_cast<handle_t>(i);
+    }
+
+    void SphereWorld::UpdateBounds()
+    {
+        constexpr float inf = std::numeric_limits<float>::infinity();
+
+        for (auto& e : m_owners)
+        {
+            e.count = 0;
+
+            for (std::uint32_t i = 0; i < 3; i++)
+            {
+                e.min[i] = inf;
+                e.max[i] = -inf;
+            }
+        }
+
+        m_stats.spheres = 0;
+
+        for (auto e : m_order)
+        {
+            if (!m_active[e])
+                continue;
+
+            auto& owner = m_owners[m_owner[e]];
+            auto r = m_radius[e];
+
+            owner.min[0] = std::min(owner.min[0], m_x[e] - r);
+            owner.min[1] = std::min(owner.min[1], m_y[e] - r);
+            owner.min[2] = std::min(owner.min[2], m_z[e] - r);
+            owner.max[0] = std::max(owner.max[0], m_x[e] + r);
+            owner.max[1] = std::max(owner.max[1], m_y[e] + r);
+            owner.max[2] = std::max(owner.max[2], m_z[e] + r);
+
+            owner.count++;
+            m_stats.spheres++;
+        }
+
+        m_activeOwners.clear();
+
+        for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(m_owners.size()); i++)
+        {
+            auto& e = m_owners[i];
+            if (!e.count)
+                continue;
+
+            NiPoint3 extent(
+                (e.max[0] - e.min[0]) * 0.5f,
+                (e.max[1] - e.min[1]) * 0.5f,
+                (e.max[2] - e.min[2]) * 0.5f);
+
+            e.center = NiPoint3(e.min[0] + extent.x, e.min[1] + extent.y, e.min[2] + extent.z);
+            e.radius = extent.Length();
+
+            m_activeOwners.emplace_back(i);
+        }
+
+        m_stats.owners = static_cast<std::uint32_t>(m_activeOwners.size());
+    }
+
+    std::uint32_t SphereWorld::FindRoot(std::uint32_t a_owner)
+    {
+        while (m_islandParent[a_owner] != a_owner)
+        {
+            m_islandParent[a_owner] = m_islandParent[m_islandParent[a_owner]];
+            a_owner = m_islandParent[a_owner];
+        }
+
+        return a_owner;
+    }
+
+    // owners are few, a plain sweep over their bounds is enough
+    void SphereWorld::BuildIslands()
+    {
+        std::sort(m_activeOwners.begin(), m_activeOwners.end(),
+            [&](auto a_lhs, auto a_rhs)
+            {
+                auto& l = m_owners[a_lhs];
+                auto& r = m_owners[a_rhs];
+
+                auto lv = l.center.x - l.radius;
+                auto rv = r.center.x - r.radius;
+
+                return lv < rv || (lv == rv && a_lhs < a_rhs);
+            });
+
+        m_islandParent.resize(m_owners.size());
+
+        for (auto e : m_activeOwners)
+            m_islandParent[e] = e;
+
+        m_stats.ownerPairs = 0;
+
+        auto n = m_activeOwners.size();
+
+        for (std::size_t i = 0; i < n; i++)
+        {
+            auto& a = m_owners[m_activeOwners[i]];
+            auto maxX = a.center.x + a.radius;
+
+            for (auto j = i + 1; j < n; j++)
+            {
+                auto& b = m_owners[m_activeOwners[j]];
+
+                if (b.center.x - b.radius > maxX)
+                    break;
+
+                auto d = b.center - a.center;
+                auto rs = a.radius + b.radius;
+
+                if (d.x * d.x + d.y * d.y + d.z * d.z >= rs * rs)
+                    continue;
+
+                m_stats.ownerPairs++;
+
+                auto ra = FindRoot(m_activeOwners[i]);
+                auto rb = FindRoot(m_activeOwners[j]);
+
+                if (ra != rb)
+                    m_islandParent[std::max(ra, rb)] = std::min(ra, rb);
+            }
+        }
+
+        for (auto e : m_activeOwners)
+            m_owners[e].island = npos;
+
+        std::uint32_t islands = 0;
+
+        for (auto e : m_activeOwners)
+        {
+            auto& root = m_owners[FindRoot(e)];
+
+            if (root.island == npos)
+                root.island = islands++;
+
+            m_owners[e].island = root.island;
+        }
+
+        m_stats.islands = islands;
+    }
+
+    void SphereWorld::Gather()
+    {
+        auto islands = m_stats.islands;
+
+        m_islandOffset.assign(islands, 0);
+
+        for (auto e : m_activeOwners)
+            m_islandOffset[m_owners[e].island] += m_owners[e].count;
+
+        m_segments.resize(islands);
+
+        std::uint32_t offset = 0;
+
+        for (std::uint32_t i = 0; i < islands; i++)
+        {
+            auto count = m_islandOffset[i];
+
+            m_segments[i] = segment_t{ offset, offset + count };
+            m_islandOffset[i] = offset;
+
+            offset += count + SWEEP_PADDING;
+        }
+
+        m_sMinX.resize(offset);
+        m_sX.resize(offset);
+        m_sY.resize(offset);
+        m_sZ.resize(offset);
+        m_sRadius.resize(offset);
+        m_sCategory.resize(offset);
+        m_sMask.resize(offset);
+        m_sGroup.resize(offset);
+        m_sOwner.resize(offset);
+        m_sHandle.resize(offset);
+
+        // m_order is sorted, so is every island
+        for (auto e : m_order)
+        {
+            if (!m_active[e])
+                continue;
+
+            auto i = m_islandOffset[m_owners[m_owner[e]].island]++;
+
+            m_sMinX[i] = m_minX[e];
+            m_sX[i] = m_x[e];
+            m_sY[i] = m_y[e];
+            m_sZ[i] = m_z[e];
+            m_sRadius[i] = m_radius[e];
+            m_sCategory[i] = m_filter[e].category;
+            m_sMask[i] = m_filter[e].mask;
+            m_sGroup[i] = m_filter[e].group;
+            m_sOwner[i] = m_owner[e];
+            m_sHandle[i] = e;
+        }
+
+        // past the end of the island's sweeps
+        for (const auto& e : m_segments)
+        {
+            for (auto i = e.end; i < e.end + SWEEP_PADDING; i++)
+            {
+                m_sMinX[i] = std::numeric_limits<float>::infinity();
+                m_sX[i] = 0.0f;
+                m_sY[i] = 0.0f;
+                m_sZ[i] = 0.0f;
+                m_sRadius[i] = 0.0f;
+                m_sCategory[i] = 0;
+                m_sMask[i] = 0;
+                m_sGroup[i] = 0;
+                m_sOwner[i] = npos;
+                m_sHandle[i] = npos;
+            }
+        }
+    }
+
+    void SphereWorld::Collide()
+    {
+        m_pairs.clear();
+        m_stats.rejected = 0;
+
+        for (const auto& e : m_segments)
+            Collide(e.begin, e.end);
+    }
+
+    void SphereWorld::Collide(std::uint32_t a_begin, std::uint32_t a_end)
+    {
+        auto minX = m_sMinX.data();
+        auto px = m_sX.data();
+        auto py = m_sY.data();
+        auto pz = m_sZ.data();
+        auto pr = m_sRadius.data();
+        auto pc = m_sCategory.data();
+        auto pm = m_sMask.data();
+        auto pg = m_sGroup.data();
+        auto po = m_sOwner.data();
+
+        auto zero = _mm_setzero_si128();
+
+        std::uint32_t rejected = 0;
+
+        for (auto i = a_begin; i < a_end; i++)
+        {
+            auto maxX = _mm_set1_ps(px[i] + pr[i]);
+            auto x = _mm_set1_ps(px[i]);
+            auto y = _mm_set1_ps(py[i]);
+            auto z = _mm_set1_ps(pz[i]);
+            auto r = _mm_set1_ps(pr[i]);
+            auto c = _mm_set1_epi32(static_cast<int>(pc[i]));
+            auto m = _mm_set1_epi32(static_cast<int>(pm[i]));
+            auto g = _mm_set1_epi32(static_cast<int>(pg[i]));
+            auto o = _mm_set1_epi32(static_cast<int>(po[i]));
+
+            // candidates start overlapping i on x in sweep order, the sentinels end the loop
+            for (auto j = i + 1;; j += 4)
+            {
+                auto inRange = _mm_cmple_ps(_mm_loadu_ps(minX + j), maxX);
+                auto rangeMask = _mm_movemask_ps(inRange);
+
+                if (rangeMask == 0)
+                    break;
+
+                auto dx = _mm_sub_ps(_mm_loadu_ps(px + j), x);
+                auto dy = _mm_sub_ps(_mm_loadu_ps(py + j), y);
+                auto dz = _mm_sub_ps(_mm_loadu_ps(pz + j), z);
+                auto rs = _mm_add_ps(_mm_loadu_ps(pr + j), r);
+
+                auto d2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+                auto hits = _mm_movemask_ps(_mm_and_ps(inRange, _mm_cmplt_ps(d2, _mm_mul_ps(rs, rs))));
+
+                // filter_t test on all four lanes, see Accepts()
+                auto noCategory = _mm_or_si128(
+                    _mm_cmpeq_epi32(_mm_and_si128(LoadLanes(pc + j), m), zero),
+                    _mm_cmpeq_epi32(_mm_and_si128(LoadLanes(pm + j), c), zero));
+
+                auto sameGroup = _mm_andnot_si128(
+                    _mm_cmpeq_epi32(_mm_and_si128(LoadLanes(pg + j), g), zero),
+                    _mm_cmpeq_epi32(LoadLanes(po + j), o));
+
+                auto filtered = _mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(noCategory, sameGroup)));
+
+                rejected += s_laneCount[hits & filtered];
+                hits &= ~filtered;
+
+                if (hits)
+                {
+                    for (std::uint32_t k = 0; k < 4; k++)
+                        if (hits & (1 << k))
+                            AddPair(i, j + k);
+                }
+
+                if (rangeMask != 0xF)
+                    break;
+            }
+        }
+
+        m_stats.rejected += rejected;
+    }
+
+    void SphereWorld::AddPair(handle_t a_lhs, handle_t a_rhs)
+    {
+        auto h1 = m_sHandle[a_lhs];
+        auto h2 = m_sHandle[a_rhs];
+
+        // contact normal points from the lower handle to the higher one
+        if (h1 > h2) {
+            std::swap(h1, h2);
+            std::swap(a_lhs, a_rhs);
+        }
+
+        NiPoint3 d(
+            m_sX[a_rhs] - m_sX[a_lhs],
+            m_sY[a_rhs] - m_sY[a_lhs],
+            m_sZ[a_rhs] - m_sZ[a_lhs]);
+
+        auto dist = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+
+        pair_t pair;
+        pair.key = MakeKey(h1, h2);
+        pair.depth = m_sRadius[a_lhs] + m_sRadius[a_rhs] - dist;
+
+        if (dist > _EPSILON)
+            pair.normal = d * (1.0f / dist);
+        else
+            pair.normal = NiPoint3(0.0f, 0.0f, 1.0f);
+
+        m_pairs.emplace_back(pair);
+    }
+
+    void SphereWorld::GenerateEvents()
+    {
+        std::sort(m_pairs.begin(), m_pairs.end(),
+            [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.key < a_rhs.key; });
+
+        m_keys.clear();
+
+        auto it = m_prevPairs.begin();
+
+        for (const auto& e : m_pairs)
+        {
+            while (it != m_prevPairs.end() && *it < e.key)
+            {
+                auto h1 = static_cast<handle_t>(*it >> 32);
+                auto h2 = static_cast<handle_t>(*it & 0xFFFFFFFF);
+
+                m_contacts.emplace_back(contact_t{
+                    m_userData[h1], m_userData[h2], NiPoint3(), 0.0f, ContactEvent::kExit });
+
+                ++it;
+            }
+
+            ContactEvent event;
+
+            if (it != m_prevPairs.end() && *it == e.key)
+            {
+                event = ContactEvent::kStay;
+                ++it;
+            }
+            else
+                event = ContactEvent::kStart;
+
+            auto h1 = static_cast<handle_t>(e.key >> 32);
+            auto h2 = static_cast<handle_t>(e.key & 0xFFFFFFFF);
+
+            m_contacts.emplace_back(contact_t{
+                m_userData[h1], m_userData[h2], e.normal, e.depth, event });
+
+            m_keys.emplace_back(e.key);
+        }
+
+        for (; it != m_prevPairs.end(); ++it)
+        {
+            auto h1 = static_cast<handle_t>(*it >> 32);
+            auto h2 = static_cast<handle_t>(*it & 0xFFFFFFFF);
+
+            m_contacts.emplace_back(contact_t{
+                m_userData[h1], m_userData[h2], NiPoint3(), 0.0f, ContactEvent::kExit });
+        }
+
+        m_prevPairs.swap(m_keys);
+    }
+}
\ No newline at end of file
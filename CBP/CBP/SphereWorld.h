@@ -0,0 +1,244 @@
+#pragma once
+
+namespace CBP
+{
+    // Sphere-only collision world for the node colliders. Spheres are kept in slot arrays,
+    // Update() sorts them along x (sweep and prune, insertion sort on the order of the
+    // previous update) and tests candidates four at a time. Pairs are matched against the
+    // previous update to report start/stay/exit the way r3d's contact callback does.
+    //
+    // Every sphere belongs to an owner (the actor). Owner bounding spheres are refreshed each
+    // update and owners whose bounds overlap are merged into islands, each island is swept on
+    // its own so spheres of actors that aren't near each other are never paired up.
+    //
+    // Pairs are filtered in the sweep by per-sphere bits (see filter_t) instead of a callback.
+    class SphereWorld
+    {
+    public:
+        typedef std::uint32_t handle_t;
+
+        static constexpr handle_t npos = std::numeric_limits<handle_t>::max();
+
+        enum class ContactEvent : std::uint32_t
+        {
+            kStart,
+            kStay,
+            kExit
+        };
+
+        struct contact_t
+        {
+            void* userData1;
+            void* userData2;
+            // from sphere 1 to sphere 2, zero on exit
+            NiPoint3 normal;
+            float depth;
+            ContactEvent event;
+        };
+
+        typedef std::vector<contact_t> contactList_t;
+
+        // Two spheres collide when each one's category is in the other's mask and, if both
+        // have the same owner, their groups share no bit. Added spheres collide with everything.
+        struct filter_t
+        {
+            std::uint32_t category;
+            std::uint32_t mask;
+            std::uint32_t group;
+        };
+
+        [[nodiscard]] inline static bool Accepts(
+            const filter_t& a_lhs,
+            const filter_t& a_rhs,
+            bool a_sameOwner) noexcept
+        {
+            return (a_lhs.category & a_rhs.mask) != 0 &&
+                (a_rhs.category & a_lhs.mask) != 0 &&
+                (!a_sameOwner || (a_lhs.group & a_rhs.group) == 0);
+        }
+
+        // as of the last update
+        struct stats_t
+        {
+            std::uint32_t spheres;
+            std::uint32_t owners;
+            std::uint32_t islands;
+            // owners with overlapping bounds
+            std::uint32_t ownerPairs;
+            // overlapping pairs dropped by the filter
+            std::uint32_t rejected;
+        };
+
+        SphereWorld();
+
+        SphereWorld(const SphereWorld&) = delete;
+        SphereWorld& operator=(const SphereWorld&) = delete;
+
+        [[nodiscard]] handle_t Add(void* a_userData, float a_radius, std::uint64_t a_owner);
+
+        // Pairs involving the sphere are dropped, a_onExit(userData, otherUserData) is called
+        // for every one that was in contact as of the last update instead of a kExit event
+        // (the user data may be gone by then). Once the last sphere is removed handles and
+        // owners are handed out from zero again.
+        template <typename Tf>
+        void Remove(handle_t a_handle, Tf a_onExit)
+        {
+            if (a_handle >= m_orderIndex.size() || m_orderIndex[a_handle] == npos)
+                return;
+
+            for (auto e : m_prevPairs)
+            {
+                auto h1 = static_cast<handle_t>(e >> 32);
+                auto h2 = static_cast<handle_t>(e & 0xFFFFFFFF);
+
+                if (h1 == a_handle)
+                    a_onExit(m_userData[h1], m_userData[h2]);
+                else if (h2 == a_handle)
+                    a_onExit(m_userData[h2], m_userData[h1]);
+            }
+
+            RemoveImpl(a_handle);
+        }
+
+        inline void SetPosition(handle_t a_handle, float a_x, float a_y, float a_z) noexcept
+        {
+            m_x[a_handle] = a_x;
+            m_y[a_handle] = a_y;
+            m_z[a_handle] = a_z;
+        }
+
+        inline void SetRadius(handle_t a_handle, float a_radius) noexcept {
+            m_radius[a_handle] = a_radius;
+        }
+
+        inline void SetActive(handle_t a_handle, bool a_active) noexcept {
+            m_active[a_handle] = a_active ? 1 : 0;
+        }
+
+        inline void SetFilter(handle_t a_handle, const filter_t& a_filter) noexcept {
+            m_filter[a_handle] = a_filter;
+        }
+
+        void Update();
+        // Re-tests the pairs found by the last Update() at the current positions instead of
+        // sweeping, pairs are reported as kStay and skipped while apart. Nothing starts or ends.
+        void UpdatePairs();
+
+        [[nodiscard]] inline const auto& GetContacts() const noexcept {
+            return m_contacts;
+        }
+
+        [[nodiscard]] inline std::uint32_t GetNbSpheres() const noexcept {
+            return static_cast<std::uint32_t>(m_order.size());
+        }
+
+        [[nodiscard]] inline const auto& GetStats() const noexcept {
+            return m_stats;
+        }
+
+        template <typename Tf>
+        void VisitActive(Tf a_func) const
+        {
+            for (auto e : m_order)
+                if (m_active[e])
+                    a_func(NiPoint3(m_x[e], m_y[e], m_z[e]), m_radius[e]);
+        }
+
+    private:
+        struct owner_t
+        {
+            std::uint64_t key;
+            std::uint32_t refs;
+            std::uint32_t count;
+            std::uint32_t island;
+            float min[3];
+            float max[3];
+            NiPoint3 center;
+            float radius;
+        };
+
+        struct segment_t
+        {
+            std::uint32_t begin;
+            std::uint32_t end;
+        };
+
+        struct pair_t
+        {
+            std::uint64_t key;
+            NiPoint3 normal;
+            float depth;
+        };
+
+        [[nodiscard]] inline static std::uint64_t MakeKey(handle_t a_lhs, handle_t a_rhs) noexcept
+        {
+            return a_lhs < a_rhs ?
+                (static_cast<std::uint64_t>(a_lhs) << 32) | a_rhs :
+                (static_cast<std::uint64_t>(a_rhs) << 32) | a_lhs;
+        }
+
+        [[nodiscard]] std::uint32_t AcquireOwner(std::uint64_t a_key);
+        void ReleaseOwner(std::uint32_t a_owner);
+
+        void SortAxis();
+        void UpdateBounds();
+        void BuildIslands();
+        std::uint32_t FindRoot(std::uint32_t a_owner);
+        void Gather();
+        void Collide();
+        void Collide(std::uint32_t a_begin, std::uint32_t a_end);
+        void AddPair(handle_t a_lhs, handle_t a_rhs);
+        void GenerateEvents();
+        void RemoveImpl(handle_t a_handle);
+        void Clear();
+
+        // slots, indexed by handle
+        std::vector<float> m_x;
+        std::vector<float> m_y;
+        std::vector<float> m_z;
+        std::vector<float> m_radius;
+        std::vector<float> m_minX;
+        std::vector<void*> m_userData;
+        std::vector<filter_t> m_filter;
+        std::vector<std::uint32_t> m_owner;
+        std::vector<std::uint8_t> m_active;
+        std::vector<handle_t> m_free;
+
+        // live handles ordered by min x as of the last update
+        std::vector<handle_t> m_order;
+        // position of every handle in m_order, npos if free
+        std::vector<handle_t> m_orderIndex;
+
+        std::vector<owner_t> m_owners;
+        std::vector<std::uint32_t> m_freeOwners;
+        std::unordered_map<std::uint64_t, std::uint32_t> m_ownerMap;
+
+        // owners with active spheres, sorted by bounds min x
+        std::vector<std::uint32_t> m_activeOwners;
+        std::vector<std::uint32_t> m_islandParent;
+        std::vector<std::uint32_t> m_islandOffset;
+        std::vector<segment_t> m_segments;
+
+        // active spheres in sweep order grouped by island, every island is padded with
+        // sentinels for the 4-wide loads
+        std::vector<float> m_sMinX;
+        std::vector<float> m_sX;
+        std::vector<float> m_sY;
+        std::vector<float> m_sZ;
+        std::vector<float> m_sRadius;
+        std::vector<std::uint32_t> m_sCategory;
+        std::vector<std::uint32_t> m_sMask;
+        std::vector<std::uint32_t> m_sGroup;
+        std::vector<std::uint32_t> m_sOwner;
+        std::vector<handle_t> m_sHandle;
+
+        std::vector<pair_t> m_pairs;
+        // keys overlapping after the last update, sorted
+        std::vector<std::uint64_t> m_prevPairs;
+        std::vector<std::uint64_t> m_keys;
+
+        contactList_t m_contacts;
+
+        stats_t m_stats;
+    };
+}
\ No newline at end of file
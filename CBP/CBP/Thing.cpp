@@ -2,17 +2,15 @@
 
 namespace CBP
 {
-    inline static float sgn(float val) {
-        return float((0.0f < val) - (val < 0.0f));
-    }
-
     SimComponent::Collider::Collider(
         SimComponent& a_parent)
         :
-        m_created(false),
-        m_active(true),
+        m_sphere(SphereWorld::npos),
+        m_useSpheres(false),
         m_nodeScale(1.0f),
         m_radius(1.0f),
+        m_created(false),
+        m_active(true),
         m_parent(a_parent)
     {}
 
@@ -21,13 +19,25 @@ namespace CBP
         if (m_created)
             return false;
 
-        auto world = DCBP::GetWorld();
-        auto& physicsCommon = DCBP::GetPhysicsCommon();
+        m_useSpheres = ICollision::GetBackend() == ICollision::Backend::kSpheres;
 
-        m_body = world->createCollisionBody(r3d::Transform::identity());
-        m_sphereShape = physicsCommon.createSphereShape(m_parent.m_conf.colSphereRadMax);
-        m_collider = m_body->addCollider(m_sphereShape, r3d::Transform::identity());
-        m_collider->setUserData(std::addressof(m_parent));
+        if (m_useSpheres)
+        {
+            auto& world = DCBP::GetSphereWorld();
+
+            m_sphere = world.Add(
+                std::addressof(m_parent), m_parent.m_conf.colSphereRadMax, m_parent.m_parentId);
+            world.SetFilter(m_sphere, m_parent.m_collisionFilter);
+        }
+        else
+        {
+            auto e = ICollision::AcquireBody(m_parent.m_conf.colSphereRadMax);
+
+            m_body = e.body;
+            m_sphereShape = e.shape;
+            m_collider = e.collider;
+            m_collider->setUserData(std::addressof(m_parent));
+        }
 
         m_created = true;
         m_active = true;
@@ -40,12 +50,13 @@ namespace CBP
         if (!m_created)
             return false;
 
-        auto world = DCBP::GetWorld();
-        auto& physicsCommon = DCBP::GetPhysicsCommon();
-
-        m_body->removeCollider(m_collider);
-        physicsCommon.destroySphereShape(m_sphereShape);
-        world->destroyCollisionBody(m_body);
+        if (m_useSpheres)
+        {
+            ICollision::RemoveSphere(m_sphere);
+            m_sphere = SphereWorld::npos;
+        }
+        else
+            ICollision::ReleaseBody(ICollision::pooledBody_t{ m_body, m_sphereShape, m_collider });
 
         m_created = false;
 
@@ -53,17 +64,22 @@ namespace CBP
     }
 
     void SimComponent::Collider::Update()
+    {
+        Update(m_parent.m_obj->m_worldTransform);
+    }
+
+    void SimComponent::Collider::Update(const NiTransform& a_worldTransform)
     {
         if (!m_created)
             return;
 
-        auto nodeScale = m_parent.m_obj->m_worldTransform.scale;
+        auto nodeScale = a_worldTransform.scale;
 
         if (!m_active) {
             if (nodeScale > 0.0f)
             {
                 m_active = true;
-                m_body->setIsActive(true);
+                SetBodyActive(true);
             }
             else
                 return;
@@ -72,16 +88,21 @@ namespace CBP
             if (nodeScale <= 0.0f)
             {
                 m_active = false;
-                m_body->setIsActive(false);
+                SetBodyActive(false);
                 m_parent.ResetOverrides();
                 return;
             }
         }
 
-        auto pos = m_parent.m_obj->m_worldTransform * m_sphereOffset;
+        auto pos = a_worldTransform * m_sphereOffset;
 
-        m_transform.setPosition(r3d::Vector3(pos.x, pos.y, pos.z));
-        m_body->setTransform(m_transform);
+        if (m_useSpheres)
+            DCBP::GetSphereWorld().SetPosition(m_sphere, pos.x, pos.y, pos.z);
+        else
+        {
+            m_transform.setPosition(r3d::Vector3(pos.x, pos.y, pos.z));
+            m_body->setTransform(m_transform);
+        }
 
         if (nodeScale != m_nodeScale) {
             m_nodeScale = nodeScale;
@@ -91,9 +112,53 @@ namespace CBP
 
     void SimComponent::Collider::Reset()
     {
-        if (m_created) {
+        if (!m_created)
+            return;
+
+        if (m_useSpheres)
+            DCBP::GetSphereWorld().SetPosition(m_sphere, 0.0f, 0.0f, 0.0f);
+        else
             m_body->setTransform(r3d::Transform::identity());
-        }
+    }
+
+    void SimComponent::Collider::UpdateRadius()
+    {
+        if (!m_created)
+            return;
+
+        auto rad = m_radius * m_nodeScale;
+        if (rad <= 0.0f)
+            return;
+
+        if (m_useSpheres)
+            DCBP::GetSphereWorld().SetRadius(m_sphere, rad);
+        else
+            m_sphereShape->setRadius(rad);
+    }
+
+    void SimComponent::Collider::UpdateFilter()
+    {
+        if (m_created && m_useSpheres)
+            DCBP::GetSphereWorld().SetFilter(m_sphere, m_parent.m_collisionFilter);
+    }
+
+    void SimComponent::Collider::SetBodyActive(bool a_active)
+    {
+        if (m_useSpheres)
+            DCBP::GetSphereWorld().SetActive(m_sphere, a_active);
+        else
+            m_body->setIsActive(a_active);
+    }
+
+    void SimComponent::Collider::Deactivate()
+    {
+        if (!m_created || !m_active)
+            return;
+
+        // Update() turns it back on
+        m_active = false;
+        SetBodyActive(false);
+        m_parent.ResetOverrides();
     }
 
     SimComponent::SimComponent(
@@ -106,23 +171,26 @@ namespace CBP
         bool a_collisions,
         bool a_movement)
         :
-        m_configGroupName(a_configGroupName),
-        m_oldWorldPos(a_obj->m_worldTransform.pos),
         m_initialNodePos(a_obj->m_localTransform.pos),
         m_initialNodeRot(a_obj->m_localTransform.rot),
         m_collisionData(*this),
-        m_parentId(a_parentId),
+        m_configGroupName(a_configGroupName),
+        m_movement(false),
         m_groupId(a_groupId),
-        m_inContact(false),
-        m_dampingMul(1.0f),
-        m_node(a_actor->loadedState->node),
+        m_parentId(a_parentId),
+        m_store(DCBP::GetSimStore()),
+        m_slot(SimStore::npos),
         m_obj(a_obj),
         m_objParent(a_obj->m_parent),
+        m_node(a_actor->loadedState->node),
         m_updateCtx({ 0.0f, 0 })
     {
 #ifdef _CBP_ENABLE_DEBUG
         m_debugInfo.parentNodeName = a_obj->m_parent->m_name;
 #endif
+        m_store.Add(this, false);
+        m_store.SetPosition(m_slot, a_obj->m_worldTransform.pos);
+
         UpdateConfig(a_actor, a_config, a_collisions, a_movement);
         m_collisionData.Update();
     }
@@ -130,6 +198,11 @@ namespace CBP
     void SimComponent::Release()
     {
         m_collisionData.Destroy();
+
+        if (m_slot != SimStore::npos) {
+            m_store.Remove(m_slot);
+            m_slot = SimStore::npos;
+        }
     }
 
     inline static float mmw(float a_val, float a_min, float a_max) {
@@ -166,9 +239,15 @@ namespace CBP
 
         if (a_movement != m_movement) {
             m_movement = a_movement;
-            m_applyForceQueue.swap(decltype(m_applyForceQueue)());
+            m_store.SetMovement(m_slot, a_movement);
+            ClearForces();
         }
 
+        UpdateCollisionFilter();
+
+        m_store.SetConfig(m_slot, a_config);
+        m_store.Wake(m_slot);
+
         if (!UpdateWeightData(a_actor, a_config)) {
             m_colSphereRad = a_config.colSphereRadMax;
             m_colSphereOffsetX = a_config.colSphereOffsetXMax;
@@ -194,10 +273,23 @@ namespace CBP
                 ResetOverrides();
         }
 
-        m_npCogOffset = NiPoint3(0.0f, m_conf.cogOffset, 0.0f);
         m_npGravityCorrection = NiPoint3(0.0f, 0.0f, m_conf.gravityCorrection);
     }
 
+    void SimComponent::UpdateGroupInfo(uint64_t a_parentId, uint64_t a_groupId)
+    {
+        m_parentId = a_parentId;
+        m_groupId = a_groupId;
+
+        UpdateCollisionFilter();
+    }
+
+    void SimComponent::UpdateCollisionFilter()
+    {
+        m_collisionFilter = ICollision::MakeFilter(m_groupId, m_movement);
+        m_collisionData.UpdateFilter();
+    }
+
     void SimComponent::Reset()
     {
         if (m_movement)
@@ -205,100 +297,69 @@ namespace CBP
             m_obj->m_localTransform.pos = m_initialNodePos;
             m_obj->m_localTransform.rot = m_initialNodeRot;
             m_obj->UpdateWorldData(&m_updateCtx);
-
-            m_oldWorldPos = m_obj->m_worldTransform.pos;
         }
 
+        // nodes without movement take their velocity from this on the next step
+        m_store.SetPosition(m_slot, m_obj->m_worldTransform.pos);
+
         m_collisionData.Update();
 
-        m_velocity = m_npZero;
+        m_store.SetVelocityUnclamped(m_slot, NiPoint3());
+        m_store.ResetOffset(m_slot);
+        m_store.Wake(m_slot);
 
-        m_applyForceQueue.swap(decltype(m_applyForceQueue)());
+        ClearForces();
     }
 
-    void SimComponent::UpdateMovement(float a_timeStep)
+    void SimComponent::GetLocalTransform(const NiMatrix33& a_parentInvRot, float a_x, float a_y, float a_z, NiTransform& a_out) const
     {
-        if (m_movement)
-        {
-            //Offset to move Center of Mass make rotational motion more significant  
-            NiPoint3 target(m_objParent->m_worldTransform * m_npCogOffset);
-
-            NiPoint3 diff(target - m_oldWorldPos);
-
-            if (fabs(diff.x) > 150.0f || fabs(diff.y) > 150.0f || fabs(diff.z) > 150.0f)
-            {
-                Reset();
-                return;
-            }
-
-            if (!m_inContact && m_dampingMul > 1.0f)
-                m_dampingMul = std::max(m_dampingMul / (a_timeStep + 1.0f), 1.0f);
-
-            auto newPos = m_oldWorldPos;
-
-            // Compute the "Spring" Force
-            NiPoint3 diff2(diff.x * diff.x * sgn(diff.x), diff.y * diff.y * sgn(diff.y), diff.z * diff.z * sgn(diff.z));
-            NiPoint3 force = (diff * m_conf.stiffness) + (diff2 * m_conf.stiffness2);
-
-            force.z -= m_conf.gravityBias;
-
-            if (m_applyForceQueue.size())
-            {
-                auto& current = m_applyForceQueue.front();
+        a_out.pos.x = m_initialNodePos.x + (a_x * m_conf.linearX);
+        a_out.pos.y = m_initialNodePos.y + (a_y * m_conf.linearY);
+        a_out.pos.z = m_initialNodePos.z + (a_z * m_conf.linearZ);
 
-                auto vD = m_objParent->m_worldTransform * current.force;
-                auto vP = m_objParent->m_worldTransform.pos;
+        a_out.pos += a_parentInvRot * m_npGravityCorrection;
 
-                force += (vD - vP) / a_timeStep;
+        a_out.rot.SetEulerAngles(
+            a_x * m_conf.rotationalX,
+            a_y * m_conf.rotationalY,
+            a_z * m_conf.rotationalZ);
 
-                current.steps--;
-
-                if (!current.steps)
-                    m_applyForceQueue.pop();
-            }
-
-            // Assume mass is 1, so Accelleration is Force, can vary mass by changing force
-            SetVelocity((m_velocity + (force * a_timeStep)) -
-                (m_velocity * ((m_conf.damping * a_timeStep) * m_dampingMul)));
-
-            newPos += m_velocity * a_timeStep;
-
-            diff = newPos - target;
-
-            diff.x = std::clamp(diff.x, -m_conf.maxOffset, m_conf.maxOffset);
-            diff.y = std::clamp(diff.y, -m_conf.maxOffset, m_conf.maxOffset);
-            diff.z = std::clamp(diff.z, -m_conf.maxOffset, m_conf.maxOffset);
-
-            auto invRot = m_objParent->m_worldTransform.rot.Transpose();
-            auto ldiff = invRot * diff;
+        a_out.scale = m_obj->m_localTransform.scale;
+    }
 
-            m_oldWorldPos = (m_objParent->m_worldTransform.rot * ldiff) + target;
+    void SimComponent::PopForce(const NiTransform& a_parentTransform, NiPoint3& a_out)
+    {
+        if (!m_forceCount)
+            return;
 
-            m_obj->m_localTransform.pos.x = m_initialNodePos.x + (ldiff.x * m_conf.linearX);
-            m_obj->m_localTransform.pos.y = m_initialNodePos.y + (ldiff.y * m_conf.linearY);
-            m_obj->m_localTransform.pos.z = m_initialNodePos.z + (ldiff.z * m_conf.linearZ);
+        auto& current = m_forces[m_forceHead];
 
-            m_obj->m_localTransform.pos += invRot * m_npGravityCorrection;
+        a_out = (a_parentTransform * current.force) - a_parentTransform.pos;
 
-            m_obj->m_localTransform.rot.SetEulerAngles(
-                ldiff.x * m_conf.rotationalX,
-                ldiff.y * m_conf.rotationalY,
-                ldiff.z * m_conf.rotationalZ);
+        current.steps--;
 
-            m_obj->UpdateWorldData(&m_updateCtx);
+        if (!current.steps)
+        {
+            m_forceHead = (m_forceHead + 1) % MAX_FORCES;
+            m_forceCount--;
         }
-
-        m_collisionData.Update();
     }
 
-    void SimComponent::UpdateVelocity()
+    void SimComponent::SetFrozen(bool a_frozen)
     {
-        if (m_movement)
-            return;
+        if (a_frozen)
+        {
+            Reset();
+
+            m_store.SetFrozen(m_slot, true);
+            m_collisionData.Deactivate();
+        }
+        else
+        {
+            m_store.SetFrozen(m_slot, false);
 
-        auto newPos = m_obj->m_worldTransform.pos;
-        m_velocity = newPos - m_oldWorldPos;
-        m_oldWorldPos = newPos;
+            Reset();
+        }
     }
 
     void SimComponent::ApplyForce(uint32_t a_steps, const NiPoint3& a_force)
@@ -306,12 +367,16 @@ namespace CBP
         if (!a_steps || !m_movement)
             return;
 
-        /*if (m_applyForceQueue.size() > 100)
-            return;*/
+        if (m_forceCount == MAX_FORCES)
+        {
+            m_store.AddDroppedForce();
+            return;
+        }
+
+        m_forces[(m_forceHead + m_forceCount) % MAX_FORCES] = Force{ a_steps, a_force };
+        m_forceCount++;
 
-        m_applyForceQueue.emplace(
-            Force{ a_steps, a_force }
-        );
+        m_store.Wake(m_slot);
     }
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -15,14 +15,31 @@ namespace CBP
     };
 #endif
 
+    // accumulated while SimStore samples costs, read and reset by CostProfiler
+    struct costCounters_t
+    {
+        uint64_t cycles;
+        uint32_t steps;
+        uint32_t contacts;
+        uint32_t maxForces;
+    };
+
     class SimComponent
     {
+        friend class SimStore;
+        friend class MotionRecorder;
+
         struct Force
         {
             uint32_t steps;
             NiPoint3 force;
         };
 
+    public:
+        // pending forces per node, ApplyForce drops new ones once full
+        static constexpr uint32_t MAX_FORCES = 8;
+
+    private:
         class Collider
         {
         public:
@@ -35,18 +52,17 @@ namespace CBP
             bool Create();
             bool Destroy();
             void Update();
+            void Update(const NiTransform& a_worldTransform);
             void Reset();
+            void Deactivate();
 
             inline void SetRadius(r3d::decimal a_val) {
                 m_radius = a_val;
                 UpdateRadius();
             }
 
-            inline void UpdateRadius() {
-                auto rad = m_radius * m_nodeScale;
-                if (rad > 0.0f)
-                    m_sphereShape->setRadius(rad);
-            }
+            void UpdateRadius();
+            void UpdateFilter();
 
             inline void SetSphereOffset(const NiPoint3& a_offset) {
                 m_sphereOffset = a_offset;
@@ -63,9 +79,15 @@ namespace CBP
             }
 
         private:
+            void SetBodyActive(bool a_active);
+
             r3d::CollisionBody* m_body;
             r3d::SphereShape* m_sphereShape;
             r3d::Collider* m_collider;
+
+            // ICollision::Backend::kSpheres at creation
+            SphereWorld::handle_t m_sphere;
+            bool m_useSpheres;
             NiPoint3 m_sphereOffset;
             float m_nodeScale;
             float m_radius;
@@ -81,19 +103,41 @@ namespace CBP
     private:
         bool UpdateWeightData(Actor* a_actor, const configComponent_t& a_config);
 
-        NiPoint3 m_npCogOffset;
-        NiPoint3 m_npGravityCorrection;
-        NiPoint3 m_npZero;
+        void GetLocalTransform(const NiMatrix33& a_parentInvRot, float a_x, float a_y, float a_z, NiTransform& a_out) const;
+        void PopForce(const NiTransform& a_parentTransform, NiPoint3& a_out);
+        void UpdateCollisionFilter();
 
-        NiPoint3 m_oldWorldPos;
-        NiPoint3 m_velocity;
+        inline void ClearForces() noexcept {
+            m_forceHead = 0;
+            m_forceCount = 0;
+        }
+
+        inline void UpdateCollider() {
+            m_collisionData.Update();
+        }
+
+        // places the collider from simulation state, the scene graph is only written once per frame
+        inline void UpdateCollider(const NiTransform& a_parentTransform, const NiMatrix33& a_parentInvRot, float a_x, float a_y, float a_z)
+        {
+            NiTransform local;
+            GetLocalTransform(a_parentInvRot, a_x, a_y, a_z, local);
+
+            m_collisionData.Update(a_parentTransform * local);
+        }
+
+        NiPoint3 m_npGravityCorrection;
 
         NiPoint3 m_initialNodePos;
         NiMatrix33 m_initialNodeRot;
 
         Collider m_collisionData;
 
-        std::queue<Force> m_applyForceQueue;
+        // fixed capacity ring, new forces are dropped when full
+        Force m_forces[MAX_FORCES];
+        uint32_t m_forceHead = 0;
+        uint32_t m_forceCount = 0;
+
+        costCounters_t m_cost{ 0, 0, 0, 0 };
 
         std::string m_configGroupName;
 
@@ -110,8 +154,11 @@ namespace CBP
         uint64_t m_groupId;
         uint64_t m_parentId;
 
-        float m_dampingMul;
-        bool m_inContact;
+        // ICollision::MakeFilter of m_groupId and m_movement
+        SphereWorld::filter_t m_collisionFilter;
+
+        SimStore& m_store;
+        SimStore::size_type m_slot;
 
         NiPointer<NiAVObject> m_obj;
         NiPointer<NiAVObject> m_objParent;
@@ -123,17 +170,6 @@ namespace CBP
         SimDebugInfo m_debugInfo;
 #endif
 
-        inline void ClampVelocity()
-        {
-            float len = m_velocity.Length();
-            if (len <= 1000.0f)
-                return;
-
-            m_velocity.x /= len;
-            m_velocity.y /= len;
-            m_velocity.z /= len;
-            m_velocity *= 1000.0f;
-        }
     public:
         SimComponent(
             Actor* a_actor,
@@ -158,37 +194,42 @@ namespace CBP
             bool a_collisions,
             bool a_movement) noexcept;
 
-        void UpdateMovement(float timeStep);
-        void UpdateVelocity();
         void Reset();
 
         void ApplyForce(uint32_t a_steps, const NiPoint3& a_force);
 
+        void SetFrozen(bool a_frozen);
+
+        inline void SetLOD(uint32_t a_interval, uint32_t a_phase) {
+            m_store.SetLOD(m_slot, a_interval, a_phase);
+        }
+
+        inline void SetDeferred(bool a_deferred) {
+            m_store.SetDeferred(m_slot, a_deferred);
+        }
+
+        [[nodiscard]] inline bool IsAwake() const {
+            return m_store.IsAwake(m_slot);
+        }
+
 #ifdef _CBP_ENABLE_DEBUG
         void UpdateDebugInfo();
 #endif
 
         inline void SetVelocity(const r3d::Vector3& a_vel) {
-            m_velocity.x = a_vel.x;
-            m_velocity.y = a_vel.y;
-            m_velocity.z = a_vel.z;
-            ClampVelocity();
+            m_store.SetVelocity(m_slot, a_vel.x, a_vel.y, a_vel.z);
         }
 
-        inline void SetVelocity(const NiPoint3& a_vel)
-        {
-            m_velocity.x = a_vel.x;
-            m_velocity.y = a_vel.y;
-            m_velocity.z = a_vel.z;
-            ClampVelocity();
+        inline void SetVelocity(const NiPoint3& a_vel) {
+            m_store.SetVelocity(m_slot, a_vel.x, a_vel.y, a_vel.z);
         }
 
         inline void SetVelocity2(const NiPoint3& a_vel, float a_timeStep) {
-            SetVelocity(m_velocity - (a_vel * a_timeStep));
+            SetVelocity(GetVelocity() - (a_vel * a_timeStep));
         }
 
-        [[nodiscard]] inline const auto& GetVelocity() const {
-            return m_velocity;
+        [[nodiscard]] inline NiPoint3 GetVelocity() const {
+            return m_store.GetVelocity(m_slot);
         }
 
         [[nodiscard]] inline const auto& GetConfig() const {
@@ -200,25 +241,28 @@ namespace CBP
         }
 
         inline void ResetOverrides() {
-            m_dampingMul = 1.0f;
-            m_inContact = false;
+            m_store.ResetOverrides(m_slot);
         }
 
-        [[nodiscard]] inline bool IsSameGroup(const SimComponent& a_rhs) const {
-            return a_rhs.m_groupId != 0 && m_groupId != 0 &&
-                a_rhs.m_parentId == m_parentId &&
-                a_rhs.m_groupId == m_groupId;
+        [[nodiscard]] inline bool Collides(const SimComponent& a_rhs) const {
+            return SphereWorld::Accepts(m_collisionFilter, a_rhs.m_collisionFilter,
+                m_parentId == a_rhs.m_parentId);
         }
 
-        inline void UpdateGroupInfo(uint64_t a_parentId, uint64_t a_groupId) {
-            m_parentId = a_parentId;
-            m_groupId = a_groupId;
-        };
+        void UpdateGroupInfo(uint64_t a_parentId, uint64_t a_groupId);
 
         [[nodiscard]] inline bool HasMovement() const {
             return m_movement;
         }
 
+        [[nodiscard]] inline SimStore::size_type GetSlot() const noexcept {
+            return m_slot;
+        }
+
+        [[nodiscard]] inline bool IsChildOf(const SimComponent& a_rhs) const {
+            return m_objParent == a_rhs.m_obj;
+        }
+
         [[nodiscard]] inline bool HasActiveCollider() const {
             return m_collisionData.IsActive();
         }
@@ -228,17 +272,42 @@ namespace CBP
         }
 
         inline void SetDampingMul(float a_val) {
-            m_dampingMul = a_val;
+            m_store.SetDampingMul(m_slot, a_val);
         }
 
         inline void SetInContact(bool a_val) {
-            m_inContact = a_val;
+            m_store.SetInContact(m_slot, a_val);
+        }
+
+        [[nodiscard]] inline bool IsPositionBased() const {
+            return m_store.IsPositionBased(m_slot);
+        }
+
+        inline void ProjectContact(const NiPoint3& a_correction, const NiPoint3& a_normal) {
+            m_store.ProjectContact(m_slot, a_correction, a_normal);
+        }
+
+        inline void Wake() {
+            m_store.Wake(m_slot);
         }
 
         [[nodiscard]] inline const auto& GetPos() const {
             return m_obj->m_worldTransform.pos;
         }
 
+        inline void AddContacts(uint32_t a_num) {
+            if (m_store.IsSamplingCosts())
+                m_cost.contacts += a_num;
+        }
+
+        [[nodiscard]] inline const auto& GetCostCounters() const noexcept {
+            return m_cost;
+        }
+
+        inline void ResetCostCounters() noexcept {
+            m_cost = costCounters_t{ 0, 0, 0, 0 };
+        }
+
 #ifdef _CBP_ENABLE_DEBUG
         [[nodiscard]] inline const auto& GetDebugInfo() const {
             return m_debugInfo;
@@ -0,0 +1,196 @@
+#include "pch.h"
+
+namespace CBP
+{
+    std::atomic<ITrace::State> ITrace::m_state = ITrace::State::kIdle;
+    std::atomic<std::uint32_t> ITrace::m_framesLeft = 0;
+    long long ITrace::m_startTime = 0;
+    std::uint32_t ITrace::m_mainTid = 0;
+    fs::path ITrace::m_path;
+
+    std::mutex ITrace::m_lock;
+    std::vector<std::unique_ptr<ITrace::threadBuffer_t>> ITrace::m_buffers;
+    std::atomic<std::uint32_t> ITrace::m_dropped = 0;
+
+    thread_local ITrace::threadBuffer_t* ITrace::m_threadBuffer = nullptr;
+
+    ITrace::ITraceLog ITrace::log;
+
+    ITrace::threadBuffer_t::threadBuffer_t(std::uint32_t a_tid) :
+        tid(a_tid),
+        count(0),
+        events(std::make_unique<event_t[]>(BUFFER_SIZE))
+    {
+    }
+
+    bool ITrace::Start(std::uint32_t a_frames)
+    {
+        if (!IsIdle())
+            return false;
+
+        char name[64];
+        _snprintf_s(name, _TRUNCATE, "%lld.json", static_cast<long long>(std::time(nullptr)));
+
+        m_path = fs::path(PLUGIN_CBP_TRACES_PATH) / name;
+
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            for (auto& e : m_buffers)
+                e->count.store(0, std::memory_order_relaxed);
+        }
+
+        m_dropped.store(0, std::memory_order_relaxed);
+        m_framesLeft.store(std::max(a_frames, 1U), std::memory_order_relaxed);
+
+        m_state.store(State::kArmed, std::memory_order_release);
+
+        return true;
+    }
+
+    void ITrace::OnFrameBegin()
+    {
+        auto state = m_state.load(std::memory_order_acquire);
+
+        if (state == State::kArmed)
+        {
+            m_mainTid = GetBuffer()->tid;
+            m_startTime = GetTime();
+            m_state.store(State::kCapturing, std::memory_order_release);
+
+            return;
+        }
+
+        if (state != State::kCapturing)
+            return;
+
+        if (m_framesLeft.fetch_sub(1, std::memory_order_relaxed) > 1)
+            return;
+
+        m_state.store(State::kWriting, std::memory_order_release);
+
+        std::thread(Write).detach();
+    }
+
+    ITrace::threadBuffer_t* ITrace::GetBuffer()
+    {
+        if (!m_threadBuffer)
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            m_buffers.emplace_back(std::make_unique<threadBuffer_t>(
+                static_cast<std::uint32_t>(m_buffers.size() + 1)));
+
+            m_threadBuffer = m_buffers.back().get();
+        }
+
+        return m_threadBuffer;
+    }
+
+    void ITrace::Add(
+        const char* a_name,
+        const char* a_cat,
+        long long a_start,
+        long long a_end,
+        TraceArg a_argType,
+        std::uint64_t a_arg)
+    {
+        auto buffer = GetBuffer();
+
+        auto n = buffer->count.load(std::memory_order_relaxed);
+        if (n >= BUFFER_SIZE)
+        {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        buffer->events[n] = event_t{ a_name, a_cat, a_start, a_end - a_start, a_arg, a_argType };
+
+        // publishes the event to the writer
+        buffer->count.store(n + 1, std::memory_order_release);
+    }
+
+    void ITrace::WriteEvent(std::ostream& a_out, const event_t& a_event, std::uint32_t a_tid)
+    {
+        char buffer[256];
+
+        _snprintf_s(buffer, _TRUNCATE,
+            ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+            a_event.name, a_event.cat, a_tid,
+            static_cast<double>(a_event.start - m_startTime) / 1000.0,
+            static_cast<double>(a_event.duration) / 1000.0);
+
+        a_out << buffer;
+
+        switch (a_event.argType)
+        {
+        case TraceArg::kHandle:
+            _snprintf_s(buffer, _TRUNCATE, ",\"args\":{\"handle\":\"%.16llX\"}",
+                static_cast<unsigned long long>(a_event.arg));
+            a_out << buffer;
+            break;
+        case TraceArg::kRecord:
+        {
+            auto type = static_cast<std::uint32_t>(a_event.arg);
+            _snprintf_s(buffer, _TRUNCATE, ",\"args\":{\"record\":\"%.4s\"}",
+                reinterpret_cast<const char*>(std::addressof(type)));
+            a_out << buffer;
+        }
+        break;
+        default:
+            break;
+        }
+
+        a_out << '}';
+    }
+
+    void ITrace::Write()
+    {
+        std::size_t numEvents = 0;
+
+        try
+        {
+            if (m_path.has_parent_path())
+                fs::create_directories(m_path.parent_path());
+
+            std::ofstream out;
+            out.open(m_path, std::ios_base::out | std::ios_base::trunc);
+            if (!out.is_open())
+                throw std::runtime_error("Could not open file for writing");
+
+            out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"" PLUGIN_NAME "\"}}";
+
+            std::lock_guard<std::mutex> lock(m_lock);
+
+            for (auto& e : m_buffers)
+            {
+                auto count = e->count.load(std::memory_order_acquire);
+                if (count == 0)
+                    continue;
+
+                out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << e->tid <<
+                    ",\"args\":{\"name\":\"" << (e->tid == m_mainTid ? "Main" : "Thread") << "\"}}";
+
+                for (std::uint32_t i = 0; i < count; i++)
+                    WriteEvent(out, e->events[i], e->tid);
+
+                numEvents += count;
+            }
+
+            out << "\n]}\n";
+
+            if (!out)
+                throw std::runtime_error("Write failed");
+
+            log.Message("%s: %zu events written to %s (%u dropped)", __FUNCTION__,
+                numEvents, m_path.string().c_str(), m_dropped.load(std::memory_order_relaxed));
+        }
+        catch (const std::exception& e)
+        {
+            log.Error("%s: %s", __FUNCTION__, e.what());
+        }
+
+        m_state.store(State::kIdle, std::memory_order_release);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#pragma once
+
+namespace CBP
+{
+    enum class TraceArg : std::uint8_t
+    {
+        kNone,
+        kHandle,
+        kRecord
+    };
+
+    // Captures a number of physics frames as Chrome/Perfetto trace-event JSON. Events go to
+    // a buffer owned by the emitting thread (no locking, single writer), the capture is
+    // written out by a separate thread once the last frame is done.
+    class ITrace
+    {
+        class ITraceLog
+            : public ILog
+        {
+        public:
+            FN_NAMEPROC("ITrace");
+        };
+
+        // events per thread and capture, the rest are dropped
+        static constexpr std::uint32_t BUFFER_SIZE = 1U << 16;
+
+        enum class State : std::uint32_t
+        {
+            kIdle,
+            kArmed,
+            kCapturing,
+            kWriting
+        };
+
+        struct event_t
+        {
+            const char* name;
+            const char* cat;
+            long long start;
+            long long duration;
+            std::uint64_t arg;
+            TraceArg argType;
+        };
+
+        struct threadBuffer_t
+        {
+            threadBuffer_t(std::uint32_t a_tid);
+
+            std::uint32_t tid;
+            std::atomic<std::uint32_t> count;
+            std::unique_ptr<event_t[]> events;
+        };
+
+    public:
+        // capture starts with the next frame, false if one is already in progress
+        static bool Start(std::uint32_t a_frames);
+
+        // called at the start of each PhysicsTick
+        static void OnFrameBegin();
+
+        static void Add(
+            const char* a_name,
+            const char* a_cat,
+            long long a_start,
+            long long a_end,
+            TraceArg a_argType = TraceArg::kNone,
+            std::uint64_t a_arg = 0);
+
+        [[nodiscard]] inline static bool IsCapturing() noexcept {
+            return m_state.load(std::memory_order_relaxed) == State::kCapturing;
+        }
+
+        [[nodiscard]] inline static bool IsIdle() noexcept {
+            return m_state.load(std::memory_order_relaxed) == State::kIdle;
+        }
+
+        [[nodiscard]] inline static bool IsWriting() noexcept {
+            return m_state.load(std::memory_order_relaxed) == State::kWriting;
+        }
+
+        [[nodiscard]] inline static std::uint32_t GetFramesLeft() noexcept {
+            return m_framesLeft.load(std::memory_order_relaxed);
+        }
+
+        // ns
+        [[nodiscard]] inline static long long GetTime() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+    private:
+        static threadBuffer_t* GetBuffer();
+
+        static void Write();
+        static void WriteEvent(std::ostream& a_out, const event_t& a_event, std::uint32_t a_tid);
+
+        static std::atomic<State> m_state;
+        static std::atomic<std::uint32_t> m_framesLeft;
+        static long long m_startTime;
+        static std::uint32_t m_mainTid;
+        static fs::path m_path;
+
+        static std::mutex m_lock;
+        static std::vector<std::unique_ptr<threadBuffer_t>> m_buffers;
+        static std::atomic<std::uint32_t> m_dropped;
+
+        static thread_local threadBuffer_t* m_threadBuffer;
+
+        static ITraceLog log;
+    };
+
+    class TraceScope
+    {
+    public:
+        inline TraceScope(
+            const char* a_name,
+            const char* a_cat,
+            TraceArg a_argType = TraceArg::kNone,
+            std::uint64_t a_arg = 0)
+            :
+            m_name(a_name),
+            m_cat(a_cat),
+            m_arg(a_arg),
+            m_argType(a_argType),
+            m_active(ITrace::IsCapturing())
+        {
+            if (m_active)
+                m_start = ITrace::GetTime();
+        }
+
+        inline ~TraceScope()
+        {
+            if (m_active)
+                ITrace::Add(m_name, m_cat, m_start, ITrace::GetTime(), m_argType, m_arg);
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        const char* m_name;
+        const char* m_cat;
+        long long m_start = 0;
+        std::uint64_t m_arg;
+        TraceArg m_argType;
+        bool m_active;
+    };
+
+#define CBP_TRACE_SCOPE(a_name, a_cat) ::CBP::TraceScope _traceScope(a_name, a_cat)
+#define CBP_TRACE_SCOPE_ARG(a_name, a_cat, a_argType, a_arg) ::CBP::TraceScope _traceScope(a_name, a_cat, ::CBP::TraceArg::a_argType, a_arg)
+}
\ No newline at end of file
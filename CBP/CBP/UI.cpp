@@ -19,7 +19,30 @@ namespace CBP
         {MiscHelpText::importDialog, "Import and apply actor, race and global settings from the selected file."},
         {MiscHelpText::exportDialog, "Export actor, race and global settings."},
         {MiscHelpText::simRate, "If this value isn't equal to framerate the simulation speed is affected. Adjust timeTick to get proper results."},
-        {MiscHelpText::armorOverrides, ""}
+        {MiscHelpText::armorOverrides, ""},
+        {MiscHelpText::numThreads, "Number of worker threads used to simulate nodes alongside the game thread. 0 runs everything on the game thread."},
+        {MiscHelpText::sleeping, "Stop simulating nodes that have settled until something moves them again."},
+        {MiscHelpText::sleepVelocity, "Nodes moving slower than this may go to sleep."},
+        {MiscHelpText::sleepOffset, "Maximum change of a node's offset per step for it to be considered settled."},
+        {MiscHelpText::sleepSteps, "Number of consecutive settled steps before a node goes to sleep."},
+        {MiscHelpText::wakeDistance, "Wake sleeping nodes when their parent moves further than this."},
+        {MiscHelpText::wakeContactDepth, "Wake sleeping nodes on contacts deeper than this."},
+        {MiscHelpText::lod, "Reduce the simulation rate of actors further away from the camera."},
+        {MiscHelpText::lodMidDistance, "Actors further away than this are updated at a reduced rate."},
+        {MiscHelpText::lodFarDistance, "Actors further away than this are frozen in their rest pose and don't collide."},
+        {MiscHelpText::lodMidInterval, "Mid range actors are updated every Nth step with a proportionally larger time step."},
+        {MiscHelpText::budget, "Time per frame (us) the simulation may spend. Actors are simulated in order of priority (player, selected actor, on-screen, distance), the rest catch up on later frames. 0 = unlimited."},
+        {MiscHelpText::pbdIterations, "Constraint solver iterations per step for nodes using the position based integrator."},
+        {MiscHelpText::integratorBenchmark, "Steps a stiff spring (stiffness 100/100) at 30 Hz with each integrator and compares it against a finely stepped reference."},
+        {MiscHelpText::motionRecording, "Records the animated parents of simulated nodes, frame times and config changes to Data\\SKSE\\Plugins\\CBP\\Recordings for replaying in the headless host. Starting a recording re-adds all actors."},
+        {MiscHelpText::traceCapture, "Writes the physics phases, queued tasks, co-save records and armor override loads of the next N frames to Data\\SKSE\\Plugins\\CBP\\Traces as Chrome trace events (chrome://tracing, ui.perfetto.dev)."},
+        {MiscHelpText::costAttribution, "Per actor and config group node steps, integration time, contact points (per sampled frame) and the deepest force queue seen, averaged over the profiling interval. Integration time is measured per batch of nodes and split evenly between them, collision detection is only reflected in contacts. (AO) marks actors with an armor override."},
+        {MiscHelpText::collisionBackend, "Spheres: sweep and prune over the node spheres, built for sphere-only colliders. ReactPhysics3D: general purpose physics world, kept as a fallback. Switching recreates all colliders."},
+        {MiscHelpText::collisionIslands, "Actors whose collider bounds overlap are grouped into islands, colliders are only tested against others in the same island. Close pairs counts actors with overlapping bounds. Spheres backend only."},
+        {MiscHelpText::collisionInterval, "Full collision detection runs every Nth step. In between only the pairs found by the last detection are re-tested and pushed apart, new contacts are picked up late. Spheres backend only."},
+        {MiscHelpText::collisionFiltered, "Overlapping collider pairs dropped in the last update because neither node moves or both belong to the same actor and collision group. Spheres backend only."},
+        {MiscHelpText::colliderPool, "Collision bodies kept for reuse after their node collider was removed, bodies in use and the share of colliders that got a pooled body. reactphysics3d backend only."},
+        {MiscHelpText::collisionBenchmark, "Updates 2000 randomly placed spheres with both collision backends for 100 frames and reports the time per update and the overlapping pairs found."}
         });
 
     static const keyDesc_t comboKeyDesc({
@@ -1588,6 +1611,26 @@ namespace CBP
                 if (CheckboxGlobal("Enable collisions", &globalConfig.phys.collisions))
                     DCBP::ResetActors();
 
+                auto backend = static_cast<ICollision::Backend>(globalConfig.phys.collisionBackend);
+
+                if (ImGui::BeginCombo("Collision backend", ICollision::GetBackendName(backend)))
+                {
+                    for (auto e : { ICollision::Backend::kSpheres, ICollision::Backend::kReactPhysics })
+                    {
+                        if (ImGui::Selectable(ICollision::GetBackendName(e), e == backend) && e != backend)
+                        {
+                            globalConfig.phys.collisionBackend = Enum::Underlying(e);
+                            DCBP::MarkGlobalsForSave();
+                            DCBP::ResetActors();
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+                HelpMarker(MiscHelpText::collisionBackend);
+
+                SliderIntGlobal("Collision interval", &globalConfig.phys.collisionInterval, 1, 4);
+                HelpMarker(MiscHelpText::collisionInterval);
+
                 ImGui::Spacing();
 
                 float timeTick = 1.0f / globalConfig.phys.timeTick;
@@ -1602,6 +1645,58 @@ namespace CBP
                 SliderFloatGlobal("Max. penetration depth", &globalConfig.phys.colMaxPenetrationDepth, 0.5f, 100.0f);
                 HelpMarker(MiscHelpText::colMaxPenetrationDepth);
 
+                SliderIntGlobal("Worker threads", &globalConfig.phys.numThreads, 0,
+                    static_cast<int>(std::min(std::max(std::thread::hardware_concurrency(), 1U) - 1, WorkerPool::MAX_WORKERS)));
+                HelpMarker(MiscHelpText::numThreads);
+
+                ImGui::Spacing();
+
+                CheckboxGlobal("Sleeping", &globalConfig.phys.sleeping);
+                HelpMarker(MiscHelpText::sleeping);
+
+                if (globalConfig.phys.sleeping)
+                {
+                    SliderFloatGlobal("Sleep velocity", &globalConfig.phys.sleepVelocity, 0.0f, 10.0f, "%.3f");
+                    HelpMarker(MiscHelpText::sleepVelocity);
+
+                    SliderFloatGlobal("Sleep offset", &globalConfig.phys.sleepOffset, 0.0f, 1.0f, "%.3f");
+                    HelpMarker(MiscHelpText::sleepOffset);
+
+                    SliderIntGlobal("Sleep steps", &globalConfig.phys.sleepSteps, 1, 600);
+                    HelpMarker(MiscHelpText::sleepSteps);
+
+                    SliderFloatGlobal("Wake distance", &globalConfig.phys.wakeDistance, 0.0f, 5.0f, "%.3f");
+                    HelpMarker(MiscHelpText::wakeDistance);
+
+                    SliderFloatGlobal("Wake contact depth", &globalConfig.phys.wakeContactDepth, 0.0f, 10.0f, "%.3f");
+                    HelpMarker(MiscHelpText::wakeContactDepth);
+                }
+
+                ImGui::Spacing();
+
+                CheckboxGlobal("Distance LOD", &globalConfig.phys.lod);
+                HelpMarker(MiscHelpText::lod);
+
+                if (globalConfig.phys.lod)
+                {
+                    SliderFloatGlobal("Mid distance", &globalConfig.phys.lodMidDistance, 100.0f, 10000.0f, "%.0f");
+                    HelpMarker(MiscHelpText::lodMidDistance);
+
+                    SliderFloatGlobal("Far distance", &globalConfig.phys.lodFarDistance, 100.0f, 20000.0f, "%.0f");
+                    HelpMarker(MiscHelpText::lodFarDistance);
+
+                    SliderIntGlobal("Mid interval", &globalConfig.phys.lodMidInterval, 1, 8);
+                    HelpMarker(MiscHelpText::lodMidInterval);
+                }
+
+                ImGui::Spacing();
+
+                SliderIntGlobal("Budget (us)", &globalConfig.phys.budget, 0, 10000);
+                HelpMarker(MiscHelpText::budget);
+
+                SliderIntGlobal("PBD iterations", &globalConfig.phys.pbdIterations, 1, 20);
+                HelpMarker(MiscHelpText::pbdIterations);
+
                 ImGui::Spacing();
             }
 
@@ -2478,6 +2573,17 @@ namespace CBP
                 ImGui::Text("Sim. rate:");
                 HelpMarker(MiscHelpText::simRate);
                 ImGui::Text("Actors:");
+                ImGui::Text("Nodes (awake/sleeping):");
+                ImGui::Text("Budget:");
+                ImGui::Text("Deferred actors:");
+                ImGui::Text("Dropped forces:");
+                ImGui::Text("Node writes/frame:");
+                ImGui::Text("Collision islands:");
+                HelpMarker(MiscHelpText::collisionIslands);
+                ImGui::Text("Filtered pairs:");
+                HelpMarker(MiscHelpText::collisionFiltered);
+                ImGui::Text("Collider pool:");
+                HelpMarker(MiscHelpText::colliderPool);
 
                 ImGui::NextColumn();
 
@@ -2486,9 +2592,110 @@ namespace CBP
                 ImGui::Text("%lld", stats.avgStepsPerUpdate > 0
                     ? stats.avgStepRate / stats.avgStepsPerUpdate : 0);
                 ImGui::Text("%u", stats.avgActorCount);
+                ImGui::Text("%u/%u", stats.avgAwakeCount, stats.avgSleepingCount);
+
+                if (globalConfig.phys.budget > 0)
+                    ImGui::Text("%d us", globalConfig.phys.budget);
+                else
+                    ImGui::TextUnformatted("unlimited");
+
+                ImGui::Text("%u", stats.avgDeferredCount);
+                ImGui::Text("%u", DCBP::GetUpdateTask().GetSimStore().GetDroppedForces());
+                ImGui::Text("%u", DCBP::GetUpdateTask().GetSimStore().GetNodeWrites());
+
+                if (globalConfig.phys.collisions &&
+                    ICollision::GetBackend() == ICollision::Backend::kSpheres)
+                {
+                    auto& colStats = DCBP::GetSphereWorld().GetStats();
+                    ImGui::Text("%u (%u actors, %u close pairs)",
+                        colStats.islands, colStats.owners, colStats.ownerPairs);
+                    ImGui::Text("%u", colStats.rejected);
+                }
+                else
+                {
+                    ImGui::TextUnformatted("n/a");
+                    ImGui::TextUnformatted("n/a");
+                }
+
+                if (ICollision::GetBackend() == ICollision::Backend::kReactPhysics)
+                {
+                    auto& poolStats = ICollision::GetPoolStats();
+                    ImGui::Text("%u free, %u used (%.1f%% hits)",
+                        poolStats.free, poolStats.used, poolStats.acquired > 0 ?
+                        static_cast<double>(poolStats.hits) * 100.0 / static_cast<double>(poolStats.acquired) : 0.0);
+                }
+                else
+                    ImGui::TextUnformatted("n/a");
 
                 ImGui::Columns(1);
 
+#ifdef _CBP_ENABLE_PROFILING_ZONES
+                static const std::string chZonesKey("Stats#Zones");
+
+                if (CollapsingHeader(chZonesKey, "Phases (us)"))
+                {
+                    auto& zones = IProfileZones::GetStats();
+
+                    ImGui::Columns(7, nullptr, false);
+                    ImGui::SetColumnWidth(0, ImGui::GetFontSize() * 11.0f);
+
+                    ImGui::TextUnformatted("Zone");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("Calls");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("Min");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("p50");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("p95");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("p99");
+                    ImGui::NextColumn();
+                    ImGui::TextUnformatted("Max");
+                    ImGui::NextColumn();
+
+                    ImGui::Separator();
+
+                    for (uint32_t i = 0; i < Enum::Underlying(ProfileZone::kMax); i++)
+                    {
+                        auto zone = static_cast<ProfileZone>(i);
+                        auto& e = zones[i];
+
+                        auto indent = static_cast<float>(IProfileZones::GetDepth(zone)) * ImGui::GetFontSize();
+
+                        if (indent > 0.0f)
+                            ImGui::Indent(indent);
+
+                        ImGui::TextUnformatted(IProfileZones::GetName(zone));
+
+                        if (indent > 0.0f)
+                            ImGui::Unindent(indent);
+
+                        ImGui::NextColumn();
+
+                        ImGui::Text("%u", e.count);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(e.min) / 1000.0);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(e.p50) / 1000.0);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(e.p95) / 1000.0);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(e.p99) / 1000.0);
+                        ImGui::NextColumn();
+                        ImGui::Text("%.1f", static_cast<double>(e.max) / 1000.0);
+                        ImGui::NextColumn();
+                    }
+
+                    ImGui::Columns(1);
+                }
+#endif
+
+                static const std::string chCostsKey("Stats#Costs");
+
+                if (CollapsingHeader(chCostsKey, "Costs"))
+                    DrawCosts();
+
                 if (globalConfig.debugRenderer.enabled)
                 {
                     ImGui::Spacing();
@@ -2517,6 +2724,139 @@ namespace CBP
 
                 ImGui::PopItemWidth();
             }
+
+            static const std::string chKernelKey("Stats#Kernel");
+
+            if (CollapsingHeader(chKernelKey, "Kernel"))
+            {
+                ImGui::Text("Active: %s", ISimKernel::GetKernelName(ISimKernel::GetKernelType()));
+
+                if (ImGui::Button("Benchmark"))
+                {
+                    ISimKernel::Benchmark(4096, 200, m_benchmark);
+                    m_hasBenchmark = true;
+                }
+
+                if (m_hasBenchmark)
+                {
+                    ImGui::Columns(2, nullptr, false);
+
+                    for (std::size_t i = 0; i < m_benchmark.size(); i++)
+                        ImGui::Text("%s:", ISimKernel::GetKernelName(static_cast<ISimKernel::KernelType>(i)));
+
+                    ImGui::NextColumn();
+
+                    for (auto& e : m_benchmark)
+                    {
+                        if (e.supported)
+                            ImGui::Text("%.2f ns/node", e.nsPerNode);
+                        else
+                            ImGui::TextUnformatted("n/a");
+                    }
+
+                    ImGui::Columns(1);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Compare integrators"))
+                {
+                    ISimKernel::BenchmarkIntegrators(256, 1.0f / 30.0f,
+                        static_cast<std::uint32_t>(std::max(globalConfig.phys.pbdIterations, 1)), m_integratorBenchmark);
+                    m_hasIntegratorBenchmark = true;
+                }
+                HelpMarker(MiscHelpText::integratorBenchmark);
+
+                if (m_hasIntegratorBenchmark)
+                {
+                    ImGui::Columns(2, nullptr, false);
+
+                    for (std::size_t i = 0; i < m_integratorBenchmark.size(); i++)
+                        ImGui::Text("%s:", ISimKernel::GetIntegratorName(static_cast<ISimKernel::IntegratorType>(i)));
+
+                    ImGui::NextColumn();
+
+                    for (auto& e : m_integratorBenchmark)
+                    {
+                        if (e.stable)
+                            ImGui::Text("%.2f ns/node, error %.3f, peak %.2f", e.nsPerNode, e.error, e.peak);
+                        else
+                            ImGui::Text("%.2f ns/node, unstable", e.nsPerNode);
+                    }
+
+                    ImGui::Columns(1);
+                }
+
+                ImGui::Spacing();
+
+                if (ImGui::Button("Compare collision backends"))
+                {
+                    ICollision::Benchmark(2000, 100, m_collisionBenchmark);
+                    m_hasCollisionBenchmark = true;
+                }
+                HelpMarker(MiscHelpText::collisionBenchmark);
+
+                if (m_hasCollisionBenchmark)
+                {
+                    ImGui::Columns(2, nullptr, false);
+
+                    for (std::size_t i = 0; i < m_collisionBenchmark.size(); i++)
+                        ImGui::Text("%s:", ICollision::GetBackendName(static_cast<ICollision::Backend>(i)));
+
+                    ImGui::NextColumn();
+
+                    for (auto& e : m_collisionBenchmark)
+                        ImGui::Text("%.1f us, %.0f pairs", e.time, e.pairs);
+
+                    ImGui::Columns(1);
+                }
+            }
+
+            static const std::string chRecordingKey("Stats#Recording");
+
+            if (CollapsingHeader(chRecordingKey, "Recording"))
+            {
+                auto& recorder = DCBP::GetUpdateTask().GetRecorder();
+
+                if (recorder.IsRecording())
+                {
+                    if (ImGui::Button("Stop"))
+                        DCBP::StopRecording();
+
+                    ImGui::SameLine();
+                    ImGui::Text("%llu frames", recorder.GetFrames());
+                }
+                else
+                {
+                    if (ImGui::Button("Record"))
+                        DCBP::StartRecording();
+                }
+                HelpMarker(MiscHelpText::motionRecording);
+            }
+
+            static const std::string chTraceKey("Stats#Trace");
+
+            if (CollapsingHeader(chTraceKey, "Trace"))
+            {
+                ImGui::PushItemWidth(ImGui::GetFontSize() * -8.0f);
+
+                SliderIntGlobal("Frames", &globalConfig.general.traceFrames, 1, 3000);
+
+                ImGui::PopItemWidth();
+
+                if (ITrace::IsIdle())
+                {
+                    if (ImGui::Button("Capture"))
+                        ITrace::Start(static_cast<std::uint32_t>(
+                            std::max(globalConfig.general.traceFrames, 1)));
+                }
+                else if (ITrace::IsWriting())
+                    ImGui::TextUnformatted("Writing...");
+                else
+                    ImGui::Text("%u frames left", ITrace::GetFramesLeft());
+
+                HelpMarker(MiscHelpText::traceCapture);
+            }
         }
 
         ImGui::End();
@@ -2524,6 +2864,121 @@ namespace CBP
         ImGui::PopID();
     }
 
+    void UIProfiling::DrawCostHeader(const char* a_label, CostColumn a_column)
+    {
+        if (ImGui::Selectable(a_label, m_costSort == a_column))
+            m_costSort = a_column;
+
+        ImGui::NextColumn();
+    }
+
+    void UIProfiling::DrawCosts()
+    {
+        auto& globalConfig = IConfig::GetGlobalConfig();
+
+        ImGui::PushItemWidth(ImGui::GetFontSize() * -8.0f);
+
+        if (CheckboxGlobal("Enabled", &globalConfig.general.costAttribution))
+            DCBP::ResetProfiler();
+        HelpMarker(MiscHelpText::costAttribution);
+
+        SliderIntGlobal("Sample every N frames", &globalConfig.general.costSampleInterval, 1, 60);
+
+        ImGui::PopItemWidth();
+
+        if (!globalConfig.general.costAttribution)
+            return;
+
+        ImGui::RadioButton("Actors", &m_costView, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("Config groups", &m_costView, 1);
+
+        auto& costs = DCBP::GetUpdateTask().GetCostProfiler();
+
+        m_costRows.clear();
+
+        if (m_costView == 0)
+        {
+            for (auto& e : costs.GetActors())
+            {
+                std::string name;
+                if (!IData::GetActorName(e.first, name))
+                {
+                    std::ostringstream ss;
+                    ss << "[" << std::uppercase << std::setfill('0') <<
+                        std::setw(8) << std::hex << (e.first & 0xFFFFFFFF) << "]";
+                    name = ss.str();
+                }
+
+                if (IConfig::HasArmorOverride(e.first))
+                    name += " (AO)";
+
+                m_costRows.emplace_back(std::move(name), e.second);
+            }
+        }
+        else
+        {
+            for (auto& e : costs.GetGroups())
+                m_costRows.emplace_back(e.first, e.second);
+        }
+
+        auto key = [this](const CostProfiler::entry_t& a_entry)
+        {
+            switch (m_costSort)
+            {
+            case CostColumn::kSteps:
+                return a_entry.steps;
+            case CostColumn::kContacts:
+                return a_entry.contacts;
+            case CostColumn::kForces:
+                return static_cast<float>(a_entry.maxForces);
+            default:
+                return a_entry.time;
+            }
+        };
+
+        std::sort(m_costRows.begin(), m_costRows.end(),
+            [&](const auto& a_lhs, const auto& a_rhs) {
+                return key(a_lhs.second) > key(a_rhs.second);
+            });
+
+        ImGui::Text("%u sampled frames", costs.GetSamples());
+
+        ImGui::Columns(5, nullptr, false);
+        ImGui::SetColumnWidth(0, ImGui::GetFontSize() * 14.0f);
+
+        ImGui::TextUnformatted(m_costView == 0 ? "Actor" : "Group");
+        ImGui::NextColumn();
+
+        DrawCostHeader("Time (us)", CostColumn::kTime);
+        DrawCostHeader("Steps", CostColumn::kSteps);
+        DrawCostHeader("Contacts", CostColumn::kContacts);
+        DrawCostHeader("Forces", CostColumn::kForces);
+
+        ImGui::Separator();
+
+        // top offenders only
+        auto num = std::min(m_costRows.size(), std::size_t(20));
+
+        for (std::size_t i = 0; i < num; i++)
+        {
+            auto& e = m_costRows[i];
+
+            ImGui::TextUnformatted(e.first.c_str());
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", e.second.time);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", e.second.steps);
+            ImGui::NextColumn();
+            ImGui::Text("%.1f", e.second.contacts);
+            ImGui::NextColumn();
+            ImGui::Text("%u", e.second.maxForces);
+            ImGui::NextColumn();
+        }
+
+        ImGui::Columns(1);
+    }
+
 #ifdef _CBP_ENABLE_DEBUG
 
     const char* UIDebugInfo::ParseFloat(float v)
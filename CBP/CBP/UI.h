@@ -86,7 +86,30 @@ namespace CBP
         importDialog,
         exportDialog,
         simRate,
-        armorOverrides
+        armorOverrides,
+        numThreads,
+        sleeping,
+        sleepVelocity,
+        sleepOffset,
+        sleepSteps,
+        wakeDistance,
+        wakeContactDepth,
+        lod,
+        lodMidDistance,
+        lodFarDistance,
+        lodMidInterval,
+        budget,
+        pbdIterations,
+        integratorBenchmark,
+        motionRecording,
+        traceCapture,
+        costAttribution,
+        collisionBackend,
+        collisionBenchmark,
+        collisionIslands,
+        collisionFiltered,
+        collisionInterval,
+        colliderPool
     };
 
     typedef std::pair<const std::string, configComponents_t> actorEntryBaseConf_t;
@@ -573,6 +596,28 @@ namespace CBP
     {
     public:
         void Draw(bool* a_active);
+    private:
+        enum class CostColumn : int
+        {
+            kTime,
+            kSteps,
+            kContacts,
+            kForces
+        };
+
+        void DrawCosts();
+        void DrawCostHeader(const char* a_label, CostColumn a_column);
+
+        bool m_hasBenchmark = false;
+        ISimKernel::benchmarkResults_t m_benchmark;
+        bool m_hasIntegratorBenchmark = false;
+        ISimKernel::integratorResults_t m_integratorBenchmark;
+        bool m_hasCollisionBenchmark = false;
+        ICollision::benchmarkResults_t m_collisionBenchmark;
+
+        int m_costView = 0;
+        CostColumn m_costSort = CostColumn::kTime;
+        std::vector<std::pair<std::string, CostProfiler::entry_t>> m_costRows;
     };
 
 #ifdef _CBP_ENABLE_DEBUG
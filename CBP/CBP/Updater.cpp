@@ -16,9 +16,56 @@ namespace CBP
 
     std::atomic<uint64_t> UpdateTask::m_nextGroupId = 0;
 
+    const char* UTTask::GetActionName(UTTAction a_action)
+    {
+        switch (a_action)
+        {
+        case UTTAction::Add:
+            return "Add";
+        case UTTAction::Remove:
+            return "Remove";
+        case UTTAction::UpdateConfig:
+            return "UpdateConfig";
+        case UTTAction::UpdateConfigAll:
+            return "UpdateConfigAll";
+        case UTTAction::Reset:
+            return "Reset";
+        case UTTAction::UIUpdateCurrentActor:
+            return "UIUpdateCurrentActor";
+        case UTTAction::UpdateGroupInfoAll:
+            return "UpdateGroupInfoAll";
+        case UTTAction::PhysicsReset:
+            return "PhysicsReset";
+        case UTTAction::NiNodeUpdate:
+            return "NiNodeUpdate";
+        case UTTAction::NiNodeUpdateAll:
+            return "NiNodeUpdateAll";
+        case UTTAction::WeightUpdate:
+            return "WeightUpdate";
+        case UTTAction::WeightUpdateAll:
+            return "WeightUpdateAll";
+        case UTTAction::AddArmorOverride:
+            return "AddArmorOverride";
+        case UTTAction::UpdateArmorOverride:
+            return "UpdateArmorOverride";
+        case UTTAction::UpdateArmorOverridesAll:
+            return "UpdateArmorOverridesAll";
+        case UTTAction::ClearArmorOverrides:
+            return "ClearArmorOverrides";
+        case UTTAction::StartRecording:
+            return "StartRecording";
+        case UTTAction::StopRecording:
+            return "StopRecording";
+        default:
+            return "Unknown";
+        }
+    }
+
     UpdateTask::UpdateTask() :
         m_timeAccum(0.0f),
-        m_averageInterval(1.0f / 60.0f),
+        m_collisionStep(0),
+        m_nodeCost(1.0f),
+        m_deferredCount(0),
         m_profiler(1000000),
         m_markedActor(0)
     {
@@ -26,6 +73,8 @@ namespace CBP
 
     void UpdateTask::UpdateDebugRenderer()
     {
+        CBP_PROFILE_ZONE(kDebugRenderer);
+
         auto& globalConf = IConfig::GetGlobalConfig();
 
         if (globalConf.debugRenderer.enabled &&
@@ -45,70 +94,226 @@ namespace CBP
                         m_markedActor);
                 }
 
-                renderer->Update(
-                    DCBP::GetWorld()->getDebugRenderer());
+                if (ICollision::GetBackend() == ICollision::Backend::kSpheres)
+                    renderer->UpdateSpheres(DCBP::GetSphereWorld());
+                else
+                    renderer->Update(
+                        DCBP::GetWorld()->getDebugRenderer());
             }
             catch (...) {}
         }
     }
 
-    void UpdateTask::UpdatePhase1()
+    bool UpdateTask::GetViewPoint(NiPoint3& a_pos, NiPoint3& a_forward)
     {
-        for (auto& e : m_actors)
-            e.second.UpdateVelocity();
+        auto camera = PlayerCamera::GetSingleton();
+        if (camera && camera->cameraNode) {
+            auto& tf = camera->cameraNode->m_worldTransform;
+
+            a_pos = tf.pos;
+            a_forward = NiPoint3(tf.rot.data[0][1], tf.rot.data[1][1], tf.rot.data[2][1]);
+
+            return true;
+        }
+
+        auto player = *g_thePlayer;
+        if (player && player->loadedState) {
+            a_pos = player->pos;
+            a_forward = NiPoint3();
+
+            return true;
+        }
+
+        return false;
     }
 
-    void UpdateTask::UpdateActorsPhase2(float a_timeStep)
+    void UpdateTask::UpdateLOD()
     {
+        auto& phys = IConfig::GetGlobalConfig().phys;
+
+        NiPoint3 origin, forward;
+        bool enabled = phys.lod && GetViewPoint(origin, forward);
+
+        auto midInterval = static_cast<uint32_t>(std::max(phys.lodMidInterval, 1));
+
         for (auto& e : m_actors)
-            e.second.UpdateMovement(a_timeStep);
+        {
+            if (!enabled) {
+                e.second.SetLOD(LODTier::Near, 1);
+                continue;
+            }
+
+            auto tier = e.second.GetLODTier();
+
+            // actors have to come 10% closer to move up a tier so they don't flicker on the boundary
+            float midDist = phys.lodMidDistance * (tier != LODTier::Near ? 0.9f : 1.0f);
+            float farDist = phys.lodFarDistance * (tier == LODTier::Far ? 0.9f : 1.0f);
+
+            auto d = e.second.GetActor()->pos - origin;
+            float distSq = d.x * d.x + d.y * d.y + d.z * d.z;
+
+            if (distSq >= farDist * farDist)
+                e.second.SetLOD(LODTier::Far, 1);
+            else if (distSq >= midDist * midDist)
+                e.second.SetLOD(LODTier::Mid, midInterval);
+            else
+                e.second.SetLOD(LODTier::Near, 1);
+        }
     }
 
-    uint32_t UpdateTask::UpdatePhase2(float a_timeStep, float a_timeTick, float a_maxTime)
+    uint32_t UpdateTask::ScheduleActors(uint32_t a_steps)
     {
-        uint32_t c = 1;
+        auto& phys = IConfig::GetGlobalConfig().phys;
 
-        while (a_timeStep >= a_maxTime)
+        if (phys.budget <= 0)
         {
-            UpdateActorsPhase2(a_timeTick);
-            a_timeStep -= a_timeTick;
+            for (auto& e : m_actors)
+                e.second.SetDeferred(false);
+
+            return 0;
+        }
+
+        NiPoint3 origin, forward;
+        bool hasView = GetViewPoint(origin, forward);
+
+        Actor* player = *g_thePlayer;
+
+        m_schedule.clear();
+
+        for (auto& e : m_actors)
+        {
+            auto& obj = e.second;
+
+            if (obj.GetLODTier() == LODTier::Far) {
+                obj.SetDeferred(false);
+                continue;
+            }
+
+            Actor* actor = obj.GetActor();
+
+            float priority;
+
+            if (actor == player || e.first == m_markedActor)
+                priority = -1.0f;
+            else if (hasView)
+            {
+                auto d = actor->pos - origin;
+                float dist = std::sqrt(d.x * d.x + d.y * d.y + d.z * d.z);
+
+                priority = dist;
+
+                // roughly outside a 120 degree cone in front of the camera
+                if (d.x * forward.x + d.y * forward.y + d.z * forward.z < dist * 0.5f)
+                    priority *= 2.0f;
+
+                // actors that were held back move up so they aren't starved
+                priority /= static_cast<float>(obj.GetDeferredFrames() + 1);
+            }
+            else
+                priority = 0.0f;
+
+            m_schedule.emplace_back(priority, std::addressof(obj));
+        }
+
+        std::sort(m_schedule.begin(), m_schedule.end(),
+            [](const auto& a_lhs, const auto& a_rhs) {
+                return a_lhs.first < a_rhs.first; });
+
+        float budget = static_cast<float>(phys.budget);
+        float used = 0.0f;
+        uint32_t deferred = 0;
 
-            c++;
+        for (auto& e : m_schedule)
+        {
+            float cost = static_cast<float>(e.second->GetNumAwake() * a_steps) * m_nodeCost;
+
+            // always let at least one actor through
+            if (used > 0.0f && used + cost > budget)
+            {
+                e.second->SetDeferred(true);
+                deferred++;
+            }
+            else
+            {
+                e.second->SetDeferred(false);
+                used += cost;
+            }
         }
 
-        UpdateActorsPhase2(a_timeStep);
+        return deferred;
+    }
+
+    void UpdateTask::UpdatePhase1()
+    {
+        CBP_PROFILE_ZONE(kPhase1);
 
-        return c;
+        m_store.UpdateVelocity(m_workers);
     }
 
-    uint32_t UpdateTask::UpdatePhase2Collisions(float a_timeStep, float a_timeTick, float a_maxTime)
+    void UpdateTask::UpdateActorsPhase2(float a_timeStep)
     {
-        uint32_t c = 1;
+        CBP_PROFILE_ZONE(kPhase2);
 
-        auto world = DCBP::GetWorld();
+        m_store.UpdateMovement(a_timeStep, m_workers);
+    }
 
-        bool debugRendererEnabled = world->getIsDebugRenderingEnabled();
-        world->setIsDebugRenderingEnabled(false);
+    void UpdateTask::UpdatePhase2(float a_timeTick, uint32_t a_steps)
+    {
+        for (uint32_t i = 0; i < a_steps; i++)
+            UpdateActorsPhase2(a_timeTick);
+    }
 
+    void UpdateTask::UpdatePhase2Collisions(float a_timeTick, uint32_t a_steps)
+    {
         ICollision::SetTimeStep(a_timeTick);
 
-        while (a_timeStep >= a_maxTime)
+        if (ICollision::GetBackend() == ICollision::Backend::kSpheres)
         {
-            UpdateActorsPhase2(a_timeTick);
-            world->update(a_timeTick);
-            a_timeStep -= a_timeTick;
+            auto& world = DCBP::GetSphereWorld();
+
+            auto interval = static_cast<uint32_t>(
+                std::max(IConfig::GetGlobalConfig().phys.collisionInterval, 1));
 
-            c++;
+            for (uint32_t i = 0; i < a_steps; i++)
+            {
+                UpdateActorsPhase2(a_timeTick);
+
+                {
+                    CBP_PROFILE_ZONE(kWorldUpdate);
+
+                    if (m_collisionStep == 0)
+                        world.Update();
+                    else
+                        world.UpdatePairs();
+                }
+
+                if (++m_collisionStep >= interval)
+                    m_collisionStep = 0;
+
+                ICollision::ProcessContacts(world.GetContacts());
+            }
+
+            return;
         }
 
-        UpdateActorsPhase2(a_timeStep);
+        auto world = DCBP::GetWorld();
+
+        bool debugRendererEnabled = world->getIsDebugRenderingEnabled();
+        world->setIsDebugRenderingEnabled(false);
 
-        ICollision::SetTimeStep(a_timeStep);
+        for (uint32_t i = 0; i < a_steps; i++)
+        {
+            UpdateActorsPhase2(a_timeTick);
 
-        world->setIsDebugRenderingEnabled(debugRendererEnabled);
-        world->update(a_timeStep);
+            // only the last step feeds the debug renderer
+            if (i == a_steps - 1)
+                world->setIsDebugRenderingEnabled(debugRendererEnabled);
 
-        return c;
+            {
+                CBP_PROFILE_ZONE(kWorldUpdate);
+                world->update(a_timeTick);
+            }
+        }
     }
 
 #ifdef _CBP_ENABLE_DEBUG
@@ -134,6 +339,10 @@ namespace CBP
 
         DCBP::Lock();
 
+        ITrace::OnFrameBegin();
+
+        CBP_PROFILE_ZONE(kPhysicsTick);
+
         auto& globalConf = IConfig::GetGlobalConfig();
 
         if (globalConf.general.enableProfiling)
@@ -141,39 +350,90 @@ namespace CBP
 
         UpdateDebugRenderer();
 
-        m_averageInterval = m_averageInterval * 0.875f + interval * 0.125f;
-        auto timeTick = std::min(m_averageInterval, globalConf.phys.timeTick);
+        m_recorder.OnTickBegin();
+
+        m_workers.SetNumWorkers(static_cast<uint32_t>(
+            std::max(globalConf.phys.numThreads, 0)));
+
+        auto timeTick = globalConf.phys.timeTick;
+        auto maxSteps = std::max(static_cast<uint32_t>(globalConf.phys.maxSubSteps), 1U);
 
         m_timeAccum += interval;
 
-        uint32_t steps;
+        // fixed steps only, the remainder carries over to the next frame
+        auto steps = std::min(static_cast<uint32_t>(m_timeAccum / timeTick), maxSteps);
 
-        if (m_timeAccum > timeTick * 0.25f)
+        if (steps > 0)
         {
-            float timeStep = std::min(m_timeAccum,
-                timeTick * globalConf.phys.maxSubSteps);
+            UpdateLOD();
 
-            float maxTime = timeTick * 1.25f;
+            m_deferredCount = ScheduleActors(steps);
 
             UpdatePhase1();
 
+            bool sampleCosts = globalConf.general.enableProfiling &&
+                globalConf.general.costAttribution &&
+                m_costs.BeginFrame(static_cast<uint32_t>(globalConf.general.costSampleInterval));
+
+            m_store.SetCostSampling(sampleCosts);
+
+            PerfTimer pt;
+            pt.Start();
+
+            uint64_t tsc = sampleCosts ? __rdtsc() : 0;
+
+            m_store.ResetSimulatedCount();
+
             if (globalConf.phys.collisions)
-                steps = UpdatePhase2Collisions(timeStep, timeTick, maxTime);
+                UpdatePhase2Collisions(timeTick, steps);
             else
-                steps = UpdatePhase2(timeStep, timeTick, maxTime);
+                UpdatePhase2(timeTick, steps);
+
+            auto elapsed = pt.Stop();
+
+            if (sampleCosts)
+            {
+                m_costs.AddSample(__rdtsc() - tsc, static_cast<long long>(elapsed * 1000000000.0));
+                m_store.SetCostSampling(false);
+            }
+
+            auto simulated = m_store.GetSimulatedCount();
+            if (simulated > 0)
+            {
+                float nodeCost = (static_cast<float>(elapsed) * 1000000.0f) /
+                    static_cast<float>(simulated);
+
+                m_nodeCost = m_nodeCost * 0.9f + nodeCost * 0.1f;
+            }
+
+            m_timeAccum -= timeTick * static_cast<float>(steps);
+        }
+
+        // can't keep up, drop what's left instead of spiraling
+        m_timeAccum = std::min(m_timeAccum, timeTick);
+
+        {
+            CBP_PROFILE_ZONE(kInterpolate);
+            m_store.Interpolate(m_timeAccum / timeTick, m_workers);
+        }
 
 #ifdef _CBP_ENABLE_DEBUG
+        if (steps > 0)
             UpdatePhase3();
 #endif
 
-            m_timeAccum = 0.0f;
-        }
-        else {
-            steps = 0;
-        }
+        m_recorder.OnFrame(interval, m_actors);
 
         if (globalConf.general.enableProfiling)
-            m_profiler.End(m_actors.size(), steps);
+        {
+            if (m_profiler.End(m_actors.size(), steps,
+                m_store.NumAwake(), m_store.NumMoving() - m_store.NumAwake(),
+                m_deferredCount))
+            {
+                if (globalConf.general.costAttribution)
+                    m_costs.Update(m_actors);
+            }
+        }
 
         DCBP::Unlock();
     }
@@ -182,6 +442,8 @@ namespace CBP
     {
         DCBP::Lock();
 
+        CBP_PROFILE_ZONE(kRun);
+
         CullActors();
 
         auto player = *g_thePlayer;
@@ -193,6 +455,8 @@ namespace CBP
 
     void UpdateTask::CullActors()
     {
+        CBP_PROFILE_ZONE(kCullActors);
+
         auto it = m_actors.begin();
         while (it != m_actors.end())
         {
@@ -203,6 +467,8 @@ namespace CBP
 #ifdef _CBP_SHOW_STATS
                 Debug("Actor 0x%llX (%s) no longer valid", it->first, actor ? CALL_MEMBER_FN(actor, GetReferenceName)() : nullptr);
 #endif
+                m_recorder.OnRemoveActor(it->first);
+
                 it->second.Release();
                 it = m_actors.erase(it);
             }
@@ -268,7 +534,13 @@ namespace CBP
         Debug("Adding %.16llX (%s)", a_handle, CALL_MEMBER_FN(actor, GetReferenceName)());
 #endif
 
-        m_actors.try_emplace(a_handle, a_handle, actor, sex, m_nextGroupId++, descList);
+        // existing colliders stay on the backend they were created on
+        if (m_actors.empty())
+            ICollision::SetBackend(static_cast<ICollision::Backend>(globalConfig.phys.collisionBackend));
+
+        auto r = m_actors.try_emplace(a_handle, a_handle, actor, sex, m_nextGroupId++, descList);
+        if (r.second)
+            m_recorder.OnAddActor(a_handle, actor, r.first->second, actorConf);
     }
 
     void UpdateTask::RemoveActor(SKSE::ObjectHandle a_handle)
@@ -283,6 +555,8 @@ namespace CBP
             it->second.Release();
             m_actors.erase(it);
 
+            m_recorder.OnRemoveActor(a_handle);
+
             IConfig::RemoveArmorOverride(a_handle);
         }
     }
@@ -323,11 +597,14 @@ namespace CBP
     void UpdateTask::DoConfigUpdate(SKSE::ObjectHandle a_handle, Actor* a_actor, SimObject& a_obj)
     {
         auto& globalConfig = IConfig::GetGlobalConfig();
+        auto& actorConf = IConfig::GetActorConfAO(a_handle);
 
         a_obj.UpdateConfig(
             a_actor,
             globalConfig.phys.collisions,
-            IConfig::GetActorConfAO(a_handle));
+            actorConf);
+
+        m_recorder.OnConfigUpdate(a_handle, a_obj, actorConf);
     }
 
     void UpdateTask::ApplyForce(
@@ -336,6 +613,8 @@ namespace CBP
         const std::string& a_component,
         const NiPoint3& a_force)
     {
+        m_recorder.OnApplyForce(a_handle, a_steps, a_component, a_force);
+
         if (a_handle) {
             auto it = m_actors.find(a_handle);
             if (it != m_actors.end())
@@ -363,6 +642,8 @@ namespace CBP
             Debug("CLR: Removing %llX (%s)", e.first, actor ? CALL_MEMBER_FN(actor, GetReferenceName)() : "nullptr");
 #endif
 
+            m_recorder.OnRemoveActor(e.first);
+
             e.second.Release();
         }
 
@@ -374,7 +655,10 @@ namespace CBP
     void UpdateTask::Clear()
     {
         for (auto& e : m_actors)
+        {
+            m_recorder.OnRemoveActor(e.first);
             e.second.Release();
+        }
 
         m_actors.clear();
 
@@ -406,7 +690,10 @@ namespace CBP
     void UpdateTask::PhysicsReset()
     {
         for (auto& e : m_actors)
+        {
             e.second.Reset();
+            m_recorder.OnReset(e.first);
+        }
 
         auto& globalConf = IConfig::GetGlobalConfig();
     }
@@ -594,6 +881,35 @@ namespace CBP
         UpdateConfigOnAllActors();
     }
 
+    void UpdateTask::StartRecording()
+    {
+        if (m_recorder.IsRecording())
+            return;
+
+        char name[64];
+        _snprintf_s(name, _TRUNCATE, "%lld.cbprec", static_cast<long long>(std::time(nullptr)));
+
+        if (!m_recorder.Start(fs::path(PLUGIN_CBP_RECORDINGS_PATH) / name, m_timeAccum))
+            return;
+
+        // actors are re-added so the recording starts from fresh simulation state
+        Reset();
+
+        Message("Recording to %s", name);
+    }
+
+    void UpdateTask::StopRecording()
+    {
+        if (!m_recorder.IsRecording())
+            return;
+
+        auto frames = m_recorder.GetFrames();
+
+        m_recorder.Stop();
+
+        Message("Recording stopped (%llu frames)", frames);
+    }
+
     void UpdateTask::AddTask(const UTTask& task)
     {
         m_taskLock.Enter();
@@ -639,6 +955,8 @@ namespace CBP
 
     void UpdateTask::ProcessTasks()
     {
+        CBP_PROFILE_ZONE(kProcessTasks);
+
         while (!IsTaskQueueEmpty())
         {
             m_taskLock.Enter();
@@ -646,6 +964,8 @@ namespace CBP
             m_taskQueue.pop();
             m_taskLock.Leave();
 
+            CBP_TRACE_SCOPE_ARG(UTTask::GetActionName(task.m_action), "task", kHandle, task.m_handle);
+
             switch (task.m_action)
             {
             case UTTask::UTTAction::Add:
@@ -696,6 +1016,12 @@ namespace CBP
             case UTTask::UTTAction::ClearArmorOverrides:
                 ClearArmorOverrides();
                 break;
+            case UTTask::UTTAction::StartRecording:
+                StartRecording();
+                break;
+            case UTTask::UTTAction::StopRecording:
+                StopRecording();
+                break;
             }
         }
     }
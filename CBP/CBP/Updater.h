@@ -23,9 +23,13 @@ namespace CBP
             AddArmorOverride,
             UpdateArmorOverride,
             UpdateArmorOverridesAll,
-            ClearArmorOverrides
+            ClearArmorOverrides,
+            StartRecording,
+            StopRecording
         };
 
+        [[nodiscard]] static const char* GetActionName(UTTAction a_action);
+
         UTTAction m_action;
         SKSE::ObjectHandle m_handle = 0;
         SKSE::FormID m_formid = 0;
@@ -55,6 +59,7 @@ namespace CBP
         virtual void Run();
 
         __forceinline void CullActors();
+        __forceinline void UpdateLOD();
         __forceinline void UpdatePhase1();
         __forceinline void UpdateActorsPhase2(float a_timeStep);
 
@@ -62,8 +67,8 @@ namespace CBP
         __forceinline void UpdatePhase3();
 #endif
 
-        __forceinline uint32_t UpdatePhase2(float a_timeStep, float a_timeTick, float a_maxTime);
-        __forceinline uint32_t UpdatePhase2Collisions(float a_timeStep, float a_timeTick, float a_maxTime);
+        __forceinline void UpdatePhase2(float a_timeTick, uint32_t a_steps);
+        __forceinline void UpdatePhase2Collisions(float a_timeTick, uint32_t a_steps);
 
         void PhysicsTick();
 
@@ -84,6 +89,8 @@ namespace CBP
         void UpdateArmorOverride(SKSE::ObjectHandle a_handle);
         void UpdateArmorOverridesAll();
         void ClearArmorOverrides();
+        void StartRecording();
+        void StopRecording();
 
         void UpdateDebugRenderer();
 
@@ -101,8 +108,24 @@ namespace CBP
             return m_profiler;
         }
 
-        inline void UpdateTimeTick(float a_val) {
-            m_averageInterval = a_val;
+        inline const auto& GetCostProfiler() const {
+            return m_costs;
+        }
+
+        inline void ResetCostProfiler() {
+            m_costs.Reset(m_actors);
+        }
+
+        inline auto& GetSimStore() {
+            return m_store;
+        }
+
+        inline auto& GetWorkerPool() {
+            return m_workers;
+        }
+
+        inline const auto& GetRecorder() const {
+            return m_recorder;
         }
 
         inline void SetMarkedActor(SKSE::ObjectHandle a_handle) {
@@ -116,6 +139,8 @@ namespace CBP
         bool IsTaskQueueEmpty();
         void ProcessTasks();
         void GatherActors(handleSet_t& a_out);
+        static bool GetViewPoint(NiPoint3& a_pos, NiPoint3& a_forward);
+        uint32_t ScheduleActors(uint32_t a_steps);
 
         bool ApplyArmorOverride(SKSE::ObjectHandle a_handle, const armorOverrideResults_t& a_entry);
         bool BuildArmorOverride(SKSE::ObjectHandle a_handle, const armorOverrideResults_t& a_in, armorOverrideDescriptor_t& a_out);
@@ -123,6 +148,8 @@ namespace CBP
         __forceinline void DoConfigUpdate(SKSE::ObjectHandle a_handle, Actor* a_actor, SimObject& a_obj);
 
         simActorList_t m_actors;
+        SimStore m_store;
+        WorkerPool m_workers;
         SKSE::ObjectHandle m_markedActor;
 
         std::queue<UTTask> m_taskQueue;
@@ -130,11 +157,19 @@ namespace CBP
         ICriticalSection m_taskLock;
 
         float m_timeAccum;
-        float m_averageInterval;
+        // steps since the last full collision detection
+        uint32_t m_collisionStep;
+
+        // average cost of one node step in microseconds, includes collisions
+        float m_nodeCost;
+        uint32_t m_deferredCount;
+        std::vector<std::pair<float, SimObject*>> m_schedule;
 
         static std::atomic<uint64_t> m_nextGroupId;
 
         Profiler m_profiler;
+        CostProfiler m_costs;
+        MotionRecorder m_recorder;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "pch.h"
+
+namespace CBP
+{
+    WorkerPool::~WorkerPool()
+    {
+        Stop();
+    }
+
+    void WorkerPool::SetNumWorkers(std::uint32_t a_num)
+    {
+        a_num = std::min(a_num, MAX_WORKERS);
+
+        if (a_num == NumWorkers())
+            return;
+
+        Stop();
+
+        m_shutdown = false;
+
+        for (std::uint32_t i = 0; i < a_num; i++)
+            m_threads.emplace_back(&WorkerPool::WorkerProc, this, i, m_generation);
+    }
+
+    void WorkerPool::Stop()
+    {
+        if (m_threads.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> _(m_mutex);
+            m_shutdown = true;
+        }
+
+        m_startCond.notify_all();
+
+        for (auto& e : m_threads)
+            e.join();
+
+        m_threads.clear();
+    }
+
+    void WorkerPool::Dispatch(
+        std::uint32_t a_count,
+        std::uint32_t a_grain,
+        rangeFunc_t a_func,
+        const void* a_ctx)
+    {
+        auto numWorkers = NumWorkers();
+
+        m_numRanges = numWorkers + 1;
+
+        auto perRange = (a_count + m_numRanges - 1) / m_numRanges;
+        perRange = ((perRange + a_grain - 1) / a_grain) * a_grain;
+
+        for (std::uint32_t i = 0; i < m_numRanges; i++)
+        {
+            m_ranges[i].head.store(std::min(i * perRange, a_count), std::memory_order_relaxed);
+            m_ranges[i].end = std::min((i + 1) * perRange, a_count);
+        }
+
+        m_func = a_func;
+        m_ctx = a_ctx;
+        m_grain = a_grain;
+
+        m_pending.store(numWorkers, std::memory_order_relaxed);
+
+        {
+            std::lock_guard<std::mutex> _(m_mutex);
+            m_generation++;
+        }
+
+        m_startCond.notify_all();
+
+        // the calling thread takes the last range
+        Execute(numWorkers);
+
+        for (int i = 0; i < 2000; i++)
+        {
+            if (m_pending.load(std::memory_order_acquire) == 0)
+                return;
+
+            _mm_pause();
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_doneCond.wait(lock, [this] {
+            return m_pending.load(std::memory_order_acquire) == 0; });
+    }
+
+    void WorkerPool::Execute(std::uint32_t a_index)
+    {
+        for (std::uint32_t i = 0; i < m_numRanges; i++)
+        {
+            auto& range = m_ranges[(a_index + i) % m_numRanges];
+
+            for (;;)
+            {
+                auto begin = range.head.fetch_add(m_grain, std::memory_order_relaxed);
+                if (begin >= range.end)
+                    break;
+
+                m_func(m_ctx, begin, std::min(begin + m_grain, range.end));
+            }
+        }
+    }
+
+    void WorkerPool::WorkerProc(std::uint32_t a_index, std::uint64_t a_generation)
+    {
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+        auto generation = a_generation;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_startCond.wait(lock, [&] {
+                    return m_shutdown || m_generation != generation; });
+
+                if (m_shutdown)
+                    return;
+
+                generation = m_generation;
+            }
+
+            Execute(a_index);
+
+            if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> _(m_mutex);
+                m_doneCond.notify_one();
+            }
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+namespace CBP
+{
+    class WorkerPool
+    {
+        typedef void (*rangeFunc_t)(const void* a_ctx, std::uint32_t a_begin, std::uint32_t a_end);
+
+        struct alignas(64) range_t
+        {
+            std::atomic<std::uint32_t> head;
+            std::uint32_t end;
+        };
+
+    public:
+        static constexpr std::uint32_t MAX_WORKERS = 32;
+
+        WorkerPool() = default;
+        ~WorkerPool();
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool(WorkerPool&&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+        void operator=(WorkerPool&&) = delete;
+
+        // 0 stops all workers, everything then runs on the calling thread
+        void SetNumWorkers(std::uint32_t a_num);
+
+        [[nodiscard]] inline std::uint32_t NumWorkers() const noexcept {
+            return static_cast<std::uint32_t>(m_threads.size());
+        }
+
+        // Splits [0, a_count) into one range per thread (caller included), in
+        // multiples of a_grain. Threads that finish their own range steal chunks
+        // from the others. Returns once every chunk has been processed.
+        template <typename T>
+        void ParallelFor(std::uint32_t a_count, std::uint32_t a_grain, const T& a_func)
+        {
+            if (m_threads.empty() || a_count <= a_grain)
+            {
+                if (a_count)
+                    a_func(0, a_count);
+
+                return;
+            }
+
+            Dispatch(a_count, a_grain,
+                [](const void* a_ctx, std::uint32_t a_begin, std::uint32_t a_end) {
+                    (*static_cast<const T*>(a_ctx))(a_begin, a_end);
+                },
+                static_cast<const void*>(std::addressof(a_func)));
+        }
+
+    private:
+        void Dispatch(std::uint32_t a_count, std::uint32_t a_grain, rangeFunc_t a_func, const void* a_ctx);
+        void Execute(std::uint32_t a_index);
+        void WorkerProc(std::uint32_t a_index, std::uint64_t a_generation);
+        void Stop();
+
+        std::vector<std::thread> m_threads;
+        range_t m_ranges[MAX_WORKERS + 1];
+        std::uint32_t m_numRanges = 0;
+
+        rangeFunc_t m_func = nullptr;
+        const void* m_ctx = nullptr;
+        std::uint32_t m_grain = 1;
+
+        std::mutex m_mutex;
+        std::condition_variable m_startCond;
+        std::condition_variable m_doneCond;
+        std::uint64_t m_generation = 0;
+        std::atomic<std::uint32_t> m_pending = 0;
+        bool m_shutdown = false;
+    };
+}
\ No newline at end of file
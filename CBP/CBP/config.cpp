@@ -9,6 +9,7 @@ namespace CBP
     configGlobal_t IConfig::globalConfig;
     IConfig::vKey_t IConfig::validSimComponents;
     nodeMap_t IConfig::nodeMap;
+    nodeChains_t IConfig::nodeChains;
     configGroupMap_t IConfig::configGroupMap;
 
     collisionGroups_t IConfig::collisionGroups;
@@ -181,6 +182,13 @@ namespace CBP
             1.0f, 1000.0f,
             "",
             "Col. depth mul"
+        }},
+        {"integrator", {
+            offsetof(configComponent_t, integrator),
+            "",
+            0.0f, 2.0f,
+            "0 = explicit Euler, 1 = implicit Euler, 2 = position based (spring, max. offset and contacts solved as constraints). 1 and 2 stay stable with stiff springs at low tick rates",
+            "Integrator"
         }}
         });
 
@@ -192,7 +200,57 @@ namespace CBP
         {"HDT Belly", "belly"}
     };
 
-    bool IConfig::LoadNodeMap(nodeMap_t& a_out)
+    void IConfig::LoadNodeList(
+        const Json::Value& a_nodes,
+        const std::string& a_simComponent,
+        nodeMap_t& a_out,
+        std::vector<std::string>* a_chain)
+    {
+        for (auto& v : a_nodes)
+        {
+            if (!v.isString())
+                continue;
+
+            std::string k(v.asString());
+            if (k.size() == 0)
+                continue;
+
+            a_out.insert_or_assign(k, a_simComponent);
+
+            if (a_chain)
+                a_chain->emplace_back(std::move(k));
+        }
+    }
+
+    std::size_t IConfig::FilterNodeChains(nodeChains_t& a_chains)
+    {
+        std::unordered_set<std::string> chained;
+        std::size_t dropped = 0;
+
+        for (auto& c : a_chains)
+        {
+            auto it = std::remove_if(c.begin(), c.end(),
+                [&](const std::string& a_node) { return !chained.emplace(a_node).second; });
+
+            dropped += static_cast<std::size_t>(std::distance(it, c.end()));
+
+            // the rest of the chain splits where the node was, see SimObject::UpdateChains
+            c.erase(it, c.end());
+        }
+
+        a_chains.erase(std::remove_if(a_chains.begin(), a_chains.end(),
+            [](const auto& a_chain) { return a_chain.size() < 2; }), a_chains.end());
+
+        return dropped;
+    }
+
+    void IConfig::SetNodeChains(const nodeChains_t& a_rhs)
+    {
+        nodeChains = a_rhs;
+        FilterNodeChains(nodeChains);
+    }
+
+    bool IConfig::LoadNodeMap(nodeMap_t& a_out, nodeChains_t& a_chains)
     {
         try
         {
@@ -207,13 +265,10 @@ namespace CBP
                 return true;
 
             if (!root.isObject())
-                throw std::exception("Unexpected data");
+                throw std::runtime_error("Unexpected data");
 
             for (auto it = root.begin(); it != root.end(); ++it)
             {
-                if (!it->isArray())
-                    continue;
-
                 auto k = it.key();
                 if (!k.isString())
                     continue;
@@ -222,19 +277,48 @@ namespace CBP
                 if (simComponent.size() == 0)
                     continue;
 
-                for (auto& v : *it)
+                if (it->isArray()) {
+                    LoadNodeList(*it, simComponent, a_out, nullptr);
+                    continue;
+                }
+
+                // {"chain": true, "nodes": [...]}, nodes may also hold several chains as nested arrays
+                if (!it->isObject())
+                    continue;
+
+                auto& nodes = (*it)["nodes"];
+                if (!nodes.isArray())
+                    continue;
+
+                bool chain = (*it).get("chain", false).asBool();
+
+                if (nodes.size() && nodes[0].isArray())
                 {
-                    if (!v.isString())
-                        continue;
+                    for (auto& e : nodes)
+                    {
+                        if (!e.isArray())
+                            continue;
 
-                    std::string k(v.asString());
-                    if (k.size() == 0)
-                        continue;
+                        std::vector<std::string> c;
+                        LoadNodeList(e, simComponent, a_out, chain ? std::addressof(c) : nullptr);
 
-                    a_out.insert_or_assign(k, simComponent);
+                        if (c.size() > 1)
+                            a_chains.emplace_back(std::move(c));
+                    }
+                }
+                else
+                {
+                    std::vector<std::string> c;
+                    LoadNodeList(nodes, simComponent, a_out, chain ? std::addressof(c) : nullptr);
+
+                    if (c.size() > 1)
+                        a_chains.emplace_back(std::move(c));
                 }
             }
 
+            if (auto n = FilterNodeChains(a_chains))
+                log.Warning("%s: %zu node(s) listed in more than one chain, kept in the first only", __FUNCTION__, n);
+
             return true;
         }
         catch (const std::system_error& e) {
@@ -310,8 +394,11 @@ namespace CBP
     void IConfig::LoadConfig()
     {
         nodeMap_t nm;
-        if (LoadNodeMap(nm))
+        nodeChains_t nc;
+        if (LoadNodeMap(nm, nc)) {
             nodeMap = std::move(nm);
+            nodeChains = std::move(nc);
+        }
         else
             nodeMap = defaultNodeMap;
 
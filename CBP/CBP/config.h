@@ -103,6 +103,9 @@ namespace CBP
             bool armorOverrides = true;
             bool enableProfiling = false;
             int profilingInterval = 1000;
+            int traceFrames = 300;
+            bool costAttribution = false;
+            int costSampleInterval = 8;
         } general;
 
         struct
@@ -111,6 +114,23 @@ namespace CBP
             float timeTick = 1.0f / 60.0f;
             float maxSubSteps = 5.0f;
             bool collisions = true;
+            // ICollision::Backend
+            int collisionBackend = 0;
+            // full collision detection every Nth step, see SphereWorld::UpdatePairs
+            int collisionInterval = 1;
+            int numThreads = 0;
+            bool sleeping = true;
+            float sleepVelocity = 0.5f;
+            float sleepOffset = 0.01f;
+            int sleepSteps = 30;
+            float wakeDistance = 0.1f;
+            float wakeContactDepth = 0.5f;
+            bool lod = true;
+            float lodMidDistance = 2000.0f;
+            float lodFarDistance = 5000.0f;
+            int lodMidInterval = 2;
+            int budget = 0;
+            int pbdIterations = 4;
         } phys;
 
         struct
@@ -255,17 +275,20 @@ namespace CBP
         float colSphereOffsetZMax = 0.0f;
         float colDampingCoef = 1.5f;
         float colDepthMul = 100.0f;
+        float integrator = 0.0f;
 
         static const componentValueDescMap_t descMap;
     };
 
-    static_assert(sizeof(configComponent_t) == 0x5C);
+    static_assert(sizeof(configComponent_t) == 0x60);
 
     typedef std::map<std::string, configComponent_t> configComponents_t;
     typedef configComponents_t::value_type configComponentsValue_t;
     typedef std::unordered_map<SKSE::ObjectHandle, configComponents_t> actorConfigComponentsHolder_t;
     typedef std::unordered_map<SKSE::FormID, configComponents_t> raceConfigComponentsHolder_t;
     typedef std::map<std::string, std::string> nodeMap_t;
+    // ordered node lists, each node parented to the one before it
+    typedef std::vector<std::vector<std::string>> nodeChains_t;
     typedef std::unordered_map<std::string, std::vector<std::string>> configGroupMap_t;
 
     typedef std::set<uint64_t> collisionGroups_t;
@@ -437,6 +460,13 @@ namespace CBP
             return nodeMap;
         }
 
+        [[nodiscard]] inline static const auto& GetNodeChains() {
+            return nodeChains;
+        }
+
+        // drops nodes already in an earlier chain, see FilterNodeChains
+        static void SetNodeChains(const nodeChains_t& a_rhs);
+
         [[nodiscard]] inline static bool IsValidNode(const std::string& a_key) {
             return nodeMap.find(a_key) != nodeMap.end();
         }
@@ -586,7 +616,11 @@ namespace CBP
 
     private:
 
-        static bool LoadNodeMap(nodeMap_t& a_out);
+        static bool LoadNodeMap(nodeMap_t& a_out, nodeChains_t& a_chains);
+        static void LoadNodeList(const Json::Value& a_nodes, const std::string& a_simComponent, nodeMap_t& a_out, std::vector<std::string>* a_chain);
+        // Chains are solved and written in parallel, a node is kept in the first chain it's
+        // listed in only. Returns the number of nodes dropped.
+        static std::size_t FilterNodeChains(nodeChains_t& a_chains);
         [[nodiscard]] static bool CompatLoadOldConf(configComponents_t& a_out);
 
         static configComponents_t thingGlobalConfig;
@@ -597,6 +631,7 @@ namespace CBP
         static vKey_t validSimComponents;
 
         static nodeMap_t nodeMap;
+        static nodeChains_t nodeChains;
         static configGroupMap_t configGroupMap;
         static const nodeMap_t defaultNodeMap;
 
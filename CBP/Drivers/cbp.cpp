@@ -252,6 +252,7 @@ namespace CBP
     void DCBP::ResetProfiler()
     {
         m_Instance.m_updateTask.GetProfiler().Reset();
+        m_Instance.m_updateTask.ResetCostProfiler();
     }
 
     void DCBP::SetProfilerInterval(long long a_interval)
@@ -259,6 +260,18 @@ namespace CBP
         m_Instance.m_updateTask.GetProfiler().SetInterval(a_interval);
     }
 
+    void DCBP::StartRecording()
+    {
+        m_Instance.m_updateTask.AddTask(
+            UTTask::UTTAction::StartRecording);
+    }
+
+    void DCBP::StopRecording()
+    {
+        m_Instance.m_updateTask.AddTask(
+            UTTask::UTTAction::StopRecording);
+    }
+
     uint32_t DCBP::ConfigGetComboKey(int32_t param)
     {
         switch (param) {
@@ -409,6 +422,11 @@ namespace CBP
 
         ICollision::Initialize(m_Instance.m_world);
 
+        ISimKernel::Initialize();
+
+        m_Instance.Message("Using %s spring kernel",
+            ISimKernel::GetKernelName(ISimKernel::GetKernelType()));
+
         if (m_Instance.conf.debug_renderer) {
             IEvents::RegisterForEvent(Event::OnD3D11PostCreate, OnD3D11PostCreate_CBP);
 
@@ -489,6 +507,7 @@ namespace CBP
         IScopedCriticalSection _(std::addressof(GetLock()));
 
         m_Instance.m_updateTask.Clear();
+        m_Instance.m_updateTask.GetWorkerPool().SetNumWorkers(0);
         SavePending();
 
         m_Instance.Debug("Shutting down");
@@ -534,7 +553,6 @@ namespace CBP
             UpdateDebugRendererSettings();
             UpdateProfilerSettings();
 
-            GetUpdateTask().UpdateTimeTick(IConfig::GetGlobalConfig().phys.timeTick);
             UpdateKeys();
 
             Unlock();
@@ -551,6 +569,8 @@ namespace CBP
     template <typename T>
     bool DCBP::LoadRecord(SKSESerializationInterface* intfc, UInt32 a_type, T a_func)
     {
+        CBP_TRACE_SCOPE_ARG("LoadRecord", "serialization", kRecord, a_type);
+
         PerfTimer pt;
         pt.Start();
 
@@ -579,15 +599,7 @@ namespace CBP
 
         try
         {
-            using namespace boost::iostreams;
-
-            typedef basic_array_source<char> Device;
-            stream<Device> stream(data.get(), dataLength);
-
-            filtering_streambuf<input> in;
-            in.push(gzip_decompressor(zlib::default_window_bits, 1024 * 128));
-            in.push(stream);
-            length = copy(in, out);
+            length = ISerialization::Decompress(data.get(), dataLength, out);
         }
         catch (const boost::iostreams::gzip_error& e)
         {
@@ -661,22 +673,7 @@ namespace CBP
     template <typename T>
     bool DCBP::SaveRecord(SKSESerializationInterface* intfc, UInt32 a_type, T a_func)
     {
-        struct strsink : public boost::iostreams::sink
-        {
-            strsink(std::string& a_dataHolder) :
-                data(a_dataHolder)
-            {}
-
-            std::streamsize write(
-                const char* a_data,
-                std::streamsize a_len)
-            {
-                data.append(a_data, a_len);
-                return a_len;
-            }
-
-            std::string& data;
-        };
+        CBP_TRACE_SCOPE_ARG("SaveRecord", "serialization", kRecord, a_type);
 
         PerfTimer pt;
         pt.Start();
@@ -685,7 +682,6 @@ namespace CBP
 
         std::stringstream data;
         std::string compressed;
-        strsink out(compressed);
         UInt32 length;
 
         size_t num = std::bind(a_func, std::addressof(iface), std::placeholders::_1)(data);
@@ -696,12 +692,7 @@ namespace CBP
 
         try
         {
-            using namespace boost::iostreams;
-
-            filtering_streambuf<input> in;
-            in.push(gzip_compressor(gzip_params(driverConf.compression_level), 1024 * 128));
-            in.push(data);
-            length = static_cast<UInt32>(copy(in, out));
+            length = static_cast<UInt32>(ISerialization::Compress(data, compressed, driverConf.compression_level));
         }
         catch (const boost::iostreams::gzip_error& e)
         {
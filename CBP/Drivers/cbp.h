@@ -226,6 +226,14 @@ namespace CBP
             return m_Instance.m_physicsCommon;
         }
 
+        [[nodiscard]] inline static auto& GetSphereWorld() {
+            return m_Instance.m_sphereWorld;
+        }
+
+        [[nodiscard]] inline static auto& GetSimStore() {
+            return m_Instance.m_updateTask.GetSimStore();
+        }
+
         static void ResetProfiler();
         static void SetProfilerInterval(long long a_interval);
 
@@ -233,6 +241,13 @@ namespace CBP
             return m_Instance.m_updateTask.GetProfiler();
         }
 
+        static void StartRecording();
+        static void StopRecording();
+
+        [[nodiscard]] inline static bool IsRecording() {
+            return m_Instance.m_updateTask.GetRecorder().IsRecording();
+        }
+
         inline static void Lock() {
             m_Instance.m_lock.Enter();
         }
@@ -327,6 +342,7 @@ namespace CBP
 
         r3d::PhysicsWorld* m_world;
         r3d::PhysicsCommon m_physicsCommon;
+        SphereWorld m_sphereWorld;
 
         mainLoopUpdateFunc_t mainLoopUpdateFunc_o;
 
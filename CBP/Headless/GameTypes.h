@@ -0,0 +1,145 @@
+#pragma once
+
+// Stand-ins for the SKSE/game types the simulation and config code reference.
+
+typedef std::uint8_t UInt8;
+typedef std::uint16_t UInt16;
+typedef std::uint32_t UInt32;
+typedef std::uint64_t UInt64;
+typedef std::int32_t SInt32;
+
+constexpr float _EPSILON = std::numeric_limits<float>::epsilon();
+
+constexpr UInt32 DIK_LSHIFT = 0x2A;
+constexpr UInt32 DIK_END = 0xCF;
+constexpr UInt32 DIK_PGDN = 0xD1;
+
+// co-save records are only produced and consumed in memory, handles and forms pass through as is
+struct SKSESerializationInterface
+{
+};
+
+namespace SKSE
+{
+    typedef UInt64 ObjectHandle;
+    typedef UInt32 FormID;
+
+    inline bool ResolveHandle(SKSESerializationInterface*, ObjectHandle a_handle, ObjectHandle* a_out)
+    {
+        *a_out = a_handle;
+        return true;
+    }
+
+    inline bool ResolveRaceForm(SKSESerializationInterface*, FormID a_formid, FormID* a_out)
+    {
+        *a_out = a_formid;
+        return true;
+    }
+}
+
+namespace Enum
+{
+    template <typename T>
+    constexpr auto Underlying(T a_value) noexcept
+    {
+        return static_cast<std::underlying_type_t<T>>(a_value);
+    }
+}
+
+namespace except
+{
+    struct descriptor
+    {
+        descriptor& operator=(const std::exception& a_rhs)
+        {
+            m_description = a_rhs.what();
+            return *this;
+        }
+
+        std::string m_description;
+    };
+}
+
+class ILog
+{
+public:
+    virtual ~ILog() = default;
+
+    [[nodiscard]] virtual const char* ModuleName() const noexcept {
+        return nullptr;
+    }
+
+    void Debug(const char* a_fmt, ...) const;
+    void Message(const char* a_fmt, ...) const;
+    void Warning(const char* a_fmt, ...) const;
+    void Error(const char* a_fmt, ...) const;
+
+private:
+    void Write(const char* a_level, const char* a_fmt, va_list a_args) const;
+};
+
+#define FN_NAMEPROC(x) virtual const char* ModuleName() const noexcept override { return x; }
+
+class TESForm
+{
+public:
+    enum
+    {
+        kFlagIsDeleted = 1 << 5
+    };
+
+    virtual ~TESForm() = default;
+
+    UInt32 flags = 0;
+    UInt32 formID = 0;
+};
+
+class TESNPC :
+    public TESForm
+{
+public:
+    float weight = 50.0f;
+    char sex = 1;
+};
+
+#define DYNAMIC_CAST(obj, from, to) dynamic_cast<to*>(static_cast<from*>(obj))
+
+class Actor :
+    public TESForm,
+    public NiRefObject
+{
+public:
+    struct LoadedState
+    {
+        NiPointer<NiNode> node;
+    };
+
+    Actor(TESForm* a_baseForm, NiNode* a_root) :
+        baseForm(a_baseForm),
+        loadedState(std::addressof(m_loadedState)),
+        m_loadedState{ a_root }
+    {}
+
+    TESForm* baseForm;
+    LoadedState* loadedState;
+    NiPoint3 pos;
+
+private:
+    LoadedState m_loadedState;
+};
+
+class PerfTimer
+{
+public:
+    inline void Start() {
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    // seconds since Start()
+    [[nodiscard]] inline double Stop() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
\ No newline at end of file
@@ -0,0 +1,566 @@
+#include "pch.h"
+
+void ILog::Debug(const char* a_fmt, ...) const
+{
+    va_list args;
+    va_start(args, a_fmt);
+    Write("DEBUG", a_fmt, args);
+    va_end(args);
+}
+
+void ILog::Message(const char* a_fmt, ...) const
+{
+    va_list args;
+    va_start(args, a_fmt);
+    Write("MESSAGE", a_fmt, args);
+    va_end(args);
+}
+
+void ILog::Warning(const char* a_fmt, ...) const
+{
+    va_list args;
+    va_start(args, a_fmt);
+    Write("WARNING", a_fmt, args);
+    va_end(args);
+}
+
+void ILog::Error(const char* a_fmt, ...) const
+{
+    va_list args;
+    va_start(args, a_fmt);
+    Write("ERROR", a_fmt, args);
+    va_end(args);
+}
+
+void ILog::Write(const char* a_level, const char* a_fmt, va_list a_args) const
+{
+    auto name = ModuleName();
+
+    std::fprintf(stderr, "<%s> [%s] ", a_level, name ? name : "");
+    std::vfprintf(stderr, a_fmt, a_args);
+    std::fputc('\n', stderr);
+}
+
+namespace CBP
+{
+    IData::actorRaceMap_t IData::actorRaceMap;
+    IData::raceList_t IData::raceList;
+
+    // no forms to look the race up from
+    void IData::UpdateActorRaceMap(SKSE::ObjectHandle)
+    {
+    }
+
+    DCBP DCBP::m_Instance;
+
+    struct skeletonNode_t
+    {
+        // '$' is replaced with L and R, the R copy is mirrored on x
+        const char* name;
+        const char* parent;
+        float x;
+        float y;
+        float z;
+    };
+
+    // bones above every node in the shipped Nodes.json, roughly humanoid proportions
+    static const skeletonNode_t s_skeleton[] = {
+        {"NPC COM [COM ]", "NPC Root [Root]", 0.0f, 0.0f, 68.0f},
+        {"NPC Pelvis [Pelv]", "NPC COM [COM ]", 0.0f, 0.0f, 0.0f},
+        {"NPC Spine [Spn0]", "NPC COM [COM ]", 0.0f, 0.0f, 6.0f},
+        {"NPC Spine1 [Spn1]", "NPC Spine [Spn0]", 0.0f, 0.0f, 8.0f},
+        {"NPC Spine2 [Spn2]", "NPC Spine1 [Spn1]", 0.0f, 0.0f, 9.0f},
+        {"NPC Neck [Neck]", "NPC Spine2 [Spn2]", 0.0f, 0.0f, 13.0f},
+        {"NPC Head [Head]", "NPC Neck [Neck]", 0.0f, 0.0f, 5.0f},
+        {"NPC Belly", "NPC Spine [Spn0]", 0.0f, 5.0f, 1.0f},
+        {"HDT Belly", "NPC Spine [Spn0]", 0.0f, 6.0f, 2.0f},
+        {"NPC $ Breast", "NPC Spine2 [Spn2]", 4.0f, 5.0f, 2.0f},
+        {"$ Breast01", "NPC $ Breast", 0.0f, 2.0f, 0.0f},
+        {"$ Breast02", "$ Breast01", 0.0f, 1.5f, 0.0f},
+        {"$ Breast03", "$ Breast02", 0.0f, 1.0f, 0.0f},
+        {"NPC $ Clavicle [$Clv]", "NPC Spine2 [Spn2]", 2.0f, 0.0f, 10.0f},
+        {"NPC $ UpperArm [$Uar]", "NPC $ Clavicle [$Clv]", 8.0f, 0.0f, 0.0f},
+        {"NPC $ Forearm [$Lar]", "NPC $ UpperArm [$Uar]", 0.0f, 0.0f, -17.0f},
+        {"NPC $ Hand [$Hnd]", "NPC $ Forearm [$Lar]", 0.0f, 0.0f, -15.0f},
+        {"NPC $ Finger20 [$F20]", "NPC $ Hand [$Hnd]", 0.0f, 0.0f, -5.0f},
+        {"NPC $ Butt", "NPC Pelvis [Pelv]", 4.0f, -5.0f, -4.0f},
+        {"NPC $ Thigh [$Thg]", "NPC Pelvis [Pelv]", 5.0f, 0.0f, -6.0f},
+        {"NPC $ FrontThigh", "NPC $ Thigh [$Thg]", 0.0f, 3.0f, -8.0f},
+        {"NPC $ RearThigh", "NPC $ Thigh [$Thg]", 0.0f, -3.0f, -8.0f},
+        {"NPC $ Calf [$Clf]", "NPC $ Thigh [$Thg]", 0.0f, 0.0f, -26.0f},
+        {"NPC $ RearCalf [$rClf]", "NPC $ Calf [$Clf]", 0.0f, -3.0f, -6.0f},
+        {"NPC Genitals01 [Gen01]", "NPC Pelvis [Pelv]", 0.0f, 3.0f, -7.0f},
+        {"NPC Genitals02 [Gen02]", "NPC Genitals01 [Gen01]", 0.0f, 1.0f, 0.0f},
+        {"NPC Genitals03 [Gen03]", "NPC Genitals02 [Gen02]", 0.0f, 1.0f, 0.0f},
+        {"NPC Genitals04 [Gen04]", "NPC Genitals03 [Gen03]", 0.0f, 1.0f, 0.0f},
+        {"NPC Genitals05 [Gen05]", "NPC Genitals04 [Gen04]", 0.0f, 1.0f, 0.0f},
+        {"NPC Genitals06 [Gen06]", "NPC Genitals05 [Gen05]", 0.0f, 1.0f, 0.0f}
+    };
+
+    static constexpr float WALK_RADIUS = 300.0f;
+    static constexpr float WALK_SPEED = 0.4f;
+    static constexpr float STEP_FREQUENCY = 1.7f;
+    static constexpr float PI = 3.14159265358979f;
+
+    FrameTimer::FrameTimer(float a_fps, float a_jitter, std::uint32_t a_seed) :
+        m_interval(1.0f / std::max(a_fps, 1.0f)),
+        m_jitter(std::clamp(a_jitter, 0.0f, 1.0f)),
+        m_state(a_seed ? a_seed : 1)
+    {
+    }
+
+    float FrameTimer::Next()
+    {
+        // xorshift32, same sequence on every platform
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+
+        float r = static_cast<float>(m_state) / 4294967295.0f;
+
+        return m_interval * (1.0f + m_jitter * (r * 2.0f - 1.0f));
+    }
+
+    HeadlessTask::HeadlessTask() :
+        m_timeAccum(0.0f),
+        m_collisionStep(0),
+        m_nextHandle(1),
+        m_nextGroupId(0),
+        m_stats{ 0, 0, 0, 0.0, 0.0, 0, 0, 0.0, 0.0f }
+    {
+    }
+
+    HeadlessTask::~HeadlessTask()
+    {
+        ClearActors();
+    }
+
+    NiNode* HeadlessTask::CreateSkeleton()
+    {
+        auto root = new NiNode("NPC Root [Root]");
+
+        std::unordered_map<std::string, NiNode*> nodes;
+        nodes.emplace(root->m_name, root);
+
+        auto subst = [](const char* a_in, char a_side)
+        {
+            std::string r(a_in);
+            std::replace(r.begin(), r.end(), '$', a_side);
+            return r;
+        };
+
+        for (const auto& e : s_skeleton)
+        {
+            bool sided = std::strchr(e.name, '$') != nullptr;
+
+            for (char side : { 'L', 'R' })
+            {
+                auto name = subst(e.name, side);
+
+                auto node = new NiNode(name.c_str());
+                node->m_localTransform.pos = NiPoint3(
+                    side == 'R' ? -e.x : e.x, e.y, e.z);
+
+                nodes.at(subst(e.parent, side))->AttachChild(node);
+                nodes.emplace(std::move(name), node);
+
+                if (!sided)
+                    break;
+            }
+        }
+
+        NiAVObject::ControllerUpdateContext ctx{ 0.0f, 0 };
+        root->UpdateWorldData(&ctx);
+
+        return root;
+    }
+
+    SKSE::ObjectHandle HeadlessTask::AddActor(char a_sex, float a_weight)
+    {
+        auto& globalConfig = IConfig::GetGlobalConfig();
+
+        if (a_sex == 0 && globalConfig.general.femaleOnly)
+            return 0;
+
+        auto handle = m_nextHandle++;
+
+        actorEntry_t entry;
+
+        entry.npc = std::make_unique<TESNPC>();
+        entry.npc->weight = a_weight;
+        entry.npc->sex = a_sex;
+
+        entry.root = CreateSkeleton();
+        entry.actor = new Actor(entry.npc.get(), entry.root);
+
+        BSFixedString pelvis("NPC Pelvis [Pelv]");
+        BSFixedString spine("NPC Spine2 [Spn2]");
+
+        entry.pelvis = static_cast<NiNode*>(entry.root->GetObjectByName(&pelvis.data));
+        entry.spine = static_cast<NiNode*>(entry.root->GetObjectByName(&spine.data));
+
+        // spread actors out and start them at different points of the cycle
+        float a = static_cast<float>(handle) * 2.39996f;
+
+        entry.origin = NiPoint3(std::cos(a) * 2000.0f, std::sin(a) * 2000.0f, 0.0f);
+        entry.phase = static_cast<float>(handle) * 0.37f;
+
+        auto& actorConf = IConfig::GetActorConfAO(handle);
+        auto& nodeMap = IConfig::GetNodeMap();
+
+        nodeDescList_t descList;
+        if (!SimObject::CreateNodeDescriptorList(
+            handle,
+            entry.actor,
+            a_sex,
+            actorConf,
+            nodeMap,
+            globalConfig.phys.collisions,
+            descList))
+        {
+            return 0;
+        }
+
+        if (!AddActor(handle, entry.actor, a_sex, m_nextGroupId++, actorConf, descList))
+            return 0;
+
+        m_gameActors.emplace(handle, std::move(entry));
+
+        return handle;
+    }
+
+    bool HeadlessTask::AddActor(
+        SKSE::ObjectHandle a_handle,
+        Actor* a_actor,
+        char a_sex,
+        std::uint64_t a_id,
+        const configComponents_t& a_config,
+        const nodeDescList_t& a_desc)
+    {
+        if (m_actors.empty())
+            ICollision::SetBackend(static_cast<ICollision::Backend>(
+                IConfig::GetGlobalConfig().phys.collisionBackend));
+
+        auto r = m_actors.try_emplace(a_handle, a_handle, a_actor, a_sex, a_id, a_desc);
+        if (r.second)
+            m_recorder.OnAddActor(a_handle, a_actor, r.first->second, a_config);
+
+        return r.second;
+    }
+
+    NiAVObject* HeadlessTask::GetNode(SKSE::ObjectHandle a_handle, const char* a_name) const
+    {
+        auto it = m_gameActors.find(a_handle);
+        if (it == m_gameActors.end())
+            return nullptr;
+
+        BSFixedString name(a_name);
+
+        return it->second.root->GetObjectByName(&name.data);
+    }
+
+    void HeadlessTask::RemoveActor(SKSE::ObjectHandle a_handle)
+    {
+        auto it = m_actors.find(a_handle);
+        if (it != m_actors.end())
+        {
+            it->second.Release();
+            m_actors.erase(it);
+
+            m_recorder.OnRemoveActor(a_handle);
+        }
+
+        m_gameActors.erase(a_handle);
+    }
+
+    void HeadlessTask::ClearActors()
+    {
+        for (auto& e : m_actors)
+        {
+            m_recorder.OnRemoveActor(e.first);
+            e.second.Release();
+        }
+
+        m_actors.clear();
+        m_gameActors.clear();
+
+        // handles place and phase the actors, restart them so runs in one process repeat
+        m_nextHandle = 1;
+        m_nextGroupId = 0;
+    }
+
+    void HeadlessTask::UpdateConfig(SKSE::ObjectHandle a_handle, const configComponents_t& a_config)
+    {
+        auto it = m_actors.find(a_handle);
+        if (it == m_actors.end())
+            return;
+
+        auto& globalConfig = IConfig::GetGlobalConfig();
+
+        it->second.UpdateConfig(it->second.GetActor(), globalConfig.phys.collisions, a_config);
+
+        m_recorder.OnConfigUpdate(a_handle, it->second, a_config);
+    }
+
+    void HeadlessTask::ApplyForce(
+        SKSE::ObjectHandle a_handle,
+        std::uint32_t a_steps,
+        const std::string& a_component,
+        const NiPoint3& a_force)
+    {
+        m_recorder.OnApplyForce(a_handle, a_steps, a_component, a_force);
+
+        if (a_handle) {
+            auto it = m_actors.find(a_handle);
+            if (it != m_actors.end())
+                it->second.ApplyForce(a_steps, a_component, a_force);
+        }
+        else {
+            for (auto& e : m_actors)
+                e.second.ApplyForce(a_steps, a_component, a_force);
+        }
+    }
+
+    void HeadlessTask::PhysicsReset(SKSE::ObjectHandle a_handle)
+    {
+        auto it = m_actors.find(a_handle);
+        if (it == m_actors.end())
+            return;
+
+        it->second.Reset();
+        m_recorder.OnReset(a_handle);
+    }
+
+    bool HeadlessTask::StartRecording(const fs::path& a_path)
+    {
+        return m_recorder.Start(a_path, m_timeAccum);
+    }
+
+    void HeadlessTask::StopRecording()
+    {
+        m_recorder.Stop();
+    }
+
+    void HeadlessTask::Animate(float a_time)
+    {
+        NiAVObject::ControllerUpdateContext ctx{ 0.0f, 0 };
+
+        for (auto& e : m_gameActors)
+        {
+            auto& entry = e.second;
+
+            float t = a_time + entry.phase;
+
+            // walk a circle around the spawn point, facing along it
+            float a = t * WALK_SPEED;
+
+            auto& root = entry.root->m_localTransform;
+
+            root.pos = entry.origin + NiPoint3(
+                std::cos(a) * WALK_RADIUS,
+                std::sin(a) * WALK_RADIUS,
+                0.0f);
+
+            root.rot.SetEulerAngles(0.0f, a + PI * 0.5f, 0.0f);
+
+            float s = t * STEP_FREQUENCY * PI * 2.0f;
+
+            auto& pelvis = entry.pelvis->m_localTransform;
+
+            pelvis.pos.z = std::abs(std::sin(s)) * 2.5f;
+            pelvis.rot.SetEulerAngles(0.0f, std::sin(s * 0.5f) * 0.12f, std::sin(s) * 0.04f);
+
+            entry.spine->m_localTransform.rot.SetEulerAngles(
+                std::sin(s * 0.5f + 0.3f) * 0.06f, -std::sin(s * 0.5f) * 0.15f, 0.0f);
+
+            entry.root->UpdateWorldData(&ctx);
+            entry.actor->pos = entry.root->m_worldTransform.pos;
+        }
+    }
+
+    void HeadlessTask::UpdatePhase2(float a_timeTick, std::uint32_t a_steps)
+    {
+        for (std::uint32_t i = 0; i < a_steps; i++)
+            m_store.UpdateMovement(a_timeTick, m_workers);
+    }
+
+    void HeadlessTask::UpdatePhase2Collisions(float a_timeTick, std::uint32_t a_steps)
+    {
+        ICollision::SetTimeStep(a_timeTick);
+
+        if (ICollision::GetBackend() == ICollision::Backend::kSpheres)
+        {
+            auto& world = DCBP::GetSphereWorld();
+
+            auto interval = static_cast<std::uint32_t>(
+                std::max(IConfig::GetGlobalConfig().phys.collisionInterval, 1));
+
+            for (std::uint32_t i = 0; i < a_steps; i++)
+            {
+                m_store.UpdateMovement(a_timeTick, m_workers);
+
+                PerfTimer pt;
+                pt.Start();
+
+                bool detect = m_collisionStep == 0;
+
+                if (detect)
+                    world.Update();
+                else
+                    world.UpdatePairs();
+
+                m_stats.collisionTime += pt.Stop();
+
+                if (++m_collisionStep >= interval)
+                    m_collisionStep = 0;
+
+                if (detect)
+                {
+                    m_stats.detections++;
+
+                    for (const auto& e : world.GetContacts())
+                    {
+                        if (e.event == SphereWorld::ContactEvent::kExit)
+                            continue;
+
+                        m_stats.detectedContacts++;
+                        m_stats.depthSum += e.depth;
+                        m_stats.maxDepth = std::max(m_stats.maxDepth, e.depth);
+                    }
+                }
+
+                ICollision::ProcessContacts(world.GetContacts());
+            }
+
+            return;
+        }
+
+        auto world = DCBP::GetWorld();
+
+        for (std::uint32_t i = 0; i < a_steps; i++)
+        {
+            m_store.UpdateMovement(a_timeTick, m_workers);
+            world->update(a_timeTick);
+        }
+    }
+
+    void HeadlessTask::PhysicsTick(float a_interval)
+    {
+        if (a_interval < _EPSILON)
+            return;
+
+        _MM_SET_FLUSH_ZERO_MODE(_MM_FLUSH_ZERO_ON);
+
+        PerfTimer pt;
+        pt.Start();
+
+        m_recorder.OnTickBegin();
+
+        auto& globalConf = IConfig::GetGlobalConfig();
+
+        m_workers.SetNumWorkers(static_cast<std::uint32_t>(
+            std::max(globalConf.phys.numThreads, 0)));
+
+        auto timeTick = globalConf.phys.timeTick;
+        auto maxSteps = std::max(static_cast<std::uint32_t>(globalConf.phys.maxSubSteps), 1U);
+
+        m_timeAccum += a_interval;
+
+        auto steps = std::min(static_cast<std::uint32_t>(m_timeAccum / timeTick), maxSteps);
+
+        // no camera, every actor stays in the near LOD tier and nothing is deferred
+        if (steps > 0)
+        {
+            m_store.UpdateVelocity(m_workers);
+
+            m_store.ResetSimulatedCount();
+
+            if (globalConf.phys.collisions)
+                UpdatePhase2Collisions(timeTick, steps);
+            else
+                UpdatePhase2(timeTick, steps);
+
+            m_stats.nodeSteps += m_store.GetSimulatedCount();
+
+            m_timeAccum -= timeTick * static_cast<float>(steps);
+        }
+
+        m_timeAccum = std::min(m_timeAccum, timeTick);
+
+        m_store.Interpolate(m_timeAccum / timeTick, m_workers);
+
+        m_recorder.OnFrame(a_interval, m_actors);
+
+        m_stats.frames++;
+        m_stats.steps += steps;
+        m_stats.physicsTime += pt.Stop();
+    }
+
+    std::uint64_t HeadlessTask::GetStateHash() const
+    {
+        std::uint64_t hash = 14695981039346656037ULL;
+
+        auto add = [&](float a_value)
+        {
+            std::uint32_t bits;
+            std::memcpy(std::addressof(bits), std::addressof(a_value), sizeof(bits));
+
+            for (int i = 0; i < 4; i++)
+            {
+                hash ^= (bits >> (i * 8)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+        };
+
+        std::vector<SKSE::ObjectHandle> handles;
+        for (const auto& e : m_actors)
+            handles.emplace_back(e.first);
+
+        std::sort(handles.begin(), handles.end());
+
+        std::vector<std::pair<const std::string*, const SimComponent*>> nodes;
+
+        for (auto h : handles)
+        {
+            nodes.clear();
+            for (const auto& e : m_actors.at(h))
+                nodes.emplace_back(std::addressof(e.first), std::addressof(e.second));
+
+            std::sort(nodes.begin(), nodes.end(),
+                [](const auto& a_lhs, const auto& a_rhs) { return *a_lhs.first < *a_rhs.first; });
+
+            for (const auto& e : nodes)
+            {
+                auto& pos = e.second->GetPos();
+
+                add(pos.x);
+                add(pos.y);
+                add(pos.z);
+            }
+        }
+
+        return hash;
+    }
+
+    DCBP::DCBP() :
+        m_world(m_physicsCommon.createPhysicsWorld())
+    {
+    }
+
+    void DCBP::Initialize()
+    {
+        ISimKernel::Initialize();
+
+        IConfig::LoadConfig();
+
+        m_Instance.m_world->setEventListener(std::addressof(ICollision::GetSingleton()));
+        ICollision::Initialize(m_Instance.m_world);
+
+        configNodes_t nodes;
+
+        for (const auto& e : IConfig::GetNodeMap())
+            nodes.emplace(e.first, configNode_t{ true, true, true, true });
+
+        IConfig::SetGlobalNodeConfig(std::move(nodes));
+    }
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+#pragma once
+
+namespace CBP
+{
+    // Stands in for Game::frameTimerSlow. Each interval varies by up to a_jitter (fraction of
+    // 1 / a_fps), the sequence only depends on a_seed.
+    class FrameTimer
+    {
+    public:
+        FrameTimer(float a_fps, float a_jitter, std::uint32_t a_seed);
+
+        [[nodiscard]] float Next();
+
+    private:
+        float m_interval;
+        float m_jitter;
+        std::uint32_t m_state;
+    };
+
+    // Runs the simulation the way UpdateTask::PhysicsTick does, on actors with a generated
+    // skeleton driven by a scripted walk cycle instead of the game's animation.
+    class HeadlessTask
+    {
+        struct actorEntry_t
+        {
+            std::unique_ptr<TESNPC> npc;
+            NiPointer<Actor> actor;
+            NiPointer<NiNode> root;
+            NiPointer<NiNode> pelvis;
+            NiPointer<NiNode> spine;
+            NiPoint3 origin;
+            float phase;
+        };
+
+    public:
+        struct stats_t
+        {
+            std::uint64_t frames;
+            std::uint64_t steps;
+            std::uint64_t nodeSteps;
+            // seconds spent in PhysicsTick
+            double physicsTime;
+            // seconds spent in SphereWorld::Update/UpdatePairs
+            double collisionTime;
+            // full detections and the contacts they reported (no exits), penetration depth
+            // at detection shows what the steps in between missed
+            std::uint64_t detections;
+            std::uint64_t detectedContacts;
+            double depthSum;
+            float maxDepth;
+        };
+
+        HeadlessTask();
+        ~HeadlessTask();
+
+        HeadlessTask(const HeadlessTask&) = delete;
+        HeadlessTask& operator=(const HeadlessTask&) = delete;
+
+        // builds a skeleton and adds it the way UpdateTask::AddActor does, returns 0 if
+        // none of its nodes are simulated
+        SKSE::ObjectHandle AddActor(char a_sex, float a_weight);
+        // adds an actor whose nodes are owned by the caller
+        bool AddActor(
+            SKSE::ObjectHandle a_handle,
+            Actor* a_actor,
+            char a_sex,
+            std::uint64_t a_id,
+            const configComponents_t& a_config,
+            const nodeDescList_t& a_desc);
+        void RemoveActor(SKSE::ObjectHandle a_handle);
+        void ClearActors();
+
+        void UpdateConfig(SKSE::ObjectHandle a_handle, const configComponents_t& a_config);
+        void ApplyForce(SKSE::ObjectHandle a_handle, std::uint32_t a_steps, const std::string& a_component, const NiPoint3& a_force);
+        void PhysicsReset(SKSE::ObjectHandle a_handle);
+
+        // poses every skeleton at a_time seconds and updates its world transforms
+        void Animate(float a_time);
+
+        void PhysicsTick(float a_interval);
+
+        // FNV-1a over the world positions of all simulated nodes, by handle and node name
+        [[nodiscard]] std::uint64_t GetStateHash() const;
+
+        // records everything added after this call, see MotionRecorder
+        bool StartRecording(const fs::path& a_path);
+        void StopRecording();
+
+        [[nodiscard]] inline const auto& GetSimActorList() const {
+            return m_actors;
+        }
+
+        [[nodiscard]] inline SimObject* GetSimObject(SKSE::ObjectHandle a_handle) {
+            auto it = m_actors.find(a_handle);
+            return it != m_actors.end() ? std::addressof(it->second) : nullptr;
+        }
+
+        // a node of the actor's skeleton, null if it has none by that name
+        [[nodiscard]] NiAVObject* GetNode(SKSE::ObjectHandle a_handle, const char* a_name) const;
+
+        inline void SetTimeAccum(float a_value) {
+            m_timeAccum = a_value;
+        }
+
+        [[nodiscard]] inline auto& GetSimStore() {
+            return m_store;
+        }
+
+        [[nodiscard]] inline auto& GetWorkerPool() {
+            return m_workers;
+        }
+
+        [[nodiscard]] inline const auto& GetStats() const {
+            return m_stats;
+        }
+
+        inline void ResetStats() {
+            m_stats = stats_t{ 0, 0, 0, 0.0, 0.0, 0, 0, 0.0, 0.0f };
+        }
+
+    private:
+        static NiNode* CreateSkeleton();
+
+        void UpdatePhase2(float a_timeTick, std::uint32_t a_steps);
+        void UpdatePhase2Collisions(float a_timeTick, std::uint32_t a_steps);
+
+        SimStore m_store;
+        WorkerPool m_workers;
+
+        simActorList_t m_actors;
+        std::unordered_map<SKSE::ObjectHandle, actorEntry_t> m_gameActors;
+
+        float m_timeAccum;
+        std::uint32_t m_collisionStep;
+        SKSE::ObjectHandle m_nextHandle;
+        std::uint64_t m_nextGroupId;
+
+        stats_t m_stats;
+
+        MotionRecorder m_recorder;
+    };
+
+    // The parts of the plugin driver the simulation sources call into.
+    class DCBP
+    {
+    public:
+        // Loads Nodes.json and CBPConfig.txt from CBP_HEADLESS_DATA_PATH and enables
+        // movement and collisions on every mapped node for both sexes.
+        static void Initialize();
+
+        [[nodiscard]] inline static auto& GetUpdateTask() {
+            return m_Instance.m_updateTask;
+        }
+
+        [[nodiscard]] inline static auto GetWorld() {
+            return m_Instance.m_world;
+        }
+
+        [[nodiscard]] inline static auto& GetPhysicsCommon() {
+            return m_Instance.m_physicsCommon;
+        }
+
+        [[nodiscard]] inline static auto& GetSphereWorld() {
+            return m_Instance.m_sphereWorld;
+        }
+
+        [[nodiscard]] inline static auto& GetSimStore() {
+            return m_Instance.m_updateTask.GetSimStore();
+        }
+
+    private:
+        DCBP();
+
+        r3d::PhysicsCommon m_physicsCommon;
+        r3d::PhysicsWorld* m_world;
+        SphereWorld m_sphereWorld;
+
+        HeadlessTask m_updateTask;
+
+        static DCBP m_Instance;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "pch.h"
+
+void NiMatrix33::Identity()
+{
+    data[0][0] = 1.0f; data[0][1] = 0.0f; data[0][2] = 0.0f;
+    data[1][0] = 0.0f; data[1][1] = 1.0f; data[1][2] = 0.0f;
+    data[2][0] = 0.0f; data[2][1] = 0.0f; data[2][2] = 1.0f;
+}
+
+void NiMatrix33::SetEulerAngles(float a_heading, float a_attitude, float a_bank)
+{
+    double ch = std::cos(a_heading);
+    double sh = std::sin(a_heading);
+    double ca = std::cos(a_attitude);
+    double sa = std::sin(a_attitude);
+    double cb = std::cos(a_bank);
+    double sb = std::sin(a_bank);
+
+    data[0][0] = static_cast<float>(ch * ca);
+    data[0][1] = static_cast<float>(sh * sb - ch * sa * cb);
+    data[0][2] = static_cast<float>(ch * sa * sb + sh * cb);
+    data[1][0] = static_cast<float>(sa);
+    data[1][1] = static_cast<float>(ca * cb);
+    data[1][2] = static_cast<float>(-ca * sb);
+    data[2][0] = static_cast<float>(-sh * ca);
+    data[2][1] = static_cast<float>(sh * sa * cb + ch * sb);
+    data[2][2] = static_cast<float>(-sh * sa * sb + ch * cb);
+}
+
+NiMatrix33 NiMatrix33::Transpose() const
+{
+    NiMatrix33 result;
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            result.data[i][j] = data[j][i];
+
+    return result;
+}
+
+NiMatrix33 NiMatrix33::operator*(const NiMatrix33& a_rhs) const
+{
+    NiMatrix33 result;
+
+    for (int i = 0; i < 3; i++)
+        for (int j = 0; j < 3; j++)
+            result.data[i][j] =
+                data[i][0] * a_rhs.data[0][j] +
+                data[i][1] * a_rhs.data[1][j] +
+                data[i][2] * a_rhs.data[2][j];
+
+    return result;
+}
+
+NiPoint3 NiMatrix33::operator*(const NiPoint3& a_pt) const
+{
+    return NiPoint3(
+        data[0][0] * a_pt.x + data[0][1] * a_pt.y + data[0][2] * a_pt.z,
+        data[1][0] * a_pt.x + data[1][1] * a_pt.y + data[1][2] * a_pt.z,
+        data[2][0] * a_pt.x + data[2][1] * a_pt.y + data[2][2] * a_pt.z);
+}
+
+NiTransform NiTransform::operator*(const NiTransform& a_rhs) const
+{
+    NiTransform result;
+
+    result.scale = scale * a_rhs.scale;
+    result.rot = rot * a_rhs.rot;
+    result.pos = pos + (rot * a_rhs.pos) * scale;
+
+    return result;
+}
+
+NiPoint3 NiTransform::operator*(const NiPoint3& a_pt) const
+{
+    return ((rot * a_pt) * scale) + pos;
+}
+
+NiAVObject::NiAVObject(const char* a_name) :
+    m_nameStorage(a_name ? a_name : "")
+{
+    m_name = m_nameStorage.c_str();
+}
+
+NiAVObject* NiAVObject::GetObjectByName(const char** a_name)
+{
+    return std::strcmp(m_name, *a_name) == 0 ? this : nullptr;
+}
+
+void NiAVObject::UpdateWorldData(ControllerUpdateContext*)
+{
+    if (m_parent)
+        m_worldTransform = m_parent->m_worldTransform * m_localTransform;
+    else
+        m_worldTransform = m_localTransform;
+}
+
+NiAVObject* NiNode::GetObjectByName(const char** a_name)
+{
+    if (std::strcmp(m_name, *a_name) == 0)
+        return this;
+
+    for (auto& e : m_children)
+    {
+        auto r = e->GetObjectByName(a_name);
+        if (r != nullptr)
+            return r;
+    }
+
+    return nullptr;
+}
+
+void NiNode::UpdateWorldData(ControllerUpdateContext* a_ctx)
+{
+    NiAVObject::UpdateWorldData(a_ctx);
+
+    for (auto& e : m_children)
+        e->UpdateWorldData(a_ctx);
+}
+
+void NiNode::AttachChild(NiAVObject* a_child)
+{
+    a_child->m_parent = this;
+    m_children.emplace_back(a_child);
+}
\ No newline at end of file
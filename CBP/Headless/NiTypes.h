@@ -0,0 +1,257 @@
+#pragma once
+
+// Stand-ins for the parts of the scene graph the simulation touches: a node has a local and a
+// world transform, a parent and (for NiNode) children, and UpdateWorldData walks the subtree
+// the way the engine does after animation. Math matches skse64/NiTypes.
+
+class NiPoint3
+{
+public:
+    float x;
+    float y;
+    float z;
+
+    NiPoint3() :
+        x(0.0f), y(0.0f), z(0.0f)
+    {}
+
+    NiPoint3(float a_x, float a_y, float a_z) :
+        x(a_x), y(a_y), z(a_z)
+    {}
+
+    inline NiPoint3 operator-() const {
+        return NiPoint3(-x, -y, -z);
+    }
+
+    inline NiPoint3 operator+(const NiPoint3& a_rhs) const {
+        return NiPoint3(x + a_rhs.x, y + a_rhs.y, z + a_rhs.z);
+    }
+
+    inline NiPoint3 operator-(const NiPoint3& a_rhs) const {
+        return NiPoint3(x - a_rhs.x, y - a_rhs.y, z - a_rhs.z);
+    }
+
+    inline NiPoint3 operator*(float a_scalar) const {
+        return NiPoint3(x * a_scalar, y * a_scalar, z * a_scalar);
+    }
+
+    inline NiPoint3 operator/(float a_scalar) const {
+        return NiPoint3(x / a_scalar, y / a_scalar, z / a_scalar);
+    }
+
+    inline NiPoint3& operator+=(const NiPoint3& a_rhs) {
+        x += a_rhs.x; y += a_rhs.y; z += a_rhs.z;
+        return *this;
+    }
+
+    inline NiPoint3& operator-=(const NiPoint3& a_rhs) {
+        x -= a_rhs.x; y -= a_rhs.y; z -= a_rhs.z;
+        return *this;
+    }
+
+    inline NiPoint3& operator*=(float a_scalar) {
+        x *= a_scalar; y *= a_scalar; z *= a_scalar;
+        return *this;
+    }
+
+    inline NiPoint3& operator/=(float a_scalar) {
+        x /= a_scalar; y /= a_scalar; z /= a_scalar;
+        return *this;
+    }
+
+    [[nodiscard]] inline float Length() const {
+        return std::sqrt(x * x + y * y + z * z);
+    }
+};
+
+class NiMatrix33
+{
+public:
+    float data[3][3];
+
+    NiMatrix33() {
+        Identity();
+    }
+
+    void Identity();
+    void SetEulerAngles(float a_heading, float a_attitude, float a_bank);
+
+    [[nodiscard]] NiMatrix33 Transpose() const;
+
+    NiMatrix33 operator*(const NiMatrix33& a_rhs) const;
+    NiPoint3 operator*(const NiPoint3& a_pt) const;
+};
+
+class NiTransform
+{
+public:
+    NiMatrix33 rot;
+    NiPoint3 pos;
+    float scale = 1.0f;
+
+    NiTransform operator*(const NiTransform& a_rhs) const;
+    NiPoint3 operator*(const NiPoint3& a_pt) const;
+};
+
+class NiRefObject
+{
+public:
+    NiRefObject() = default;
+    virtual ~NiRefObject() = default;
+
+    NiRefObject(const NiRefObject&) = delete;
+    NiRefObject& operator=(const NiRefObject&) = delete;
+
+    inline void IncRef() {
+        m_uiRefCount++;
+    }
+
+    inline void DecRef() {
+        if (--m_uiRefCount == 0)
+            delete this;
+    }
+
+    std::atomic<std::uint32_t> m_uiRefCount = 0;
+};
+
+template <class T>
+class NiPointer
+{
+public:
+    NiPointer(T* a_object = nullptr) :
+        m_pObject(a_object)
+    {
+        if (m_pObject)
+            m_pObject->IncRef();
+    }
+
+    NiPointer(const NiPointer& a_rhs) :
+        NiPointer(a_rhs.m_pObject)
+    {}
+
+    ~NiPointer()
+    {
+        if (m_pObject)
+            m_pObject->DecRef();
+    }
+
+    inline NiPointer& operator=(const NiPointer& a_rhs) {
+        return *this = a_rhs.m_pObject;
+    }
+
+    inline NiPointer& operator=(T* a_rhs)
+    {
+        if (a_rhs != m_pObject)
+        {
+            if (a_rhs)
+                a_rhs->IncRef();
+            if (m_pObject)
+                m_pObject->DecRef();
+
+            m_pObject = a_rhs;
+        }
+
+        return *this;
+    }
+
+    inline operator T* () const {
+        return m_pObject;
+    }
+
+    inline T& operator*() const {
+        return *m_pObject;
+    }
+
+    inline T* operator->() const {
+        return m_pObject;
+    }
+
+    inline bool operator==(const NiPointer& a_rhs) const {
+        return m_pObject == a_rhs.m_pObject;
+    }
+
+    inline bool operator!=(const NiPointer& a_rhs) const {
+        return m_pObject != a_rhs.m_pObject;
+    }
+
+    inline bool operator==(T* a_rhs) const {
+        return m_pObject == a_rhs;
+    }
+
+    inline bool operator!=(T* a_rhs) const {
+        return m_pObject != a_rhs;
+    }
+
+private:
+    T* m_pObject;
+};
+
+class BSFixedString
+{
+public:
+    BSFixedString(const char* a_data) :
+        m_str(a_data ? a_data : ""),
+        data(m_str.c_str())
+    {}
+
+    BSFixedString(const BSFixedString&) = delete;
+    BSFixedString& operator=(const BSFixedString&) = delete;
+
+private:
+    std::string m_str;
+
+public:
+    const char* data;
+};
+
+class NiNode;
+
+class NiAVObject :
+    public NiRefObject
+{
+public:
+    struct ControllerUpdateContext
+    {
+        float delta;
+        std::uint32_t flags;
+    };
+
+    NiAVObject(const char* a_name);
+
+    [[nodiscard]] virtual NiNode* GetAsNiNode() {
+        return nullptr;
+    }
+
+    [[nodiscard]] virtual NiAVObject* GetObjectByName(const char** a_name);
+
+    // world = parent world * local, then the same for everything below
+    virtual void UpdateWorldData(ControllerUpdateContext* a_ctx);
+
+    NiNode* m_parent = nullptr;
+    const char* m_name;
+
+    NiTransform m_localTransform;
+    NiTransform m_worldTransform;
+
+private:
+    // backs m_name, the game's names are interned BSFixedStrings
+    std::string m_nameStorage;
+};
+
+class NiNode :
+    public NiAVObject
+{
+public:
+    using NiAVObject::NiAVObject;
+
+    [[nodiscard]] virtual NiNode* GetAsNiNode() override {
+        return this;
+    }
+
+    [[nodiscard]] virtual NiAVObject* GetObjectByName(const char** a_name) override;
+    virtual void UpdateWorldData(ControllerUpdateContext* a_ctx) override;
+
+    void AttachChild(NiAVObject* a_child);
+
+    std::vector<NiPointer<NiAVObject>> m_children;
+};
\ No newline at end of file
@@ -0,0 +1,290 @@
+#include "pch.h"
+
+namespace CBP
+{
+    using namespace Recording;
+
+    MotionReplay::MotionReplay(HeadlessTask& a_task) :
+        m_task(a_task),
+        m_frames(0),
+        m_time(0.0f)
+    {
+    }
+
+    MotionReplay::~MotionReplay()
+    {
+        for (const auto& e : m_actors)
+            m_task.RemoveActor(e.first);
+    }
+
+    bool MotionReplay::Open(const fs::path& a_path)
+    {
+        if (!m_reader.Open(a_path))
+            return false;
+
+        m_task.SetTimeAccum(m_reader.GetTimeAccum());
+
+        return true;
+    }
+
+    bool MotionReplay::Step()
+    {
+        try
+        {
+            RecordType type;
+
+            while (m_reader.Next(type))
+            {
+                switch (type)
+                {
+                case RecordType::kGlobals:
+                    m_reader.Read(m_globals);
+                    ApplyGlobals(m_globals);
+                    break;
+                case RecordType::kConfig:
+                    m_reader.Read(m_config);
+                    m_configs.insert_or_assign(m_config.id, m_config.components);
+                    break;
+                case RecordType::kAddActor:
+                    m_reader.Read(m_addActor);
+                    AddActor(m_addActor);
+                    break;
+                case RecordType::kActorConfig:
+                    m_reader.Read(m_actorConfig);
+                    SetNodeConfig(m_actorConfig.handle, m_actorConfig.flags);
+                    m_task.UpdateConfig(m_actorConfig.handle, m_configs.at(m_actorConfig.configId));
+                    break;
+                case RecordType::kForce:
+                    m_reader.Read(m_force);
+                    m_task.ApplyForce(m_force.handle, m_force.steps, m_force.component, m_force.force);
+                    break;
+                case RecordType::kReset:
+                    m_task.PhysicsReset(m_reader.ReadHandle());
+                    break;
+                case RecordType::kRemoveActor:
+                    RemoveActor(m_reader.ReadHandle());
+                    break;
+                case RecordType::kFrame:
+                    m_reader.Read(m_frame);
+                    ApplyFrame(m_frame);
+
+                    m_task.PhysicsTick(m_frame.interval);
+
+                    m_time += m_frame.interval;
+                    m_frames++;
+
+                    return true;
+                }
+            }
+        }
+        catch (const std::exception& e)
+        {
+            Error("%s: %s", __FUNCTION__, e.what());
+        }
+
+        return false;
+    }
+
+    void MotionReplay::ApplyGlobals(const globals_t& a_in)
+    {
+        auto& phys = IConfig::GetGlobalConfig().phys;
+
+        // thread count is the host's choice, results don't depend on it
+        auto numThreads = phys.numThreads;
+
+        phys = a_in.phys;
+        phys.numThreads = numThreads;
+
+        IConfig::SetNodeChains(a_in.chains);
+    }
+
+    void MotionReplay::SetNodeConfig(
+        SKSE::ObjectHandle a_handle,
+        const std::vector<nodeFlags_t>& a_flags)
+    {
+        configNodes_t nodes;
+
+        for (const auto& e : a_flags)
+        {
+            bool collisions = (e.flags & kNodeCollisions) != 0;
+            bool movement = (e.flags & kNodeMovement) != 0;
+
+            nodes.emplace(e.name, configNode_t{ movement, collisions, movement, collisions });
+        }
+
+        IConfig::SetActorNodeConfig(a_handle, std::move(nodes));
+    }
+
+    void MotionReplay::UpdateDriven(actorEntry_t& a_entry, const std::vector<NiTransform>& a_in)
+    {
+        NiAVObject::ControllerUpdateContext ctx{ 0.0f, 0 };
+
+        auto& driven = a_entry.driven;
+
+        if (driven.size() != a_in.size())
+            throw std::runtime_error("Driven node count mismatch");
+
+        for (std::size_t i = 0; i < driven.size(); i++)
+        {
+            if (driven[i].local)
+                driven[i].node->m_localTransform = a_in[i];
+        }
+
+        // world space transforms are used as is, not rebuilt from the parent, then
+        // everything below them (simulated nodes included) is updated
+        for (std::size_t i = 0; i < driven.size(); i++)
+        {
+            auto& node = driven[i].node;
+
+            if (driven[i].local)
+                continue;
+
+            node->m_localTransform = a_in[i];
+            node->m_worldTransform = a_in[i];
+
+            for (auto& e : node->m_children)
+                e->UpdateWorldData(std::addressof(ctx));
+        }
+    }
+
+    void MotionReplay::AddActor(const addActor_t& a_in)
+    {
+        RemoveActor(a_in.handle);
+
+        auto& conf = m_configs.at(a_in.configId);
+
+        actorEntry_t entry;
+
+        entry.npc = std::make_unique<TESNPC>();
+        entry.npc->weight = a_in.weight;
+        entry.npc->sex = a_in.sex;
+
+        entry.root = new NiNode("NPC Root [Root]");
+        entry.actor = new Actor(entry.npc.get(), entry.root);
+
+        std::unordered_map<std::string, NiNode*> nodes;
+        std::vector<NiTransform> drivenState;
+
+        for (const auto& e : a_in.driven)
+        {
+            auto node = new NiNode(e.name.c_str());
+
+            bool local = !e.parent.empty();
+            if (!local)
+                entry.root->AttachChild(node);
+
+            entry.driven.emplace_back(drivenEntry_t{ node, local });
+            drivenState.emplace_back(e.transform);
+
+            nodes.emplace(e.name, node);
+        }
+
+        std::vector<NiNode*> simNodes;
+
+        for (const auto& e : a_in.nodes)
+        {
+            auto node = new NiNode(e.name.c_str());
+            node->m_localTransform = e.local;
+
+            simNodes.emplace_back(node);
+            entry.nodes.emplace_back(node);
+            nodes.emplace(e.name, node);
+        }
+
+        auto attach = [&](const std::string& a_parent, NiNode* a_node)
+        {
+            auto it = nodes.find(a_parent);
+            if (it == nodes.end())
+                throw std::runtime_error("Missing parent node");
+
+            it->second->AttachChild(a_node);
+        };
+
+        for (std::size_t i = 0; i < a_in.driven.size(); i++)
+        {
+            if (entry.driven[i].local)
+                attach(a_in.driven[i].parent, entry.driven[i].node);
+        }
+
+        for (std::size_t i = 0; i < a_in.nodes.size(); i++)
+            attach(a_in.nodes[i].parent, simNodes[i]);
+
+        UpdateDriven(entry, drivenState);
+
+        SetNodeConfig(a_in.handle, a_in.flags);
+
+        auto& globalConfig = IConfig::GetGlobalConfig();
+
+        nodeDescList_t descList;
+
+        for (std::size_t i = 0; i < a_in.nodes.size(); i++)
+        {
+            auto& e = a_in.nodes[i];
+
+            auto it = conf.find(e.confGroup);
+            if (it == conf.end())
+                throw std::runtime_error("Missing config group");
+
+            configNode_t nodeConf;
+            IConfig::GetActorNodeConfig(a_in.handle, e.name, nodeConf);
+
+            bool collisions, movement;
+            nodeConf.Get(a_in.sex, collisions, movement);
+
+            descList.emplace_back(
+                nodeDesc_t{
+                    e.name,
+                    simNodes[i],
+                    it->first,
+                    it->second,
+                    globalConfig.phys.collisions && collisions,
+                    movement });
+        }
+
+        if (!m_task.AddActor(a_in.handle, entry.actor, a_in.sex, a_in.id, conf, descList))
+            return;
+
+        m_actors.emplace(a_in.handle, std::move(entry));
+    }
+
+    void MotionReplay::RemoveActor(SKSE::ObjectHandle a_handle)
+    {
+        auto it = m_actors.find(a_handle);
+        if (it == m_actors.end())
+            return;
+
+        m_task.RemoveActor(a_handle);
+        m_actors.erase(it);
+
+        IConfig::EraseActorNodeConfig(a_handle);
+    }
+
+    void MotionReplay::ApplyFrame(const frame_t& a_in)
+    {
+        for (const auto& e : a_in.actors)
+        {
+            auto it = m_actors.find(e.handle);
+            if (it == m_actors.end())
+                continue;
+
+            auto& nodes = it->second.nodes;
+
+            for (const auto& n : e.animated)
+            {
+                if (n.first >= nodes.size())
+                    throw std::runtime_error("Node index out of range");
+
+                nodes[n.first]->m_localTransform = n.second;
+            }
+
+            UpdateDriven(it->second, e.driven);
+
+            auto obj = m_task.GetSimObject(e.handle);
+            if (obj == nullptr)
+                continue;
+
+            obj->SetLOD(e.lodTier, e.lodInterval);
+            obj->SetDeferred(e.deferred);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+namespace CBP
+{
+    // Feeds a MotionRecorder stream through HeadlessTask. Each actor gets a node set rebuilt
+    // from the recording: the driven nodes placed at their recorded transforms and the
+    // simulated nodes below them, so the simulation sees what it saw when recording.
+    class MotionReplay :
+        ILog
+    {
+        struct drivenEntry_t
+        {
+            NiPointer<NiNode> node;
+            // below a simulated node, transform is local
+            bool local;
+        };
+
+        struct actorEntry_t
+        {
+            std::unique_ptr<TESNPC> npc;
+            NiPointer<Actor> actor;
+            NiPointer<NiNode> root;
+            std::vector<drivenEntry_t> driven;
+            std::vector<NiPointer<NiNode>> nodes;
+        };
+
+    public:
+        MotionReplay(HeadlessTask& a_task);
+        ~MotionReplay();
+
+        MotionReplay(const MotionReplay&) = delete;
+        MotionReplay& operator=(const MotionReplay&) = delete;
+
+        bool Open(const fs::path& a_path);
+
+        // applies records up to the next frame and runs PhysicsTick with its interval,
+        // false at the end of the recording
+        bool Step();
+
+        [[nodiscard]] inline std::uint64_t GetFrames() const noexcept {
+            return m_frames;
+        }
+
+        [[nodiscard]] inline float GetTime() const noexcept {
+            return m_time;
+        }
+
+        FN_NAMEPROC("MotionReplay")
+    private:
+        void ApplyGlobals(const Recording::globals_t& a_in);
+        void AddActor(const Recording::addActor_t& a_in);
+        void RemoveActor(SKSE::ObjectHandle a_handle);
+        void ApplyFrame(const Recording::frame_t& a_in);
+
+        static void SetNodeConfig(
+            SKSE::ObjectHandle a_handle,
+            const std::vector<Recording::nodeFlags_t>& a_flags);
+
+        static void UpdateDriven(actorEntry_t& a_entry, const std::vector<NiTransform>& a_in);
+
+        HeadlessTask& m_task;
+        MotionReader m_reader;
+
+        std::unordered_map<SKSE::ObjectHandle, actorEntry_t> m_actors;
+        std::unordered_map<std::uint32_t, configComponents_t> m_configs;
+
+        Recording::globals_t m_globals;
+        Recording::config_t m_config;
+        Recording::addActor_t m_addActor;
+        Recording::actorConfig_t m_actorConfig;
+        Recording::force_t m_force;
+        Recording::frame_t m_frame;
+
+        std::uint64_t m_frames;
+        float m_time;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,1061 @@
+#include "pch.h"
+
+using namespace CBP;
+
+// Microbenchmarks for the hot paths that don't show up in the in-game profiler on their own.
+// Every case is sampled until --min-time seconds of measured time have accumulated, only the
+// measured call is timed (animation, setup and the like are not).
+
+static constexpr std::size_t MIN_SAMPLES = 10;
+static constexpr std::size_t MAX_SAMPLES = 100000;
+static constexpr std::uint32_t CONTACT_ACTORS = 10;
+static constexpr std::uint32_t CROWD_SPHERES = 32;
+static constexpr std::uint32_t FRAME_STEPS = 5;
+static constexpr std::uint32_t INTEGRATOR_NODES = 256;
+static constexpr float INTEGRATOR_TIME_STEP = 1.0f / 30.0f;
+static constexpr std::uint32_t BACKEND_STEPS = 10;
+
+struct options_t
+{
+    std::vector<std::uint32_t> actors{ 1, 10, 50 };
+    std::vector<std::uint32_t> pairs{ 64, 512, 4096 };
+    std::vector<std::uint32_t> spheres{ 1000, 4000 };
+    int threads = 0;
+    int level = 1;
+    double minTime = 0.5;
+    std::string filter;
+    std::string json;
+};
+
+struct result_t
+{
+    std::string name;
+    Json::Value params;
+    // seconds per sample
+    std::vector<double> samples;
+    // nodes, pairs, actors processed over all samples
+    std::uint64_t items;
+};
+
+static void PrintUsage(const char* a_exe)
+{
+    std::printf(
+        "usage: %s [options]\n"
+        "  --actors <n,...>    actor counts (1,10,50)\n"
+        "  --pairs <n,...>     contact pair counts, %u actors (64,512,4096)\n"
+        "  --spheres <n,...>   sphere counts for the collision world (1000,4000)\n"
+        "  --threads <n>       worker threads, phys.numThreads (0)\n"
+        "  --level <n>         gzip level for the co-save round trip, as in CBP.ini (1)\n"
+        "  --min-time <s>      measured time per case (0.5)\n"
+        "  --filter <s>        only run cases whose name contains s\n"
+        "  --json <file>       write the results as JSON\n",
+        a_exe, CONTACT_ACTORS);
+}
+
+static bool ParseList(const char* a_in, std::vector<std::uint32_t>& a_out)
+{
+    a_out.clear();
+
+    std::stringstream ss(a_in);
+    std::string e;
+
+    while (std::getline(ss, e, ','))
+    {
+        auto v = static_cast<std::uint32_t>(std::strtoul(e.c_str(), nullptr, 10));
+        if (v == 0)
+            return false;
+
+        a_out.emplace_back(v);
+    }
+
+    return !a_out.empty();
+}
+
+static bool ParseOptions(int a_argc, char** a_argv, options_t& a_out)
+{
+    for (int i = 1; i < a_argc; i++)
+    {
+        std::string arg(a_argv[i]);
+
+        if (i + 1 >= a_argc)
+            return false;
+
+        const char* v = a_argv[++i];
+
+        if (arg == "--actors") {
+            if (!ParseList(v, a_out.actors))
+                return false;
+        }
+        else if (arg == "--pairs") {
+            if (!ParseList(v, a_out.pairs))
+                return false;
+        }
+        else if (arg == "--spheres") {
+            if (!ParseList(v, a_out.spheres))
+                return false;
+        }
+        else if (arg == "--threads")
+            a_out.threads = std::atoi(v);
+        else if (arg == "--level")
+            a_out.level = std::clamp(std::atoi(v), 0, 9);
+        else if (arg == "--min-time")
+            a_out.minTime = std::strtod(v, nullptr);
+        else if (arg == "--filter")
+            a_out.filter = v;
+        else if (arg == "--json")
+            a_out.json = v;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+// a_func runs one sample, adds the number of items it processed to its argument and returns
+// the measured time in seconds. The first call is a warm up and isn't recorded.
+template <typename T>
+static void Measure(double a_minTime, result_t& a_out, T a_func)
+{
+    std::uint64_t warmup = 0;
+    a_func(warmup);
+
+    a_out.items = 0;
+
+    double total = 0.0;
+
+    while ((a_out.samples.size() < MIN_SAMPLES || total < a_minTime) &&
+        a_out.samples.size() < MAX_SAMPLES)
+    {
+        double t = a_func(a_out.items);
+
+        a_out.samples.emplace_back(t);
+        total += t;
+    }
+}
+
+static std::vector<SKSE::ObjectHandle> AddActors(std::uint32_t a_count)
+{
+    auto& task = DCBP::GetUpdateTask();
+
+    std::vector<SKSE::ObjectHandle> handles;
+
+    for (std::uint32_t i = 0; i < a_count; i++)
+    {
+        auto handle = task.AddActor(1, static_cast<float>((i * 37) % 101));
+        if (handle != 0)
+            handles.emplace_back(handle);
+    }
+
+    return handles;
+}
+
+// SimStore::UpdateMovement, the batched form of SimComponent::UpdateMovement. Nodes are
+// kept moving by animating the skeletons between steps.
+static void BenchUpdateMovement(const options_t& a_opts, std::uint32_t a_actors, result_t& a_out)
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& store = task.GetSimStore();
+    auto& workers = task.GetWorkerPool();
+
+    workers.SetNumWorkers(static_cast<std::uint32_t>(std::max(a_opts.threads, 0)));
+
+    AddActors(a_actors);
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["nodes"] = static_cast<Json::UInt64>(store.Size());
+    a_out.params["threads"] = a_opts.threads;
+
+    auto timeTick = IConfig::GetGlobalConfig().phys.timeTick;
+    float time = 0.0f;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            time += timeTick;
+
+            task.Animate(time);
+            store.UpdateVelocity(workers);
+            store.ResetSimulatedCount();
+
+            PerfTimer pt;
+            pt.Start();
+
+            store.UpdateMovement(timeTick, workers);
+
+            double t = pt.Stop();
+
+            a_items += store.GetSimulatedCount();
+
+            return t;
+        });
+
+    task.ClearActors();
+}
+
+// BenchUpdateMovement with a_type forced instead of the kernel ISimKernel::Initialize picked,
+// the in-game Stats > Kernel comparison on real skeletons.
+static void BenchKernel(const options_t& a_opts, ISimKernel::KernelType a_type, std::uint32_t a_actors, result_t& a_out)
+{
+    auto type = ISimKernel::GetKernelType();
+
+    ISimKernel::SetKernelType(a_type);
+
+    BenchUpdateMovement(a_opts, a_actors, a_out);
+
+    ISimKernel::SetKernelType(type);
+
+    a_out.params["kernel"] = ISimKernel::GetKernelName(a_type);
+}
+
+// A frame of FRAME_STEPS steps (phys.maxSubSteps, a frame rate a fifth of the tick rate) with
+// nodes written to the scene graph once per frame by SimStore::Interpolate, or after every
+// step when a_perStep is set, as before the write-back was moved out of the step.
+static void BenchFrameWriteBack(const options_t& a_opts, std::uint32_t a_actors, bool a_perStep, result_t& a_out)
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& store = task.GetSimStore();
+    auto& workers = task.GetWorkerPool();
+    auto& phys = IConfig::GetGlobalConfig().phys;
+
+    workers.SetNumWorkers(static_cast<std::uint32_t>(std::max(a_opts.threads, 0)));
+
+    auto maxSubSteps = phys.maxSubSteps;
+    phys.maxSubSteps = static_cast<float>(FRAME_STEPS);
+
+    AddActors(a_actors);
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["nodes"] = static_cast<Json::UInt64>(store.Size());
+    a_out.params["steps"] = FRAME_STEPS;
+    a_out.params["write_back"] = a_perStep ? "step" : "frame";
+    a_out.params["threads"] = a_opts.threads;
+
+    auto timeTick = phys.timeTick;
+    float time = 0.0f;
+
+    std::uint64_t writes = 0;
+    std::uint64_t frames = 0;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            time += timeTick * static_cast<float>(FRAME_STEPS);
+
+            task.Animate(time);
+
+            store.ResetSimulatedCount();
+
+            PerfTimer pt;
+            pt.Start();
+
+            store.UpdateVelocity(workers);
+
+            std::uint32_t frameWrites = 0;
+
+            for (std::uint32_t i = 0; i < FRAME_STEPS; i++)
+            {
+                store.UpdateMovement(timeTick, workers);
+
+                if (a_perStep) {
+                    store.Interpolate(1.0f, workers);
+                    frameWrites += store.GetNodeWrites();
+                }
+            }
+
+            if (!a_perStep) {
+                store.Interpolate(0.5f, workers);
+                frameWrites += store.GetNodeWrites();
+            }
+
+            double t = pt.Stop();
+
+            writes += frameWrites;
+            frames++;
+
+            a_items += store.GetSimulatedCount();
+
+            return t;
+        });
+
+    a_out.params["writes"] = static_cast<Json::UInt64>(frames ? writes / frames : 0);
+
+    phys.maxSubSteps = maxSubSteps;
+
+    task.ClearActors();
+}
+
+// ISimKernel::BenchmarkIntegrators, the in-game "Compare integrators" button: a stiff spring
+// released from rest for one second with each integrator. A sample is one step over all
+// nodes, accuracy against the finely stepped reference goes to the params.
+// a_out is indexed by ISimKernel::IntegratorType, null entries are skipped
+static void BenchIntegrators(const options_t& a_opts, const std::vector<result_t*>& a_out)
+{
+    auto iterations = static_cast<std::uint32_t>(std::max(IConfig::GetGlobalConfig().phys.pbdIterations, 1));
+
+    ISimKernel::integratorResults_t results;
+
+    for (auto e : a_out)
+        if (e)
+            e->items = 0;
+
+    double total = 0.0;
+    std::size_t samples = 0;
+
+    while ((samples < MIN_SAMPLES || total < a_opts.minTime) && samples < MAX_SAMPLES)
+    {
+        ISimKernel::BenchmarkIntegrators(INTEGRATOR_NODES, INTEGRATOR_TIME_STEP, iterations, results);
+
+        for (std::size_t i = 0; i < a_out.size(); i++)
+        {
+            if (!a_out[i])
+                continue;
+
+            double t = results[i].nsPerNode * static_cast<double>(INTEGRATOR_NODES) * 1e-9;
+
+            a_out[i]->samples.emplace_back(t);
+            a_out[i]->items += INTEGRATOR_NODES;
+
+            total += t;
+        }
+
+        samples++;
+    }
+
+    for (std::size_t i = 0; i < a_out.size(); i++)
+    {
+        if (!a_out[i])
+            continue;
+
+        auto& params = a_out[i]->params;
+
+        params["nodes"] = INTEGRATOR_NODES;
+        params["time_step"] = INTEGRATOR_TIME_STEP;
+        params["pbd_iterations"] = iterations;
+        params["stable"] = results[i].stable;
+
+        if (results[i].stable)
+        {
+            params["error"] = results[i].error;
+            params["peak"] = results[i].peak;
+        }
+    }
+}
+
+// ICollision::onContact with a_pairs persisting contacts, one point each, between nodes of
+// CONTACT_ACTORS actors.
+static void BenchContact(const options_t& a_opts, std::uint32_t a_pairs, result_t& a_out)
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& physicsCommon = DCBP::GetPhysicsCommon();
+
+    auto handles = AddActors(CONTACT_ACTORS);
+
+    std::vector<SimComponent*> components;
+
+    for (auto handle : handles)
+    {
+        // by name so pairs don't depend on hash map order
+        std::map<std::string, SimComponent*> nodes;
+
+        for (auto& e : *task.GetSimObject(handle))
+            if (e.second.HasMovement())
+                nodes.emplace(e.first, std::addressof(e.second));
+
+        for (const auto& e : nodes)
+            components.emplace_back(e.second);
+    }
+
+    if (components.size() < 2) {
+        task.ClearActors();
+        return;
+    }
+
+    auto shape = physicsCommon.createSphereShape(1.0f);
+
+    std::vector<std::unique_ptr<r3d::Collider>> colliders;
+
+    for (auto e : components)
+    {
+        colliders.emplace_back(std::make_unique<r3d::Collider>(nullptr, shape));
+        colliders.back()->setUserData(e);
+    }
+
+    using EventType = r3d::CollisionCallback::ContactPair::EventType;
+
+    r3d::CollisionCallback::CallbackData data;
+
+    for (std::uint32_t i = 0; i < a_pairs; i++)
+    {
+        auto a = (i * 2) % colliders.size();
+        auto b = (i * 2 + 1) % colliders.size();
+
+        r3d::CollisionCallback::ContactPair pair(
+            colliders[a].get(), colliders[b].get(), EventType::ContactStay);
+
+        pair.addContactPoint(r3d::CollisionCallback::ContactPoint(
+            r3d::Vector3(0.0f, 0.0f, 1.0f), 0.5f));
+
+        data.addContactPair(pair);
+    }
+
+    a_out.params["pairs"] = a_pairs;
+    a_out.params["nodes"] = static_cast<Json::UInt64>(components.size());
+
+    ICollision::SetTimeStep(IConfig::GetGlobalConfig().phys.timeTick);
+
+    r3d::EventListener& listener = ICollision::GetSingleton();
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            PerfTimer pt;
+            pt.Start();
+
+            listener.onContact(data);
+
+            double t = pt.Stop();
+
+            a_items += a_pairs;
+
+            return t;
+        });
+
+    colliders.clear();
+    physicsCommon.destroySphereShape(shape);
+
+    task.ClearActors();
+}
+
+// SphereWorld::Update on a_spheres spheres of radius 2-5 spread so each overlaps about one
+// other, every sphere moved up to 0.5 from its start between updates (not timed).
+static void BenchSphereWorld(const options_t& a_opts, std::uint32_t a_spheres, result_t& a_out)
+{
+    float extent = std::cbrt(static_cast<float>(a_spheres) * 4.18879f * 343.0f) * 0.5f;
+
+    std::mt19937 gen(0x43425021);
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> radius(2.0f, 5.0f);
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+    SphereWorld world;
+
+    std::vector<SphereWorld::handle_t> handles(a_spheres);
+    std::vector<NiPoint3> origins(a_spheres);
+
+    for (std::uint32_t i = 0; i < a_spheres; i++)
+    {
+        handles[i] = world.Add(nullptr, radius(gen), 0);
+        origins[i] = NiPoint3(position(gen), position(gen), position(gen));
+    }
+
+    std::uint64_t contacts = 0;
+    std::uint64_t updates = 0;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            for (std::uint32_t i = 0; i < a_spheres; i++)
+            {
+                auto p = origins[i] + NiPoint3(jitter(gen), jitter(gen), jitter(gen));
+                world.SetPosition(handles[i], p.x, p.y, p.z);
+            }
+
+            PerfTimer pt;
+            pt.Start();
+
+            world.Update();
+
+            double t = pt.Stop();
+
+            contacts += world.GetContacts().size();
+            updates++;
+
+            a_items += a_spheres;
+
+            return t;
+        });
+
+    a_out.params["spheres"] = a_spheres;
+    a_out.params["contacts"] = static_cast<Json::UInt64>(updates ? contacts / updates : 0);
+}
+
+// ICollision::Benchmark, the in-game backend comparison: the same jittered cloud of a_spheres
+// spheres updated BACKEND_STEPS times on each backend, a sample is one update. The
+// reactphysics3d backend is the headless stand-in (see r3d.h), not the library.
+// a_out is indexed by ICollision::Backend
+static void BenchBackends(
+    const options_t& a_opts,
+    std::uint32_t a_spheres,
+    const std::array<result_t*, 2>& a_out)
+{
+    ICollision::benchmarkResults_t results;
+
+    std::array<double, 2> pairs{};
+
+    double total = 0.0;
+    std::size_t samples = 0;
+
+    while ((samples < MIN_SAMPLES || total < a_opts.minTime) && samples < MAX_SAMPLES)
+    {
+        ICollision::Benchmark(a_spheres, BACKEND_STEPS, results);
+
+        for (std::size_t i = 0; i < a_out.size(); i++)
+        {
+            double t = results[i].time * 1e-6;
+
+            a_out[i]->samples.emplace_back(t);
+            a_out[i]->items += a_spheres;
+
+            pairs[i] = results[i].pairs;
+            total += t;
+        }
+
+        samples++;
+    }
+
+    for (std::size_t i = 0; i < a_out.size(); i++)
+    {
+        a_out[i]->params["spheres"] = a_spheres;
+        a_out[i]->params["pairs"] = pairs[i];
+    }
+}
+
+// SphereWorld::Update on a_actors actors of CROWD_SPHERES spheres each, clustered around the
+// actor and actors spread over a plane so some of them are close enough to touch. A quarter
+// of every actor's spheres don't move and the rest are split over three collision groups,
+// filtered like ICollision::MakeFilter does.
+static void BenchSphereCrowd(const options_t& a_opts, std::uint32_t a_actors, result_t& a_out)
+{
+    float extent = std::sqrt(static_cast<float>(a_actors)) * 75.0f;
+
+    std::mt19937 gen(0x43425021);
+    std::uniform_real_distribution<float> position(-extent, extent);
+    std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+    std::uniform_real_distribution<float> radius(2.0f, 5.0f);
+    std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+
+    SphereWorld world;
+
+    std::uint32_t numSpheres = a_actors * CROWD_SPHERES;
+
+    std::vector<SphereWorld::handle_t> handles(numSpheres);
+    std::vector<NiPoint3> origins(numSpheres);
+
+    for (std::uint32_t i = 0; i < a_actors; i++)
+    {
+        NiPoint3 origin(position(gen), position(gen), 0.0f);
+
+        for (std::uint32_t j = 0; j < CROWD_SPHERES; j++)
+        {
+            auto k = i * CROWD_SPHERES + j;
+
+            bool movement = j >= CROWD_SPHERES / 4;
+            std::uint32_t group = (j % 4) == 3 ? 0 : 1U << (j % 4);
+
+            handles[k] = world.Add(nullptr, radius(gen), i);
+            world.SetFilter(handles[k], SphereWorld::filter_t{
+                movement ? ICollision::kFilterMoving : ICollision::kFilterStatic,
+                movement ? ICollision::kFilterMoving | ICollision::kFilterStatic : ICollision::kFilterMoving,
+                group });
+            origins[k] = origin + NiPoint3(offset(gen), offset(gen), offset(gen) * 2.0f);
+        }
+    }
+
+    std::uint64_t contacts = 0;
+    std::uint64_t rejected = 0;
+    std::uint64_t updates = 0;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            for (std::uint32_t i = 0; i < numSpheres; i++)
+            {
+                auto p = origins[i] + NiPoint3(jitter(gen), jitter(gen), jitter(gen));
+                world.SetPosition(handles[i], p.x, p.y, p.z);
+            }
+
+            PerfTimer pt;
+            pt.Start();
+
+            world.Update();
+
+            double t = pt.Stop();
+
+            contacts += world.GetContacts().size();
+            rejected += world.GetStats().rejected;
+            updates++;
+
+            a_items += numSpheres;
+
+            return t;
+        });
+
+    auto& stats = world.GetStats();
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["islands"] = stats.islands;
+    a_out.params["actor_pairs"] = stats.ownerPairs;
+    a_out.params["contacts"] = static_cast<Json::UInt64>(updates ? contacts / updates : 0);
+    a_out.params["rejected"] = static_cast<Json::UInt64>(updates ? rejected / updates : 0);
+}
+
+// Adding and removing a_actors actors on the reactphysics3d backend, the way a cell
+// transition does. Colliders come from ICollision's body pool after the first sample.
+static void BenchColliderChurn(const options_t& a_opts, std::uint32_t a_actors, result_t& a_out)
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& phys = IConfig::GetGlobalConfig().phys;
+
+    auto backend = phys.collisionBackend;
+    phys.collisionBackend = Enum::Underlying(ICollision::Backend::kReactPhysics);
+
+    auto before = ICollision::GetPoolStats();
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            PerfTimer pt;
+            pt.Start();
+
+            AddActors(a_actors);
+            task.ClearActors();
+
+            double t = pt.Stop();
+
+            a_items += a_actors;
+
+            return t;
+        });
+
+    phys.collisionBackend = backend;
+
+    auto& stats = ICollision::GetPoolStats();
+
+    auto acquired = stats.acquired - before.acquired;
+    auto hits = stats.hits - before.hits;
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["pool_free"] = stats.free;
+    a_out.params["hit_rate"] = acquired ? static_cast<double>(hits) / static_cast<double>(acquired) : 0.0;
+}
+
+// a physics and node profile for each actor, values varied so they don't compress away
+static void CreateActorProfiles(std::uint32_t a_actors)
+{
+    auto& globalPhys = IConfig::GetGlobalPhysicsConfig();
+    auto& globalNodes = IConfig::GetGlobalNodeConfig();
+
+    for (std::uint32_t i = 0; i < a_actors; i++)
+    {
+        SKSE::ObjectHandle handle = 0x1000 + i;
+
+        auto conf = globalPhys;
+
+        for (auto& e : conf)
+            for (const auto& v : configComponent_t::descMap)
+                e.second.Mul(v.first, 1.0f + static_cast<float>(i % 13) * 0.01f);
+
+        IConfig::SetActorConf(handle, std::move(conf));
+        IConfig::SetActorNodeConfig(handle, globalNodes);
+    }
+}
+
+static void ClearActorProfiles()
+{
+    IConfig::ClearActorConfigHolder();
+    IConfig::ClearActorNodeConfigHolder();
+}
+
+// IConfig::GetActorConfAO on actors that all have an armor override setting or scaling every
+// value of every config group.
+static void BenchConfigAO(const options_t& a_opts, std::uint32_t a_actors, result_t& a_out)
+{
+    CreateActorProfiles(a_actors);
+
+    auto& globalPhys = IConfig::GetGlobalPhysicsConfig();
+
+    std::vector<SKSE::ObjectHandle> handles;
+
+    for (std::uint32_t i = 0; i < a_actors; i++)
+    {
+        SKSE::ObjectHandle handle = 0x1000 + i;
+
+        armorOverrideDescriptor_t entry;
+
+        std::uint32_t n = 0;
+
+        for (const auto& e : globalPhys)
+        {
+            auto& section = entry.second[e.first];
+
+            for (const auto& v : configComponent_t::descMap)
+                section.emplace(v.first, armorCacheValue_t(n++ & 1, 1.05f));
+        }
+
+        IConfig::SetArmorOverride(handle, std::move(entry));
+
+        handles.emplace_back(handle);
+    }
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["groups"] = static_cast<Json::UInt64>(globalPhys.size());
+
+    // override entries found per sample, printed so the lookups aren't optimized out
+    std::size_t entries = 0;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            entries = 0;
+
+            PerfTimer pt;
+            pt.Start();
+
+            for (auto handle : handles)
+                entries += IConfig::GetActorConfAO(handle).size();
+
+            double t = pt.Stop();
+
+            a_items += handles.size();
+
+            return t;
+        });
+
+    a_out.params["entries"] = static_cast<Json::UInt64>(entries);
+
+    IConfig::ClearArmorOverrides();
+    ClearActorProfiles();
+}
+
+// Parser::Parse on every entry of an actor profile record, physics and nodes.
+static void BenchParser(const options_t& a_opts, std::uint32_t a_actors, result_t& a_out)
+{
+    ISerialization serialization;
+
+    CreateActorProfiles(a_actors);
+
+    std::stringstream data;
+    serialization.SerializeActorProfiles(data);
+
+    ClearActorProfiles();
+
+    a_out.params["actors"] = a_actors;
+    a_out.params["bytes"] = static_cast<Json::UInt64>(data.str().size());
+
+    Json::Value root;
+    data >> root;
+
+    Parser componentParser;
+    Parser nodeParser;
+
+    Measure(a_opts.minTime, a_out, [&](std::uint64_t& a_items)
+        {
+            configComponents_t components;
+            configNodes_t nodes;
+
+            PerfTimer pt;
+            pt.Start();
+
+            for (auto it = root.begin(); it != root.end(); ++it)
+            {
+                bool ok = componentParser.Parse(*it, components);
+                ok &= nodeParser.Parse(*it, nodes);
+
+                if (ok)
+                    a_items++;
+            }
+
+            return pt.Stop();
+        });
+}
+
+// The co-save round trip DCBP::SaveRecord / DCBP::LoadRecord do for actor profiles,
+// without the SKSE interface: serialize and compress, decompress and load.
+static void BenchSerialization(
+    const options_t& a_opts,
+    std::uint32_t a_actors,
+    result_t& a_save,
+    result_t& a_load)
+{
+    ISerialization serialization;
+
+    CreateActorProfiles(a_actors);
+
+    std::string compressed;
+    std::size_t length = 0;
+
+    Measure(a_opts.minTime, a_save, [&](std::uint64_t& a_items)
+        {
+            compressed.clear();
+
+            PerfTimer pt;
+            pt.Start();
+
+            std::stringstream data;
+            a_items += serialization.SerializeActorProfiles(data);
+            ISerialization::Compress(data, compressed, a_opts.level);
+
+            double t = pt.Stop();
+
+            length = data.str().size();
+
+            return t;
+        });
+
+    Measure(a_opts.minTime, a_load, [&](std::uint64_t& a_items)
+        {
+            PerfTimer pt;
+            pt.Start();
+
+            std::stringstream data;
+            ISerialization::Decompress(compressed.data(), compressed.size(), data);
+            a_items += serialization.LoadActorProfiles(nullptr, data);
+
+            return pt.Stop();
+        });
+
+    for (auto e : { std::addressof(a_save), std::addressof(a_load) })
+    {
+        e->params["actors"] = a_actors;
+        e->params["level"] = a_opts.level;
+        e->params["bytes"] = static_cast<Json::UInt64>(length);
+        e->params["compressed"] = static_cast<Json::UInt64>(compressed.size());
+    }
+
+    ClearActorProfiles();
+}
+
+static double Percentile(const std::vector<double>& a_sorted, double a_p)
+{
+    auto i = static_cast<std::size_t>(a_p * static_cast<double>(a_sorted.size() - 1) + 0.5);
+    return a_sorted[std::min(i, a_sorted.size() - 1)];
+}
+
+static Json::Value Summarize(const result_t& a_in)
+{
+    Json::Value r;
+
+    r["name"] = a_in.name;
+    r["params"] = a_in.params;
+
+    if (a_in.samples.empty())
+        return r;
+
+    auto sorted = a_in.samples;
+    std::sort(sorted.begin(), sorted.end());
+
+    double total = 0.0;
+    for (auto e : sorted)
+        total += e;
+
+    r["samples"] = static_cast<Json::UInt64>(sorted.size());
+    r["items"] = static_cast<Json::UInt64>(a_in.items);
+    r["mean_ns"] = total * 1e9 / static_cast<double>(sorted.size());
+    r["min_ns"] = sorted.front() * 1e9;
+    r["p50_ns"] = Percentile(sorted, 0.5) * 1e9;
+    r["p95_ns"] = Percentile(sorted, 0.95) * 1e9;
+    r["max_ns"] = sorted.back() * 1e9;
+    r["ns_per_item"] = a_in.items ? total * 1e9 / static_cast<double>(a_in.items) : 0.0;
+
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    options_t opts;
+    if (!ParseOptions(argc, argv, opts)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    DCBP::Initialize();
+
+    IConfig::GetGlobalConfig().phys.numThreads = opts.threads;
+
+    std::vector<result_t> results;
+
+    auto run = [&](const std::string& a_name) -> result_t*
+    {
+        if (!opts.filter.empty() && a_name.find(opts.filter) == std::string::npos)
+            return nullptr;
+
+        results.emplace_back();
+        results.back().name = a_name;
+        results.back().params = Json::Value(Json::objectValue);
+
+        return std::addressof(results.back());
+    };
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("update_movement"))
+            BenchUpdateMovement(opts, n, *r);
+    }
+
+    for (std::uint32_t i = 0; i < Enum::Underlying(ISimKernel::KernelType::kNumTypes); i++)
+    {
+        auto type = static_cast<ISimKernel::KernelType>(i);
+
+        if (!ISimKernel::IsSupported(type))
+            continue;
+
+        std::string name("kernel_");
+        for (auto c : std::string(ISimKernel::GetKernelName(type)))
+            if (std::isalnum(static_cast<unsigned char>(c)))
+                name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+        for (auto n : opts.actors)
+        {
+            if (auto r = run(name))
+                BenchKernel(opts, type, n, *r);
+        }
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("frame_write_back"))
+            BenchFrameWriteBack(opts, n, true, *r);
+
+        if (auto r = run("frame_write_back"))
+            BenchFrameWriteBack(opts, n, false, *r);
+    }
+
+    {
+        // measured together, indices since run() can move the results
+        std::vector<std::size_t> indices;
+
+        for (std::uint32_t i = 0; i < Enum::Underlying(ISimKernel::IntegratorType::kNumTypes); i++)
+        {
+            std::string name("integrator_");
+            for (auto c : std::string(ISimKernel::GetIntegratorName(static_cast<ISimKernel::IntegratorType>(i))))
+                name += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+            indices.emplace_back(run(name) ? results.size() - 1 : std::numeric_limits<std::size_t>::max());
+        }
+
+        std::vector<result_t*> integrators;
+        for (auto i : indices)
+            integrators.emplace_back(i < results.size() ? std::addressof(results[i]) : nullptr);
+
+        if (std::any_of(integrators.begin(), integrators.end(), [](auto a_e) { return a_e != nullptr; }))
+            BenchIntegrators(opts, integrators);
+    }
+
+    for (auto n : opts.pairs)
+    {
+        if (auto r = run("collision_on_contact"))
+            BenchContact(opts, n, *r);
+    }
+
+    for (auto n : opts.spheres)
+    {
+        if (auto r = run("sphere_world_update"))
+            BenchSphereWorld(opts, n, *r);
+    }
+
+    {
+        // both backends run in one call, either name selects the pair
+        std::array<std::string, 2> names;
+
+        for (std::uint32_t i = 0; i < names.size(); i++)
+        {
+            names[i] = "collision_backend_";
+            for (auto c : std::string(ICollision::GetBackendName(static_cast<ICollision::Backend>(i))))
+                if (std::isalnum(static_cast<unsigned char>(c)))
+                    names[i] += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+
+        bool selected = opts.filter.empty() || std::any_of(names.begin(), names.end(),
+            [&](const auto& a_name) { return a_name.find(opts.filter) != std::string::npos; });
+
+        for (auto n : opts.spheres)
+        {
+            if (!selected)
+                break;
+
+            std::array<result_t*, 2> backends;
+
+            for (std::size_t i = 0; i < names.size(); i++)
+            {
+                results.emplace_back();
+                results.back().name = names[i];
+                results.back().params = Json::Value(Json::objectValue);
+                results.back().items = 0;
+            }
+
+            for (std::size_t i = 0; i < names.size(); i++)
+                backends[i] = std::addressof(results[results.size() - names.size() + i]);
+
+            BenchBackends(opts, n, backends);
+        }
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("sphere_world_crowd"))
+            BenchSphereCrowd(opts, n, *r);
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("collider_churn"))
+            BenchColliderChurn(opts, n, *r);
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("config_actor_ao"))
+            BenchConfigAO(opts, n, *r);
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (auto r = run("parser_parse"))
+            BenchParser(opts, n, *r);
+    }
+
+    for (auto n : opts.actors)
+    {
+        if (!opts.filter.empty() && std::string("serialization_save_load").find(opts.filter) == std::string::npos)
+            continue;
+
+        results.emplace_back();
+        results.emplace_back();
+
+        auto& save = results[results.size() - 2];
+        auto& load = results.back();
+
+        save.name = "serialization_save";
+        load.name = "serialization_load";
+
+        BenchSerialization(opts, n, save, load);
+    }
+
+    Json::Value root;
+
+    root["kernel"] = ISimKernel::GetKernelName(ISimKernel::GetKernelType());
+    root["results"] = Json::Value(Json::arrayValue);
+
+    for (const auto& e : results)
+    {
+        auto r = Summarize(e);
+
+        std::string params;
+        for (const auto& k : e.params.getMemberNames())
+            params += k + "=" + e.params[k].asString() + " ";
+
+        std::printf("%-22s %-44s p50 %12.0f ns %10.1f ns/item\n",
+            e.name.c_str(),
+            params.c_str(),
+            r.get("p50_ns", 0.0).asDouble(),
+            r.get("ns_per_item", 0.0).asDouble());
+
+        root["results"].append(std::move(r));
+    }
+
+    if (!opts.json.empty())
+    {
+        std::ofstream ofs(opts.json, std::ofstream::out | std::ofstream::trunc);
+        if (!ofs.is_open()) {
+            std::fprintf(stderr, "couldn't open %s\n", opts.json.c_str());
+            return 1;
+        }
+
+        ofs << root << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,500 @@
+#include "pch.h"
+
+using namespace CBP;
+
+// Checks for properties of the simulation that the state hash doesn't cover. Every check
+// prints what it found, the exit code is the number of checks that failed. Run by ctest.
+
+static std::atomic<bool> s_countAllocations = false;
+static std::atomic<std::uint64_t> s_allocations = 0;
+
+void* operator new(std::size_t a_size)
+{
+    if (s_countAllocations.load(std::memory_order_relaxed))
+        s_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto p = std::malloc(a_size ? a_size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t a_size)
+{
+    return ::operator new(a_size);
+}
+
+void operator delete(void* a_ptr) noexcept
+{
+    std::free(a_ptr);
+}
+
+void operator delete[](void* a_ptr) noexcept
+{
+    std::free(a_ptr);
+}
+
+void operator delete(void* a_ptr, std::size_t) noexcept
+{
+    std::free(a_ptr);
+}
+
+void operator delete[](void* a_ptr, std::size_t) noexcept
+{
+    std::free(a_ptr);
+}
+
+// heap allocations made by a_func
+template <typename T>
+static std::uint64_t CountAllocations(T a_func)
+{
+    auto start = s_allocations.load();
+
+    s_countAllocations = true;
+    a_func();
+    s_countAllocations = false;
+
+    return s_allocations.load() - start;
+}
+
+static bool Report(const char* a_name, bool a_passed, const char* a_fmt, ...)
+{
+    std::printf("%-14s %s  ", a_name, a_passed ? "ok  " : "FAIL");
+
+    std::va_list args;
+    va_start(args, a_fmt);
+    std::vprintf(a_fmt, args);
+    va_end(args);
+
+    std::printf("\n");
+
+    return a_passed;
+}
+
+// SimComponent keeps pending forces in a fixed ring. Filling it, overflowing it and draining
+// it through UpdateMovement must not allocate, and every force that didn't fit is counted.
+static bool CheckForceRing()
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& store = task.GetSimStore();
+    auto& workers = task.GetWorkerPool();
+
+    auto timeTick = IConfig::GetGlobalConfig().phys.timeTick;
+
+    auto handle = task.AddActor(1, 50.0f);
+    auto obj = task.GetSimObject(handle);
+
+    if (!obj)
+        return Report("force_ring", false, "no simulated nodes");
+
+    // the config group with the most moving nodes
+    std::map<std::string, std::uint32_t> groups;
+
+    for (auto& e : *obj)
+        if (e.second.HasMovement())
+            groups[e.second.GetConfigGroupName()]++;
+
+    if (groups.empty()) {
+        task.ClearActors();
+        return Report("force_ring", false, "no moving nodes");
+    }
+
+    auto group = std::max_element(groups.begin(), groups.end(),
+        [](const auto& a_lhs, const auto& a_rhs) { return a_lhs.second < a_rhs.second; });
+
+    const auto& name = group->first;
+    auto nodes = group->second;
+
+    constexpr auto capacity = SimComponent::MAX_FORCES;
+
+    NiPoint3 force(0.0f, 0.0f, 10.0f);
+
+    // parent table, collision state and the like are set up on the first step
+    store.UpdateMovement(timeTick, workers);
+
+    auto dropped = store.GetDroppedForces();
+
+    auto fill = CountAllocations([&]
+        {
+            for (std::uint32_t i = 0; i < capacity * 2; i++)
+                task.ApplyForce(handle, 1, name, force);
+        });
+
+    auto overflow = store.GetDroppedForces() - dropped;
+
+    // one force is popped per step
+    auto drain = CountAllocations([&]
+        {
+            for (std::uint32_t i = 0; i < capacity; i++)
+                store.UpdateMovement(timeTick, workers);
+        });
+
+    dropped = store.GetDroppedForces();
+
+    for (std::uint32_t i = 0; i < capacity; i++)
+        task.ApplyForce(handle, 1, name, force);
+
+    auto refill = store.GetDroppedForces() - dropped;
+
+    task.ClearActors();
+
+    return Report("force_ring",
+        fill == 0 && drain == 0 && overflow == nodes * capacity && refill == 0,
+        "%s, %u nodes: %llu allocations filling, %llu draining, %u dropped (expected %u), "
+        "%u dropped after draining",
+        name.c_str(), nodes,
+        static_cast<unsigned long long>(fill),
+        static_cast<unsigned long long>(drain),
+        overflow, nodes * capacity, refill);
+}
+
+// Removing a sphere reports the contacts it was in so the partner can be taken out of contact,
+// an emptied world hands out handles from zero again.
+static bool CheckSphereRemove()
+{
+    SphereWorld world;
+
+    int a, b, c;
+
+    auto ha = world.Add(std::addressof(a), 1.0f, 0);
+    auto hb = world.Add(std::addressof(b), 1.0f, 1);
+    auto hc = world.Add(std::addressof(c), 1.0f, 2);
+
+    world.SetPosition(hb, 1.5f, 0.0f, 0.0f);
+    world.SetPosition(hc, 10.0f, 0.0f, 0.0f);
+
+    world.Update();
+
+    std::vector<std::pair<void*, void*>> exits;
+
+    auto onExit = [&](void* a_lhs, void* a_rhs) { exits.emplace_back(a_lhs, a_rhs); };
+
+    world.Remove(ha, onExit);
+    world.Remove(hc, onExit);
+
+    bool reported = exits.size() == 1 &&
+        exits[0].first == std::addressof(a) && exits[0].second == std::addressof(b);
+
+    world.Remove(hb, onExit);
+
+    auto handle = world.Add(std::addressof(a), 1.0f, 0);
+
+    return Report("sphere_remove", reported && exits.size() == 1 && handle == 0,
+        "%zu exit(s) reported (expected 1), handle %u after emptying (expected 0)",
+        exits.size(), handle);
+}
+
+// An actor stepped every fourth tick with one tick per frame. Its nodes must
+// move on every frame in between instead of being held at the previous state until the
+// next step.
+static bool CheckLODBlend()
+{
+    constexpr std::uint32_t interval = 4;
+    constexpr std::uint32_t frames = 120;
+
+    auto& task = DCBP::GetUpdateTask();
+
+    auto timeTick = IConfig::GetGlobalConfig().phys.timeTick;
+
+    auto handle = task.AddActor(1, 50.0f);
+    auto obj = task.GetSimObject(handle);
+
+    if (!obj) {
+        task.ClearActors();
+        return Report("lod_blend", false, "no simulated nodes");
+    }
+
+    obj->SetLOD(LODTier::Mid, interval);
+
+    std::vector<std::pair<NiAVObject*, NiPoint3>> nodes;
+
+    for (auto& e : *obj)
+        if (e.second.HasMovement())
+            if (auto node = task.GetNode(handle, e.first.c_str()))
+                nodes.emplace_back(node, node->m_localTransform.pos);
+
+    task.SetTimeAccum(0.0f);
+
+    std::uint32_t moved = 0;
+    std::uint32_t held = 0;
+
+    for (std::uint32_t i = 0; i < frames; i++)
+    {
+        float time = static_cast<float>(i + 1) * timeTick;
+
+        task.Animate(time);
+        task.PhysicsTick(timeTick);
+
+        // the first steps settle from rest
+        bool counted = i >= interval * 2;
+
+        for (auto& e : nodes)
+        {
+            auto& pos = e.first->m_localTransform.pos;
+
+            if (counted)
+            {
+                if (pos.x != e.second.x || pos.y != e.second.y || pos.z != e.second.z)
+                    moved++;
+                else
+                    held++;
+            }
+
+            e.second = pos;
+        }
+    }
+
+    task.ClearActors();
+
+    // a node at rest doesn't move either, but not on most frames
+    return Report("lod_blend", moved > held * 4,
+        "interval %u, %u node frames moved, %u held", interval, moved, held);
+}
+
+// IConfig keeps a node in the first chain that lists it, both SolveChains and the write-back
+// assume a node belongs to one chain at most.
+static bool CheckChainFilter()
+{
+    IConfig::SetNodeChains({
+        { "L Breast01", "L Breast02", "L Breast03" },
+        { "L Breast02", "L Breast03" },
+        { "R Breast01", "R Breast02", "R Breast03", "L Breast01" }
+        });
+
+    const nodeChains_t expected{
+        { "L Breast01", "L Breast02", "L Breast03" },
+        { "R Breast01", "R Breast02", "R Breast03" }
+    };
+
+    auto& chains = IConfig::GetNodeChains();
+
+    return Report("chain_filter", chains == expected,
+        "%zu chains left of 3 (expected %zu)", chains.size(), expected.size());
+}
+
+// 40 collision groups with only the last two assigned to nodes. Nodes of the same actor in
+// either group must not collide, groups nobody uses must not take up bits.
+static bool CheckGroupFilter()
+{
+    collisionGroups_t groups;
+    for (std::uint64_t i = 1; i <= 40; i++)
+        groups.emplace(i);
+
+    IConfig::SetCollisionGroups(std::move(groups));
+    IConfig::SetNodeCollisionGroupMap({
+        { "L Breast01", 39 },
+        { "R Breast01", 39 },
+        { "L Breast02", 40 }
+        });
+
+    auto f39 = ICollision::MakeFilter(39, true);
+    auto f40 = ICollision::MakeFilter(40, true);
+
+    IConfig::ClearNodeCollisionGroupMap();
+    IConfig::SetCollisionGroups(collisionGroups_t());
+
+    bool passed = f39.group != 0 && f40.group != 0 &&
+        !SphereWorld::Accepts(f39, f39, true) &&
+        !SphereWorld::Accepts(f40, f40, true) &&
+        SphereWorld::Accepts(f39, f40, true);
+
+    return Report("group_filter", passed,
+        "group bits %08x %08x", f39.group, f40.group);
+}
+
+// Hash of a_actors actors with chains simulated for a_seconds on a_threads workers.
+static std::uint64_t RunChains(std::uint32_t a_actors, float a_seconds, int a_threads, SimStore::size_type& a_chains)
+{
+    auto& task = DCBP::GetUpdateTask();
+
+    IConfig::GetGlobalConfig().phys.numThreads = a_threads;
+
+    for (std::uint32_t i = 0; i < a_actors; i++)
+        task.AddActor(1, static_cast<float>((i * 37) % 101));
+
+    a_chains = task.GetSimStore().NumChains();
+
+    task.SetTimeAccum(0.0f);
+
+    FrameTimer timer(60.0f, 0.3f, 1);
+
+    std::uint64_t hash = 0;
+    float time = 0.0f;
+
+    while (time < a_seconds)
+    {
+        float interval = timer.Next();
+        time += interval;
+
+        task.Animate(time);
+        task.PhysicsTick(interval);
+
+        hash = hash * 31 + task.GetStateHash();
+    }
+
+    task.ClearActors();
+
+    IConfig::GetGlobalConfig().phys.numThreads = 0;
+
+    return hash;
+}
+
+// Breast and genital chains on every actor, the run must come out the same on one thread and
+// on several.
+static bool CheckChainThreads()
+{
+    constexpr std::uint32_t actors = 10;
+
+    IConfig::SetNodeChains({
+        { "L Breast01", "L Breast02", "L Breast03" },
+        { "R Breast01", "R Breast02", "R Breast03" },
+        {
+            "NPC Genitals01 [Gen01]", "NPC Genitals02 [Gen02]", "NPC Genitals03 [Gen03]",
+            "NPC Genitals04 [Gen04]", "NPC Genitals05 [Gen05]", "NPC Genitals06 [Gen06]"
+        }
+        });
+
+    SimStore::size_type chains1, chains4;
+
+    auto hash1 = RunChains(actors, 5.0f, 0, chains1);
+    auto hash4 = RunChains(actors, 5.0f, 4, chains4);
+
+    IConfig::SetNodeChains({});
+
+    return Report("chain_threads", chains1 > 0 && chains1 == chains4 && hash1 == hash4,
+        "%u chains over %u actors, hash %016llx without workers, %016llx with 4",
+        chains1, actors,
+        static_cast<unsigned long long>(hash1),
+        static_cast<unsigned long long>(hash4));
+}
+
+// World space position of every chain node after one frame from rest, with all rotational
+// factors set to a_rotational. Chains are listed one after the other. Collisions are off,
+// colliders turn with the nodes.
+static std::vector<NiPoint3> RunChainRotation(const nodeChains_t& a_chains, float a_rotational)
+{
+    auto& task = DCBP::GetUpdateTask();
+    auto& physics = IConfig::GetGlobalPhysicsConfig();
+    auto& globalConf = IConfig::GetGlobalConfig();
+
+    auto saved = physics;
+    auto collisions = globalConf.phys.collisions;
+
+    globalConf.phys.collisions = false;
+
+    for (auto& e : physics)
+    {
+        e.second.rotationalX = a_rotational;
+        e.second.rotationalY = a_rotational;
+        e.second.rotationalZ = a_rotational;
+    }
+
+    auto handle = task.AddActor(1, 50.0f);
+    auto obj = task.GetSimObject(handle);
+
+    std::set<std::string> groups;
+
+    if (obj)
+        for (auto& e : *obj)
+            if (e.second.HasMovement())
+                groups.emplace(e.second.GetConfigGroupName());
+
+    for (const auto& e : groups)
+        task.ApplyForce(handle, 10, e, NiPoint3(40.0f, 0.0f, 20.0f));
+
+    // several steps in one frame, the scene graph holds the rest pose until the write-back
+    task.SetTimeAccum(0.0f);
+    task.Animate(0.0f);
+    task.PhysicsTick(globalConf.phys.timeTick * 5.0f);
+
+    std::vector<NiPoint3> positions;
+
+    for (const auto& c : a_chains)
+        for (const auto& e : c)
+            if (auto node = task.GetNode(handle, e.c_str()))
+                positions.emplace_back(node->m_worldTransform.pos);
+
+    task.ClearActors();
+
+    physics = saved;
+    globalConf.phys.collisions = collisions;
+
+    return positions;
+}
+
+// Chain links are written relative to the previous link as written, its rotation must not
+// swing the rest of the chain around it. Links come out the same length in world space
+// with rotational factors as without, and every node in the same place.
+static bool CheckChainRotation()
+{
+    constexpr float rotational = 0.1f;
+
+    // from the first simulated node down, its parent isn't written
+    const nodeChains_t chains{
+        { "NPC L Breast", "L Breast01", "L Breast02", "L Breast03" },
+        { "NPC R Breast", "R Breast01", "R Breast02", "R Breast03" }
+    };
+
+    IConfig::SetNodeChains(chains);
+
+    auto expected = RunChainRotation(chains, 0.0f);
+    auto positions = RunChainRotation(chains, rotational);
+
+    IConfig::SetNodeChains({});
+
+    constexpr std::size_t nodes = 8;
+
+    if (positions.size() != nodes || expected.size() != nodes)
+        return Report("chain_rotation", false, "%zu chain nodes found (expected %zu)", positions.size(), nodes);
+
+    float lengthError = 0.0f;
+    float positionError = 0.0f;
+
+    for (std::size_t i = 0; i < nodes; i++)
+    {
+        positionError = std::max(positionError, (positions[i] - expected[i]).Length());
+
+        // the first node of each chain of four has no link to the one before
+        if (i % 4 == 0)
+            continue;
+
+        float length = (positions[i] - positions[i - 1]).Length();
+        float expectedLength = (expected[i] - expected[i - 1]).Length();
+
+        lengthError = std::max(lengthError, std::abs(length - expectedLength));
+    }
+
+    return Report("chain_rotation", lengthError < 0.001f && positionError < 0.001f,
+        "rotational factors %.2f, worst link length difference %.4f, node position %.4f",
+        rotational, lengthError, positionError);
+}
+
+int main(int, char**)
+{
+    DCBP::Initialize();
+
+    int failed = 0;
+
+    if (!CheckForceRing())
+        failed++;
+
+    if (!CheckLODBlend())
+        failed++;
+
+    if (!CheckSphereRemove())
+        failed++;
+
+    if (!CheckChainFilter())
+        failed++;
+
+    if (!CheckGroupFilter())
+        failed++;
+
+    if (!CheckChainThreads())
+        failed++;
+
+    if (!CheckChainRotation())
+        failed++;
+
+    return failed;
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "pch.h"
+
+using namespace CBP;
+
+struct options_t
+{
+    std::uint32_t actors = 20;
+    float seconds = 60.0f;
+    float fps = 60.0f;
+    float jitter = 0.0f;
+    std::uint32_t seed = 1;
+    int threads = 0;
+    float integrator = -1.0f;
+    bool collisions = true;
+    int backend = 0;
+    int collisionInterval = 1;
+    std::uint32_t lodInterval = 1;
+    std::string record;
+    std::string replay;
+};
+
+static void PrintUsage(const char* a_exe)
+{
+    std::printf(
+        "usage: %s [options]\n"
+        "  --actors <n>        simulated actors (20)\n"
+        "  --seconds <s>       game time to simulate (60)\n"
+        "  --fps <f>           frame rate fed to the fixed step loop (60)\n"
+        "  --jitter <f>        frame interval variation, fraction of 1/fps (0)\n"
+        "  --seed <n>          frame interval sequence seed (1)\n"
+        "  --threads <n>       worker threads, phys.numThreads (0)\n"
+        "  --integrator <n>    override every config group, 0 explicit, 1 implicit, 2 PBD\n"
+        "  --no-collisions     disable phys.collisions\n"
+        "  --backend <n>       phys.collisionBackend, 0 spheres, 1 reactphysics3d (sweep and\n"
+        "                      prune stand-in) (0)\n"
+        "  --collision-interval <n>\n"
+        "                      phys.collisionInterval, full detection every nth step (1)\n"
+        "  --lod-interval <n>  put every actor in the mid LOD tier, stepped every nth step\n"
+        "                      with the time it skipped (1)\n"
+        "  --record <file>     write a motion recording of the run\n"
+        "  --replay <file>     replay a motion recording instead of the scripted actors,\n"
+        "                      settings come from the recording (except --threads)\n",
+        a_exe);
+}
+
+static bool ParseOptions(int a_argc, char** a_argv, options_t& a_out)
+{
+    for (int i = 1; i < a_argc; i++)
+    {
+        std::string arg(a_argv[i]);
+
+        if (arg == "--no-collisions") {
+            a_out.collisions = false;
+            continue;
+        }
+
+        if (i + 1 >= a_argc)
+            return false;
+
+        const char* v = a_argv[++i];
+
+        if (arg == "--actors")
+            a_out.actors = static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10));
+        else if (arg == "--seconds")
+            a_out.seconds = std::strtof(v, nullptr);
+        else if (arg == "--fps")
+            a_out.fps = std::strtof(v, nullptr);
+        else if (arg == "--jitter")
+            a_out.jitter = std::strtof(v, nullptr);
+        else if (arg == "--seed")
+            a_out.seed = static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10));
+        else if (arg == "--threads")
+            a_out.threads = std::atoi(v);
+        else if (arg == "--backend")
+            a_out.backend = std::atoi(v);
+        else if (arg == "--collision-interval")
+            a_out.collisionInterval = std::atoi(v);
+        else if (arg == "--lod-interval")
+            a_out.lodInterval = std::max(static_cast<std::uint32_t>(std::strtoul(v, nullptr, 10)), 1U);
+        else if (arg == "--integrator")
+            a_out.integrator = std::strtof(v, nullptr);
+        else if (arg == "--record")
+            a_out.record = v;
+        else if (arg == "--replay")
+            a_out.replay = v;
+        else
+            return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    options_t opts;
+    if (!ParseOptions(argc, argv, opts)) {
+        PrintUsage(argv[0]);
+        return 1;
+    }
+
+    DCBP::Initialize();
+
+    auto& globalConf = IConfig::GetGlobalConfig();
+
+    globalConf.phys.numThreads = opts.threads;
+    globalConf.phys.collisions = opts.collisions;
+    globalConf.phys.collisionBackend = opts.backend;
+    globalConf.phys.collisionInterval = opts.collisionInterval;
+
+    if (opts.integrator >= 0.0f)
+        for (auto& e : IConfig::GetGlobalPhysicsConfig())
+            e.second.integrator = opts.integrator;
+
+    auto& task = DCBP::GetUpdateTask();
+    auto& store = task.GetSimStore();
+
+    std::printf("kernel: %s\n", ISimKernel::GetKernelName(ISimKernel::GetKernelType()));
+
+    if (!opts.record.empty() && !task.StartRecording(opts.record))
+        return 1;
+
+    // running hash of the simulated state after every frame
+    std::uint64_t hash = 0;
+
+    PerfTimer pt;
+    double total;
+
+    if (!opts.replay.empty())
+    {
+        MotionReplay replay(task);
+        if (!replay.Open(opts.replay))
+            return 1;
+
+        pt.Start();
+
+        while (replay.Step())
+            hash = hash * 31 + task.GetStateHash();
+
+        total = pt.Stop();
+
+        std::printf("replayed %llu frames, %.2f s\n",
+            static_cast<unsigned long long>(replay.GetFrames()), replay.GetTime());
+    }
+    else
+    {
+        for (std::uint32_t i = 0; i < opts.actors; i++)
+        {
+            auto handle = task.AddActor(1, static_cast<float>((i * 37) % 101));
+
+            if (opts.lodInterval > 1)
+                if (auto obj = task.GetSimObject(handle))
+                    obj->SetLOD(LODTier::Mid, opts.lodInterval);
+        }
+
+        std::printf("actors: %zu, nodes: %u (moving %u), colliders: %zu\n",
+            task.GetSimActorList().size(), store.Size(), store.NumMoving(),
+            ICollision::GetBackend() == ICollision::Backend::kSpheres ?
+            static_cast<std::size_t>(DCBP::GetSphereWorld().GetNbSpheres()) :
+            DCBP::GetWorld()->getNbCollisionBodies());
+
+        FrameTimer timer(opts.fps, opts.jitter, opts.seed);
+
+        float time = 0.0f;
+
+        pt.Start();
+
+        while (time < opts.seconds)
+        {
+            float interval = timer.Next();
+            time += interval;
+
+            task.Animate(time);
+            task.PhysicsTick(interval);
+
+            hash = hash * 31 + task.GetStateHash();
+        }
+
+        total = pt.Stop();
+    }
+
+    task.StopRecording();
+
+    auto& stats = task.GetStats();
+
+    std::printf("frames: %llu, steps: %llu, node steps: %llu, awake at end: %u\n",
+        static_cast<unsigned long long>(stats.frames),
+        static_cast<unsigned long long>(stats.steps),
+        static_cast<unsigned long long>(stats.nodeSteps),
+        store.NumAwake());
+
+    std::printf("physics: %.3f ms total, %.2f us/frame, %.1f ns/node step (wall %.3f ms)\n",
+        stats.physicsTime * 1000.0,
+        stats.frames ? stats.physicsTime * 1000000.0 / static_cast<double>(stats.frames) : 0.0,
+        stats.nodeSteps ? stats.physicsTime * 1000000000.0 / static_cast<double>(stats.nodeSteps) : 0.0,
+        total * 1000.0);
+
+    if (stats.detections)
+    {
+        std::printf("collisions: %.3f ms total, %llu detections, %.1f contacts/detection, depth mean %.3f max %.3f\n",
+            stats.collisionTime * 1000.0,
+            static_cast<unsigned long long>(stats.detections),
+            static_cast<double>(stats.detectedContacts) / static_cast<double>(stats.detections),
+            stats.detectedContacts ? stats.depthSum / static_cast<double>(stats.detectedContacts) : 0.0,
+            stats.maxDepth);
+    }
+
+    std::printf("state hash: %016llx\n", static_cast<unsigned long long>(hash));
+
+    task.ClearActors();
+
+    if (ICollision::GetBackend() == ICollision::Backend::kReactPhysics)
+    {
+        auto& pool = ICollision::GetPoolStats();
+        std::printf("collider pool: %u free, %u used, %llu acquired, %llu hits\n",
+            pool.free, pool.used,
+            static_cast<unsigned long long>(pool.acquired),
+            static_cast<unsigned long long>(pool.hits));
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#ifndef PCH_H
+#define PCH_H
+
+// Used in place of CBP/pch.h when building the headless host. The simulation sources are
+// compiled unchanged against stand-ins for the game, SKSE and reactphysics3d types.
+
+#include <map>
+#include <unordered_map>
+#include <set>
+#include <unordered_set>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <queue>
+#include <algorithm>
+#include <regex>
+#include <array>
+#include <random>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <cstdarg>
+#include <cerrno>
+
+#include <immintrin.h>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+
+#include "json/json.h"
+
+// MSVC intrinsics used by ISimKernel::Initialize
+inline void __cpuidex(int a_info[4], int a_leaf, int a_subLeaf)
+{
+    __asm__ __volatile__("cpuid"
+        : "=a"(a_info[0]), "=b"(a_info[1]), "=c"(a_info[2]), "=d"(a_info[3])
+        : "a"(a_leaf), "c"(a_subLeaf));
+}
+
+inline void __cpuid(int a_info[4], int a_leaf)
+{
+    __cpuidex(a_info, a_leaf, 0);
+}
+
+#define strtok_s strtok_r
+
+#ifndef CBP_HEADLESS_DATA_PATH
+#define CBP_HEADLESS_DATA_PATH "config/"
+#endif
+
+constexpr const char* PLUGIN_CBP_CONFIG = CBP_HEADLESS_DATA_PATH "CBPConfig.txt";
+constexpr const char* PLUGIN_CBP_NODE_DATA = CBP_HEADLESS_DATA_PATH "CBP/Nodes.json";
+constexpr const char* PLUGIN_CBP_GLOBAL_DATA = CBP_HEADLESS_DATA_PATH "CBP/Settings/Globals.json";
+constexpr const char* PLUGIN_CBP_CG_DATA = CBP_HEADLESS_DATA_PATH "CBP/Settings/CollisionGroups.json";
+constexpr const char* PLUGIN_CBP_GLOBPROFILE_DEFAULT_DATA = CBP_HEADLESS_DATA_PATH "CBP/Default.json";
+
+#include "NiTypes.h"
+#include "GameTypes.h"
+#include "r3d.h"
+
+namespace r3d = reactphysics3d;
+
+// Profiling.h isn't built here, timing zones compile out
+#define CBP_PROFILE_ZONE(a_zone)
+
+namespace CBP
+{
+    namespace fs = std::filesystem;
+}
+
+#include "../CBP/Data.h"
+#include "../CBP/config.h"
+#include "../CBP/Serialization.h"
+#include "../CBP/SimKernel.h"
+#include "../CBP/WorkerPool.h"
+#include "../CBP/SimStore.h"
+#include "../CBP/SphereWorld.h"
+#include "../CBP/Thing.h"
+#include "../CBP/SimObj.h"
+#include "../CBP/Collision.h"
+#include "../CBP/Recorder.h"
+#include "Host.h"
+#include "Replay.h"
+
+#endif //PCH_H
\ No newline at end of file
@@ -0,0 +1,450 @@
+#pragma once
+
+// The reactphysics3d subset SimComponent::Collider and ICollision use. update() detects
+// sphere contacts with a plain sweep and prune so the backend can be run and timed against
+// SphereWorld, it doesn't reproduce the library's dynamic AABB tree or its costs.
+
+namespace reactphysics3d
+{
+    typedef float decimal;
+    typedef unsigned int uint;
+
+    class CollisionBody;
+
+    struct Vector3
+    {
+        Vector3() :
+            x(0.0f), y(0.0f), z(0.0f)
+        {}
+
+        Vector3(decimal a_x, decimal a_y, decimal a_z) :
+            x(a_x), y(a_y), z(a_z)
+        {}
+
+        decimal x;
+        decimal y;
+        decimal z;
+    };
+
+    class Transform
+    {
+    public:
+        [[nodiscard]] static Transform identity() {
+            return Transform();
+        }
+
+        inline void setPosition(const Vector3& a_pos) {
+            m_position = a_pos;
+        }
+
+        [[nodiscard]] inline const Vector3& getPosition() const {
+            return m_position;
+        }
+
+    private:
+        Vector3 m_position;
+    };
+
+    class SphereShape
+    {
+    public:
+        SphereShape(decimal a_radius) :
+            m_radius(a_radius)
+        {}
+
+        inline void setRadius(decimal a_radius) {
+            m_radius = a_radius;
+        }
+
+        [[nodiscard]] inline decimal getRadius() const {
+            return m_radius;
+        }
+
+    private:
+        decimal m_radius;
+    };
+
+    class Collider
+    {
+    public:
+        Collider(CollisionBody* a_body, SphereShape* a_shape) :
+            m_body(a_body),
+            m_shape(a_shape),
+            m_userData(nullptr)
+        {}
+
+        [[nodiscard]] inline CollisionBody* getBody() const {
+            return m_body;
+        }
+
+        inline void setUserData(void* a_data) {
+            m_userData = a_data;
+        }
+
+        [[nodiscard]] inline void* getUserData() const {
+            return m_userData;
+        }
+
+        [[nodiscard]] inline SphereShape* getCollisionShape() const {
+            return m_shape;
+        }
+
+    private:
+        CollisionBody* m_body;
+        SphereShape* m_shape;
+        void* m_userData;
+    };
+
+    // Filled by PhysicsWorld::update(), benchmarks also build their own.
+    class CollisionCallback
+    {
+    public:
+        class ContactPoint
+        {
+        public:
+            ContactPoint(const Vector3& a_normal, decimal a_depth) :
+                m_normal(a_normal),
+                m_depth(a_depth)
+            {}
+
+            [[nodiscard]] inline const Vector3& getWorldNormal() const {
+                return m_normal;
+            }
+
+            [[nodiscard]] inline decimal getPenetrationDepth() const {
+                return m_depth;
+            }
+
+        private:
+            Vector3 m_normal;
+            decimal m_depth;
+        };
+
+        class ContactPair
+        {
+        public:
+            enum class EventType
+            {
+                ContactStart,
+                ContactStay,
+                ContactExit
+            };
+
+            ContactPair(Collider* a_collider1, Collider* a_collider2, EventType a_type) :
+                m_collider1(a_collider1),
+                m_collider2(a_collider2),
+                m_type(a_type)
+            {}
+
+            inline void addContactPoint(const ContactPoint& a_point) {
+                m_points.emplace_back(a_point);
+            }
+
+            [[nodiscard]] inline uint getNbContactPoints() const {
+                return static_cast<uint>(m_points.size());
+            }
+
+            [[nodiscard]] inline ContactPoint getContactPoint(uint a_index) const {
+                return m_points[a_index];
+            }
+
+            [[nodiscard]] inline Collider* getCollider1() const {
+                return m_collider1;
+            }
+
+            [[nodiscard]] inline Collider* getCollider2() const {
+                return m_collider2;
+            }
+
+            [[nodiscard]] inline EventType getEventType() const {
+                return m_type;
+            }
+
+        private:
+            Collider* m_collider1;
+            Collider* m_collider2;
+            EventType m_type;
+            std::vector<ContactPoint> m_points;
+        };
+
+        class CallbackData
+        {
+        public:
+            inline void addContactPair(const ContactPair& a_pair) {
+                m_pairs.emplace_back(a_pair);
+            }
+
+            [[nodiscard]] inline uint getNbContactPairs() const {
+                return static_cast<uint>(m_pairs.size());
+            }
+
+            [[nodiscard]] inline ContactPair getContactPair(uint a_index) const {
+                return m_pairs[a_index];
+            }
+
+        private:
+            std::vector<ContactPair> m_pairs;
+        };
+
+        virtual ~CollisionCallback() = default;
+
+        virtual void onContact(const CallbackData& a_callbackData) = 0;
+    };
+
+    class EventListener :
+        public CollisionCallback
+    {
+    public:
+        virtual void onContact(const CollisionCallback::CallbackData&) override {}
+    };
+
+    typedef bool (*CollisionCheckCallback)(Collider* a_lhs, Collider* a_rhs);
+
+    class CollisionBody
+    {
+    public:
+        CollisionBody(uint a_id, const Transform& a_transform) :
+            m_id(a_id),
+            m_transform(a_transform),
+            m_active(true)
+        {}
+
+        inline Collider* addCollider(SphereShape* a_shape, const Transform&)
+        {
+            m_colliders.emplace_back(std::make_unique<Collider>(this, a_shape));
+            return m_colliders.back().get();
+        }
+
+        [[nodiscard]] inline uint getNbColliders() const {
+            return static_cast<uint>(m_colliders.size());
+        }
+
+        [[nodiscard]] inline Collider* getCollider(uint a_index) const {
+            return m_colliders[a_index].get();
+        }
+
+        [[nodiscard]] inline uint getId() const {
+            return m_id;
+        }
+
+        inline void removeCollider(Collider* a_collider)
+        {
+            m_colliders.erase(std::remove_if(m_colliders.begin(), m_colliders.end(),
+                [&](const auto& a_e) { return a_e.get() == a_collider; }), m_colliders.end());
+        }
+
+        inline void setTransform(const Transform& a_transform) {
+            m_transform = a_transform;
+        }
+
+        [[nodiscard]] inline const Transform& getTransform() const {
+            return m_transform;
+        }
+
+        inline void setIsActive(bool a_active) {
+            m_active = a_active;
+        }
+
+        [[nodiscard]] inline bool isActive() const {
+            return m_active;
+        }
+
+    private:
+        uint m_id;
+        Transform m_transform;
+        bool m_active;
+        std::vector<std::unique_ptr<Collider>> m_colliders;
+    };
+
+    class PhysicsWorld
+    {
+    public:
+        inline CollisionBody* createCollisionBody(const Transform& a_transform)
+        {
+            m_bodies.emplace_back(std::make_unique<CollisionBody>(m_nextId++, a_transform));
+            return m_bodies.back().get();
+        }
+
+        inline void destroyCollisionBody(CollisionBody* a_body)
+        {
+            m_bodies.erase(std::remove_if(m_bodies.begin(), m_bodies.end(),
+                [&](const auto& a_e) { return a_e.get() == a_body; }), m_bodies.end());
+        }
+
+        // The first collider of every active body is swept along x, pairs are matched against
+        // the previous update by body id to report start/stay/exit, one contact point each.
+        // Pairs of bodies deactivated or destroyed since aren't reported as exits, the nodes
+        // are gone by then.
+        inline void update(decimal)
+        {
+            m_proxies.clear();
+
+            for (const auto& e : m_bodies)
+            {
+                if (!e->isActive() || e->getNbColliders() == 0)
+                    continue;
+
+                auto collider = e->getCollider(0);
+                auto& pos = e->getTransform().getPosition();
+                auto radius = collider->getCollisionShape()->getRadius();
+
+                m_proxies.emplace_back(proxy_t{ pos.x - radius, pos, radius, e->getId(), collider });
+            }
+
+            std::sort(m_proxies.begin(), m_proxies.end(), [](const auto& a_lhs, const auto& a_rhs) {
+                return a_lhs.minX < a_rhs.minX || (a_lhs.minX == a_rhs.minX && a_lhs.id < a_rhs.id);
+            });
+
+            m_proxyIndex.assign(m_nextId, NO_PROXY);
+            for (uint i = 0; i < static_cast<uint>(m_proxies.size()); i++)
+                m_proxyIndex[m_proxies[i].id] = i;
+
+            typedef CollisionCallback::ContactPair::EventType EventType;
+
+            CollisionCallback::CallbackData data;
+
+            m_keys.clear();
+
+            for (std::size_t i = 0; i < m_proxies.size(); i++)
+            {
+                const auto& a = m_proxies[i];
+                auto maxX = a.pos.x + a.radius;
+
+                for (std::size_t j = i + 1; j < m_proxies.size() && m_proxies[j].minX <= maxX; j++)
+                {
+                    const auto* p1 = std::addressof(a);
+                    const auto* p2 = std::addressof(m_proxies[j]);
+
+                    if (p1->id > p2->id)
+                        std::swap(p1, p2);
+
+                    Vector3 d(p2->pos.x - p1->pos.x, p2->pos.y - p1->pos.y, p2->pos.z - p1->pos.z);
+
+                    auto rs = p1->radius + p2->radius;
+                    auto d2 = d.x * d.x + d.y * d.y + d.z * d.z;
+
+                    if (d2 >= rs * rs)
+                        continue;
+
+                    if (m_collisionCheck && !m_collisionCheck(p1->collider, p2->collider))
+                        continue;
+
+                    auto key = (static_cast<std::uint64_t>(p1->id) << 32) | p2->id;
+                    auto dist = std::sqrt(d2);
+
+                    bool stay = std::binary_search(m_prevKeys.begin(), m_prevKeys.end(), key);
+
+                    CollisionCallback::ContactPair pair(
+                        p1->collider, p2->collider, stay ? EventType::ContactStay : EventType::ContactStart);
+
+                    pair.addContactPoint(CollisionCallback::ContactPoint(
+                        dist > 0.0f ? Vector3(d.x / dist, d.y / dist, d.z / dist) : Vector3(0.0f, 0.0f, 1.0f),
+                        rs - dist));
+
+                    data.addContactPair(pair);
+
+                    m_keys.emplace_back(key);
+                }
+            }
+
+            std::sort(m_keys.begin(), m_keys.end());
+
+            for (auto e : m_prevKeys)
+            {
+                if (std::binary_search(m_keys.begin(), m_keys.end(), e))
+                    continue;
+
+                auto i1 = m_proxyIndex[static_cast<uint>(e >> 32)];
+                auto i2 = m_proxyIndex[static_cast<uint>(e & 0xFFFFFFFF)];
+
+                if (i1 == NO_PROXY || i2 == NO_PROXY)
+                    continue;
+
+                data.addContactPair(CollisionCallback::ContactPair(
+                    m_proxies[i1].collider, m_proxies[i2].collider, EventType::ContactExit));
+            }
+
+            m_prevKeys.swap(m_keys);
+
+            if (m_listener)
+                m_listener->onContact(data);
+        }
+
+        inline void setCollisionCheckCallback(CollisionCheckCallback a_func) {
+            m_collisionCheck = a_func;
+        }
+
+        inline void setEventListener(EventListener* a_listener) {
+            m_listener = a_listener;
+        }
+
+        inline void setIsDebugRenderingEnabled(bool a_enabled) {
+            m_debugRendering = a_enabled;
+        }
+
+        [[nodiscard]] inline bool getIsDebugRenderingEnabled() const {
+            return m_debugRendering;
+        }
+
+        [[nodiscard]] inline std::size_t getNbCollisionBodies() const {
+            return m_bodies.size();
+        }
+
+    private:
+        static constexpr uint NO_PROXY = ~0U;
+
+        struct proxy_t
+        {
+            decimal minX;
+            Vector3 pos;
+            decimal radius;
+            uint id;
+            Collider* collider;
+        };
+
+        std::vector<std::unique_ptr<CollisionBody>> m_bodies;
+        uint m_nextId = 0;
+
+        std::vector<proxy_t> m_proxies;
+        std::vector<uint> m_proxyIndex;
+        // body id pairs, lower id high, in contact as of the last update, sorted
+        std::vector<std::uint64_t> m_prevKeys;
+        std::vector<std::uint64_t> m_keys;
+
+        bool m_debugRendering = false;
+        CollisionCheckCallback m_collisionCheck = nullptr;
+        EventListener* m_listener = nullptr;
+    };
+
+    class PhysicsCommon
+    {
+    public:
+        inline PhysicsWorld* createPhysicsWorld()
+        {
+            m_worlds.emplace_back(std::make_unique<PhysicsWorld>());
+            return m_worlds.back().get();
+        }
+
+        inline void destroyPhysicsWorld(PhysicsWorld* a_world)
+        {
+            m_worlds.erase(std::remove_if(m_worlds.begin(), m_worlds.end(),
+                [&](const auto& a_e) { return a_e.get() == a_world; }), m_worlds.end());
+        }
+
+        inline SphereShape* createSphereShape(decimal a_radius)
+        {
+            m_shapes.emplace_back(std::make_unique<SphereShape>(a_radius));
+            return m_shapes.back().get();
+        }
+
+        inline void destroySphereShape(SphereShape* a_shape)
+        {
+            m_shapes.erase(std::remove_if(m_shapes.begin(), m_shapes.end(),
+                [&](const auto& a_e) { return a_e.get() == a_shape; }), m_shapes.end());
+        }
+
+    private:
+        std::vector<std::unique_ptr<PhysicsWorld>> m_worlds;
+        std::vector<std::unique_ptr<SphereShape>> m_shapes;
+    };
+}
\ No newline at end of file
@@ -9,9 +9,17 @@
 #include <fstream>
 #include <filesystem>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <queue>
 #include <algorithm>
 #include <regex>
+#include <array>
+#include <random>
+
+#include <intrin.h>
+#include <immintrin.h>
 
 #include <ShlObj.h>
 
@@ -33,6 +41,7 @@
 #include <boost/iostreams/device/array.hpp>
 #include <boost/iostreams/stream.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
 #include <boost/iostreams/filter/gzip.hpp>
 
@@ -60,6 +69,7 @@
 #include "skse64/NiTypes.h"
 #include "skse64/NiObjects.h"
 #include "skse64/GameReferences.h"
+#include "skse64/GameCamera.h"
 #include "skse64/GameData.h"
 #include "skse64/GameMenus.h"
 #include "skse64/GameExtraData.h"
@@ -79,6 +89,8 @@ namespace CBP
 }
 
 //#define _CBP_ENABLE_DEBUG
+// per phase timing percentiles in Stats, recorded only while profiling is enabled
+#define _CBP_ENABLE_PROFILING_ZONES
 
 #include "plugin.h"
 #include "skse.h"
@@ -93,14 +105,20 @@ namespace CBP
 #include "cbp/Config.h"
 #include "cbp/Serialization.h"
 #include "cbp/Profile.h"
+#include "cbp/SimKernel.h"
+#include "cbp/WorkerPool.h"
+#include "cbp/SimStore.h"
+#include "cbp/SphereWorld.h"
 #include "cbp/Thing.h"
 #include "cbp/SimObj.h"
 #include "cbp/Collision.h"
+#include "cbp/Trace.h"
+#include "cbp/Profiling.h"
 #include "cbp/Armor.h"
 #include "cbp/UI.h"
 #include "cbp/Papyrus.h"
 #include "cbp/Renderer.h"
-#include "cbp/Profiling.h"
+#include "cbp/Recorder.h"
 #include "cbp/Updater.h"
 #include "cbp/GameEventHandlers.h"
 #include "drivers/cbp.h"
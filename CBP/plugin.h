@@ -18,6 +18,8 @@ constexpr const char* PLUGIN_CBP_CG_DATA = CBP_DATA_BASE_PATH "Settings\\Collisi
 constexpr const char* PLUGIN_CBP_NODE_DATA = CBP_DATA_BASE_PATH "Nodes.json";
 constexpr const char* PLUGIN_CBP_GLOBPROFILE_DEFAULT_DATA = CBP_DATA_BASE_PATH "Default.json";
 constexpr const char* PLUGIN_CBP_EXPORTS_PATH = CBP_DATA_BASE_PATH "Exports";
+constexpr const char* PLUGIN_CBP_RECORDINGS_PATH = CBP_DATA_BASE_PATH "Recordings";
+constexpr const char* PLUGIN_CBP_TRACES_PATH = CBP_DATA_BASE_PATH "Traces";
 constexpr const char* PLUGIN_IMGUI_INI_FILE = CBP_DATA_BASE_PATH "Settings\\ImGui.ini";
 
 #define MIN_SKSE_VERSION            RUNTIME_VERSION_1_5_23
\ No newline at end of file